@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+
+/** CoordinateAxis finds the fractional index of values along one coordinate of a grid, e.g. the latitude.
+    The axis is examined once when it is created. Lookups on evenly spaced axes are then calculated directly,
+    lookups on other monotonic axes use a binary search and only axes which are not sorted are searched linearly.
+    The results are the same as those of GetFractionalIndex, in both ascending and descending order. */
+class CoordinateAxis
+{
+public:
+    CoordinateAxis() = default;
+
+    explicit CoordinateAxis(const std::vector<float>& values);
+
+    /** Creates a periodic axis, such as a longitude axis with the period 360 degrees.
+        Values are first moved into the range of the axis by adding or subtracting whole periods.
+        If the axis covers the full period, i.e. the gap from the last value around to the first value is no larger
+            than the largest spacing between two values, then the axis wraps around and values in this gap get
+            fractional indices between size() - 1 and size(), where the value after the last is the first value.
+        Only monotonic axes can wrap around. */
+    CoordinateAxis(const std::vector<float>& values, double period);
+
+    /** @return the fractional index where the provided value lies along the axis,
+            i.e. ii + alpha where value = values[ii] * (1 - alpha) + values[ii + 1] * alpha.
+        @throws std::invalid_argument if the value lies outside of the axis. */
+    double GetFractionalIndex(double value) const;
+
+    /** Finds the fractional index of each of the provided values, as above.
+        @return one index for each value, values which lie outside of the axis get the index NaN. */
+    std::vector<double> GetFractionalIndices(const std::vector<double>& values) const;
+
+    /** @return the number of values along the axis. */
+    size_t size() const { return m_values.size(); }
+
+    /** @return true if the values are strictly increasing or strictly decreasing. */
+    bool IsMonotonic() const { return m_ordering != Ordering::Unsorted; }
+
+    /** @return true if the values are monotonic and evenly spaced. */
+    bool IsUniform() const { return m_isUniform; }
+
+    /** @return true if this is a periodic axis, see the constructor above. */
+    bool IsPeriodic() const { return m_period > 0.0; }
+
+    /** @return true if this periodic axis covers the full period, such that the last value is followed by the first. */
+    bool WrapsAround() const { return m_wrapsAround; }
+
+    /** @return true if the values are strictly increasing. */
+    bool IsAscending() const { return m_ordering == Ordering::Ascending; }
+
+private:
+    enum class Ordering
+    {
+        Ascending,
+        Descending,
+        Unsorted
+    };
+
+    std::vector<float> m_values;
+
+    Ordering m_ordering = Ordering::Unsorted;
+
+    bool m_isUniform = false;
+
+    // The distance between two values on a uniform axis, negative for descending axes.
+    double m_step = 0.0;
+
+    // The period of a periodic axis, zero if the axis is not periodic.
+    double m_period = 0.0;
+
+    bool m_wrapsAround = false;
+
+    // The smallest value along the axis, values are moved into [m_minimum, m_minimum + m_period) on periodic axes.
+    double m_minimum = 0.0;
+
+    /** @return the fractional index of the value, or a negative value if it lies outside of the axis. */
+    double FindFractionalIndex(double value) const;
+
+    /** @return the fractional index of the value inside of the interval [values[intervalIdx], values[intervalIdx + 1]]. */
+    double IndexInInterval(size_t intervalIdx, double value) const;
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include "NetCdfException.h"
+
+/** Identifies the contents of one input file, without reading the full file. */
+struct FileFingerprint
+{
+    uint64_t fileSize = 0;
+
+    // The time of the last modification, in seconds since 1970-01-01 00:00:00 UTC.
+    int64_t modificationTime = 0;
+
+    // A hash of the first bytes of the file, which holds the header of a net cdf file.
+    uint64_t headerHash = 0;
+
+    bool operator==(const FileFingerprint& other) const
+    {
+        return fileSize == other.fileSize && modificationTime == other.modificationTime && headerHash == other.headerHash;
+    }
+    bool operator!=(const FileFingerprint& other) const { return !(*this == other); }
+};
+
+/** @return the fingerprint of the file with the provided name.
+    @throws NetCdfException if the file cannot be opened. */
+FileFingerprint GetFileFingerprint(const std::string& filename);
+
+/** @return the 64-bit FNV-1a hash of the provided bytes.
+    @param hash The hash of the preceding bytes, such that the hash can be calculated in parts. */
+uint64_t HashBytes(const char* data, size_t length, uint64_t hash = 14695981039346656037ULL);
@@ -0,0 +1,157 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <limits>
+
+struct EstimatedValue
+{
+    double value;
+    double uncertainty;
+};
+
+// The values at the 2^Rank corners of the unit hyper-cube surrounding one point.
+//  Bit (Rank - 1 - d) of the index of a corner selects the lower (0) or upper (1) side along dimension d,
+//  i.e. the last dimension varies fastest, in the same way as the values of a NetCdfTensor.
+template<size_t Rank>
+using CornerValues = std::array<double, (size_t(1) << Rank)>;
+
+// The validity of each corner of the unit hyper-cube, ordered as CornerValues.
+template<size_t Rank>
+using CornerValidity = std::array<bool, (size_t(1) << Rank)>;
+
+// The fractional position of the point inside of the unit hyper-cube, one value in [0, 1] for each dimension.
+template<size_t Rank>
+using CubePosition = std::array<double, Rank>;
+
+// Performs an N-linear interpolation between the corners of the unit hyper-cube.
+//  The uncertainty is the difference between the two sides of the cube along the first dimension,
+//  each interpolated along the remaining dimensions.
+//  The dimensions are reduced from the last to the first, with the same operations as TriLinearInterpolation,
+//  and the loops are unrolled by the compiler since Rank is known at compile time. No memory is allocated.
+template<size_t Rank>
+inline EstimatedValue MultiLinearInterpolation(const CornerValues<Rank>& corners, const CubePosition<Rank>& position)
+{
+    static_assert(Rank >= 1, "MultiLinearInterpolation requires at least one dimension");
+
+    CornerValues<Rank> reduced = corners;
+    size_t numberOfCorners = corners.size();
+    for (size_t dimension = Rank - 1; dimension > 0; --dimension)
+    {
+        numberOfCorners /= 2;
+        const double alpha = position[dimension];
+        for (size_t ii = 0; ii < numberOfCorners; ++ii)
+        {
+            reduced[ii] = reduced[2 * ii] * (1.0 - alpha) + reduced[2 * ii + 1] * alpha;
+        }
+    }
+
+    EstimatedValue result;
+    result.value = reduced[0] * (1.0 - position[0]) + reduced[1] * position[0];
+    result.uncertainty = reduced[1] - reduced[0];
+    return result;
+}
+
+// Performs the same interpolation as above, using only the corners of the cube which are marked as valid.
+//  The weights of the remaining corners are re-normalized. If there are no valid corners with a non-zero weight
+//  then the value is NaN. If only one side of the cube along the first dimension has valid corners
+//  then the uncertainty cannot be estimated and is zero.
+template<size_t Rank>
+inline EstimatedValue MultiLinearInterpolation(const CornerValues<Rank>& corners, const CornerValidity<Rank>& validCorners, const CubePosition<Rank>& position)
+{
+    static_assert(Rank >= 1, "MultiLinearInterpolation requires at least one dimension");
+
+    const size_t cornersPerSide = corners.size() / 2;
+
+    double value = 0.0;
+    double weight = 0.0;
+    double sideValue[2] = { 0.0, 0.0 };
+    double sideWeight[2] = { 0.0, 0.0 };
+    for (size_t cornerIdx = 0; cornerIdx < corners.size(); ++cornerIdx)
+    {
+        if (!validCorners[cornerIdx])
+        {
+            continue;
+        }
+
+        double weightInSide = 1.0;
+        for (size_t dimension = 1; dimension < Rank; ++dimension)
+        {
+            const bool upper = (cornerIdx >> (Rank - 1 - dimension)) & 1;
+            weightInSide *= upper ? position[dimension] : 1.0 - position[dimension];
+        }
+
+        const size_t side = cornerIdx / cornersPerSide;
+        const double cornerWeight = weightInSide * (side ? position[0] : 1.0 - position[0]);
+
+        sideValue[side] += weightInSide * corners[cornerIdx];
+        sideWeight[side] += weightInSide;
+        value += cornerWeight * corners[cornerIdx];
+        weight += cornerWeight;
+    }
+
+    EstimatedValue result;
+    if (weight <= 0.0)
+    {
+        result.value = std::numeric_limits<double>::quiet_NaN();
+        result.uncertainty = std::numeric_limits<double>::quiet_NaN();
+        return result;
+    }
+
+    result.value = value / weight;
+    result.uncertainty = (sideWeight[0] > 0.0 && sideWeight[1] > 0.0) ?
+        sideValue[1] / sideWeight[1] - sideValue[0] / sideWeight[0] :
+        0.0;
+    return result;
+}
+
+// Bi-linear interpolation in a 2x2 square, e.g. in (latitude, longitude).
+inline EstimatedValue BiLinearInterpolation(const CornerValues<2>& corners, double idxY, double idxX)
+{
+    return MultiLinearInterpolation<2>(corners, { idxY, idxX });
+}
+
+// Tri-linear interpolation in a 2x2x2 cube, e.g. in (level, latitude, longitude).
+//  This gives the same result as the TriLinearInterpolation on vectors.
+inline EstimatedValue TriLinearInterpolation(const CornerValues<3>& corners, double idxZ, double idxY, double idxX)
+{
+    return MultiLinearInterpolation<3>(corners, { idxZ, idxY, idxX });
+}
+
+inline EstimatedValue TriLinearInterpolation(const CornerValues<3>& corners, const CornerValidity<3>& validCorners, double idxZ, double idxY, double idxX)
+{
+    return MultiLinearInterpolation<3>(corners, validCorners, { idxZ, idxY, idxX });
+}
+
+// Quadri-linear interpolation in a 2x2x2x2 hyper-cube of (time, level, latitude, longitude),
+//  i.e. interpolation in space between two consecutive time steps.
+//  The uncertainty is here the change in the value between the two time steps.
+inline EstimatedValue QuadriLinearInterpolation(const CornerValues<4>& corners, double idxT, double idxZ, double idxY, double idxX)
+{
+    return MultiLinearInterpolation<4>(corners, { idxT, idxZ, idxY, idxX });
+}
+
+inline EstimatedValue QuadriLinearInterpolation(const CornerValues<4>& corners, const CornerValidity<4>& validCorners, double idxT, double idxZ, double idxY, double idxX)
+{
+    return MultiLinearInterpolation<4>(corners, validCorners, { idxT, idxZ, idxY, idxX });
+}
+
+// The number of consecutive time steps which are interpolated together by the batch kernels below.
+const size_t InterpolationBatchSize = 64;
+
+// The corners of the cubes surrounding one point at up to InterpolationBatchSize consecutive time steps,
+//  stored as a structure of arrays such that corners[cornerIdx][timeIdx] is one corner at one time step.
+//  The corners are ordered as CornerValues.
+template<size_t Rank>
+using CornerBatch = std::array<std::array<double, InterpolationBatchSize>, (size_t(1) << Rank)>;
+
+// Performs the tri-linear interpolation at the same position in each of the first numberOfTimeSteps cubes of the batch.
+//  The results are written to value[0, numberOfTimeSteps) and, unless uncertainty is null, to uncertainty[0, numberOfTimeSteps).
+//  Consecutive time steps are interpolated together using AVX2 or SSE2 instructions where these are available.
+//  The result is identical to calling MultiLinearInterpolation<3> for one time step at a time.
+void TriLinearInterpolation(const CornerBatch<3>& corners, size_t numberOfTimeSteps, const CubePosition<3>& position, double* value, double* uncertainty);
+
+// Calculates the wind speed and the wind direction (in degrees) at each corner of the first numberOfTimeSteps cubes
+//  of the batch, from the u- (eastward) and v- (northward) components of the wind.
+//  The speeds are calculated using AVX2 or SSE2 instructions where these are available,
+//  the directions are calculated one value at a time using std::atan2.
+void CalculateWindSpeedAndDirection(const CornerBatch<3>& u, const CornerBatch<3>& v, size_t numberOfTimeSteps, CornerBatch<3>& speed, CornerBatch<3>& direction);
@@ -0,0 +1,81 @@
+#pragma once
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <string>
+#include "NetCdfException.h"
+#include "NetCdfTensor.h"
+
+class NetCdfFileReader;
+
+/** LazyNetCdfTensor is a handle to one variable in a net cdf file, where the values are only read
+    from the file when they are accessed. The variable is divided into blocks (by default the chunks of
+    a NetCdf-4 file) and each block is read in full when the first value in it is accessed.
+    The most recently used blocks are kept in memory, such that repeated accesses to the same region are cheap.
+    Created using NetCdfFileReader::ReadVariableLazy. The tensor follows its reader if the reader is moved,
+    but is detached when the reader is closed or returned to a NetCdfReaderPool, after which only the already loaded blocks can be accessed.
+    This is not thread-safe, since accessing a value may read from the file. */
+class LazyNetCdfTensor
+{
+public:
+    LazyNetCdfTensor(LazyNetCdfTensor&&) = default;
+    LazyNetCdfTensor& operator=(LazyNetCdfTensor&&) = default;
+
+    LazyNetCdfTensor(const LazyNetCdfTensor&) = delete;
+    LazyNetCdfTensor& operator=(const LazyNetCdfTensor&) = delete;
+
+    // Defines the number of dimensions of this variable
+    //  and the size in each dimension.
+    std::vector<size_t> size;
+
+    // The dimensions of this variable
+    std::vector<NetCdfDimension> dimensions;
+
+    // The name of the variable.
+    std::string name;
+
+    /** @return the value with the provided (flattened) index, with the linear scaling applied.
+        Missing values are NaN, as in NetCdfTensor.
+        @throws NetCdfException if the block containing the value cannot be read,
+            or if it is not loaded and the tensor is detached from its reader. */
+    float operator[](size_t index) const;
+
+    /** @return true if the value with the provided (flattened) index is not missing.
+        @throws NetCdfException if the block containing the value cannot be read,
+            or if it is not loaded and the tensor is detached from its reader. */
+    bool IsValid(size_t index) const;
+
+    /** @return the size of each block in each dimension. */
+    const std::vector<size_t>& BlockSize() const { return m_blockSize; }
+
+    /** @return the number of blocks which are currently kept in memory. */
+    size_t NumberOfLoadedBlocks() const { return m_blocks.size(); }
+
+    /** Releases all blocks kept in memory. */
+    void ClearCache();
+
+private:
+    friend class NetCdfFileReader;
+
+    LazyNetCdfTensor(std::shared_ptr<NetCdfFileReader*> reader, const std::string& variableName, const std::vector<size_t>& variableSize, const std::vector<size_t>& blockSize, size_t maximumNumberOfBlocks);
+
+    // The reader which the blocks are read from, shared with the reader itself which sets it to null when detaching this tensor.
+    std::shared_ptr<NetCdfFileReader*> m_reader;
+
+    std::vector<size_t> m_blockSize;
+
+    // The number of blocks in each dimension.
+    std::vector<size_t> m_numberOfBlocks;
+
+    size_t m_maximumNumberOfBlocks = 1;
+
+    // The loaded blocks, with the most recently used first, and the position of each block in the list.
+    mutable std::list<std::pair<size_t, NetCdfTensor>> m_blocks;
+    mutable std::unordered_map<size_t, std::list<std::pair<size_t, NetCdfTensor>>::iterator> m_blockPositions;
+
+    /** @return the block containing the value with the provided index, reading it from file if necessary.
+        @param indexInBlock Will on return be set to the index of the value inside of the block. */
+    const NetCdfTensor& GetBlock(size_t index, size_t& indexInBlock) const;
+};
@@ -0,0 +1,160 @@
+#pragma once
+#include <map>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "NetCdfException.h"
+#include "NetCdfTensor.h"
+
+/** MappedNetCdfVariable is a read-only view of one variable in a MappedNetCdfFile.
+    The values are decoded directly from the memory mapped file when they are accessed,
+    no copy of the data is made.
+    The view is only valid as long as the MappedNetCdfFile it was retrieved from is open. */
+class MappedNetCdfVariable
+{
+public:
+    // Defines the number of dimensions of this variable
+    //  and the size in each dimension.
+    std::vector<size_t> size;
+
+    // The dimensions of this variable
+    std::vector<NetCdfDimension> dimensions;
+
+    // The linear scaling which is applied to each value when it is accessed.
+    LinearScaling scaling;
+
+    // The name of the variable.
+    std::string name;
+
+    /** @return the value with the provided index, with the linear scaling applied.
+        Multi-dimensional variables are indexed as flattened arrays, in the same way as NetCdfTensor::values. */
+    float operator[](size_t index) const { return (float)ValueAt(index); }
+
+    /** @return the value with the provided index, with the linear scaling applied, in double precision. */
+    double ValueAt(size_t index) const;
+
+    /** @return the total number of values in this variable. */
+    size_t NumberOfElements() const { return m_numberOfElements; }
+
+private:
+    friend class MappedNetCdfFile;
+
+    // The first byte of the values of this variable in the mapped file.
+    const unsigned char* m_data = nullptr;
+
+    // The net cdf type of the values (NC_SHORT, NC_FLOAT etc)
+    int m_type = 0;
+
+    size_t m_elementSize = 0;
+
+    size_t m_numberOfElements = 0;
+
+    // For record variables (where the first dimension is the unlimited dimension) the values of
+    //  each record are interleaved with the other record variables in the file.
+    //  m_recordSize is then the distance in bytes between two records, otherwise zero.
+    size_t m_recordSize = 0;
+    size_t m_valuesPerRecord = 0;
+};
+
+/** MappedNetCdfFile reads net cdf files in the classic (CDF-1), 64-bit offset (CDF-2)
+    and 64-bit data (CDF-5) formats without going through the netcdf library.
+    The file is memory mapped and the header is parsed when the file is opened,
+    the variables can then be accessed as views into the file without copying any data.
+    NetCdf-4 (HDF5) files are not supported, use the NetCdfFileReader for these. */
+class MappedNetCdfFile
+{
+public:
+    MappedNetCdfFile();
+
+    ~MappedNetCdfFile();
+
+    MappedNetCdfFile(const MappedNetCdfFile&) = delete;
+    MappedNetCdfFile& operator=(const MappedNetCdfFile&) = delete;
+
+    /** Attempts to open and memory map the net-cdf file with the provided filename.
+        @throws NetCdfException if the file cannot be opened or is not a classic format net-cdf file. */
+    void Open(const std::string& filename);
+
+    void Close();
+
+    /** @return the version of the file format, 1 for classic, 2 for 64-bit offset and 5 for 64-bit data. */
+    int GetFormatVersion() const { return m_formatVersion; }
+
+    /** @return true if the file with the provided name starts with the signature of a
+        classic, 64-bit offset or 64-bit data format net-cdf file. */
+    static bool IsClassicFormatFile(const std::string& filename);
+
+    /** @return true if this file contains a variable with the provided name. */
+    bool ContainsVariable(const std::string& variableName) const;
+
+    /** @return the name and length of each dimension in the file.
+        The length of the unlimited dimension is the number of records in the file. */
+    std::map<std::string, size_t> GetDimensionLengths() const;
+
+    /** @return the value of the text attribute with the provided name of one variable.
+        @throws NetCdfException if the variable cannot be found or does not have a text attribute with the provided name. */
+    std::string GetTextAttribute(const std::string& variableName, const std::string& attributeName) const;
+
+    /** @return the size of the variable with the provided name.
+        @throws NetCdfException if the variable cannot be found. */
+    std::vector<size_t> GetSizeOfVariable(const std::string& variableName) const;
+
+    /** @return a view of the variable with the provided name.
+        @throws NetCdfException if the variable cannot be found. */
+    MappedNetCdfVariable GetVariable(const std::string& variableName) const;
+
+private:
+    struct Dimension
+    {
+        std::string name;
+        size_t length = 0;
+    };
+
+    struct Attribute
+    {
+        std::string name;
+        int type = 0;
+        size_t numberOfValues = 0;
+        const unsigned char* data = nullptr;
+    };
+
+    struct Variable
+    {
+        std::string name;
+        std::vector<size_t> dimensionIndices;
+        std::vector<Attribute> attributes;
+        int type = 0;
+        uint64_t begin = 0;
+        bool isRecordVariable = false;
+    };
+
+    int m_formatVersion = 0;
+
+    size_t m_numberOfRecords = 0;
+
+    // The distance in bytes between two records in the file.
+    size_t m_recordSize = 0;
+
+    std::vector<Dimension> m_dimensions;
+
+    std::vector<Variable> m_variables;
+
+    const unsigned char* m_fileData = nullptr;
+
+    size_t m_fileSize = 0;
+
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+
+    /** Parses the header of the mapped file and fills in the dimensions and variables.
+        @throws NetCdfException if the header is not valid. */
+    void ParseHeader();
+
+    const Variable& FindVariable(const std::string& variableName) const;
+
+    /** @return the number of values of the variable in each record,
+        or the total number of values if this is not a record variable. */
+    size_t ValuesPerRecord(const Variable& variable) const;
+};
@@ -1,32 +1,154 @@
 #pragma once
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include "NetCdfException.h"
+#include "NetCdfTensor.h"
+#include "LazyNetCdfTensor.h"
+#include "TimeCoordinate.h"
 
-struct NetCdfDimension
+class NetCdfTimeBlockReader;
+
+/** The netcdf library is not thread-safe, all calls into the library must be made while holding this mutex.
+    NetCdfFileReader takes the lock itself, such that several readers may be used from different threads.
+    Only the calls into the library are serialized, decoding and scaling of the values is made outside of the lock. */
+std::mutex& NetCdfLibraryMutex();
+
+/** Calculates the hyperslab of the 2x2x2 cube of values surrounding one point in a four-dimensional
+    variable with the dimensions [time, level, latitude, longitude], for all points in time.
+    See NetCdfFileReader::ReadNeighbourhood.
+    @param variableSize The size of the variable.
+    @param spatialIndices The fractional (level, latitude, longitude) indices of the point in the variable.
+    @param start Will on return be filled with the start of the slab.
+    @param count Will on return be filled with the size of the slab.
+    @param localIndices Will on return be filled with the fractional indices of the point inside of the slab.
+    @param longitudeWrapsAround True if the longitude axis is periodic, see CoordinateAxis::WrapsAround.
+        The longitude index may then lie between the last and the first longitude, and the slab
+        wraps around from the last to the first longitude, see NeighbourhoodWrapsAround.
+    @throws NetCdfException if the variable is not four-dimensional or if the point lies outside of the variable. */
+void GetNeighbourhoodSlab(
+    const std::string& variableName,
+    const std::vector<size_t>& variableSize,
+    const std::vector<double>& spatialIndices,
+    std::vector<size_t>& start,
+    std::vector<size_t>& count,
+    std::vector<double>& localIndices,
+    bool longitudeWrapsAround = false);
+
+/** Calculates the hyperslab of the 2x2x2 cube of values surrounding one point, as above,
+    but only for the time steps in the provided range.
+    @throws NetCdfException if the variable is not four-dimensional or if the point or the time range lies outside of the variable. */
+void GetNeighbourhoodSlab(
+    const std::string& variableName,
+    const std::vector<size_t>& variableSize,
+    const std::vector<double>& spatialIndices,
+    const TimeRange& timeRange,
+    std::vector<size_t>& start,
+    std::vector<size_t>& count,
+    std::vector<double>& localIndices,
+    bool longitudeWrapsAround = false);
+
+/** @return true if the slab of a neighbourhood, calculated by GetNeighbourhoodSlab, wraps around from the last to the first longitude.
+    The slab must then be read as the two slabs with one longitude each, starting at the last and at the first longitude. */
+bool NeighbourhoodWrapsAround(const std::vector<size_t>& variableSize, const std::vector<size_t>& start, const std::vector<size_t>& count);
+
+/** Combines the two slabs of a wrapping neighbourhood, each with one longitude, into one slab with two longitudes.
+    @param lastColumn The slab starting at the last longitude of the variable.
+    @param firstColumn The slab starting at the first longitude of the variable, with the same size as lastColumn. */
+NetCdfTensor MergeWrappedNeighbourhood(const NetCdfTensor& lastColumn, const NetCdfTensor& firstColumn);
+
+/** Reads the slab of a neighbourhood calculated by GetNeighbourhoodSlab. A slab which wraps around the longitude
+    is read as its two columns, which are then merged, see NeighbourhoodWrapsAround.
+    @param readSlab Called as readSlab(start, count) to read one slab of the variable.
+    @throws whatever readSlab throws. */
+template<class ReadSlabFunction>
+NetCdfTensor ReadNeighbourhoodSlab(const std::vector<size_t>& variableSize, const std::vector<size_t>& start, const std::vector<size_t>& count, ReadSlabFunction readSlab)
+{
+    if (!NeighbourhoodWrapsAround(variableSize, start, count))
+    {
+        return readSlab(start, count);
+    }
+
+    std::vector<size_t> columnCount = count;
+    columnCount[3] = 1;
+    const NetCdfTensor lastColumn = readSlab(start, columnCount);
+
+    std::vector<size_t> firstColumnStart = start;
+    firstColumnStart[3] = 0;
+    const NetCdfTensor firstColumn = readSlab(firstColumnStart, columnCount);
+
+    return MergeWrappedNeighbourhood(lastColumn, firstColumn);
+}
+
+/** The ways in which a variable can be read, used to size the chunk cache of NetCdf-4 files.
+    See NetCdfFileReader::TuneChunkCache. */
+enum class NetCdfAccessPattern
 {
-    int index;
-    std::string name;
+    // The full variable is read at once, e.g. using ReadVariable.
+    WholeField,
+
+    // The full time series at one or several points is read, e.g. using ReadNeighbourhood.
+    TimeSeriesAtPoint,
+
+    // The variable is read in successive blocks along time, e.g. using ReadVariableInTimeBlocks.
+    TimeSlab
 };
 
-struct NetCdfTensor
+/** The settings of the chunk cache of one variable in a NetCdf-4 file. */
+struct ChunkCacheSettings
 {
-    // Defines the number of dimensions of this variable
-    //  and the size in each dimension.
-    std::vector<size_t> size;
+    // The size of the cache, in bytes.
+    size_t sizeInBytes = 0;
 
-    // The dimensions of this variable
-    std::vector<NetCdfDimension> dimensions;
+    // The number of slots in the hash table of the cache.
+    size_t numberOfSlots = 0;
+
+    // How strongly chunks which have been fully read are preferred for eviction, in the range [0, 1].
+    float preemption = 0.75F;
+};
 
-    // Stores the values of this variable.
-    //  Multi-dimensional variables are stored as flattened arrays.
-    std::vector<float> values;
+/** Calculates the chunk cache which is needed to read a variable with the provided size and chunk size
+    using the provided access pattern, without decompressing any chunk more than once.
+    @param elementSize The size of one value of the variable, in bytes.
+    @param maximumSizeInBytes The cache is never made larger than this. */
+ChunkCacheSettings CalculateChunkCacheSettings(
+    const std::vector<size_t>& variableSize,
+    const std::vector<size_t>& chunkSize,
+    size_t elementSize,
+    NetCdfAccessPattern accessPattern,
+    size_t maximumSizeInBytes);
 
-    // The name of the variable.
-    std::string name;
+/** The ways in which the netcdf library can access an opened file. See NetCdfFileReader::Open. */
+enum class NetCdfOpenMode
+{
+    // The values are read from disk as they are accessed.
+    Normal,
+
+    // The whole file is read into memory when it is opened (NC_DISKLESS), all later reads are served from memory.
+    Diskless,
+
+    // The file is memory mapped (NC_DISKLESS | NC_MMAP). Only classic format files can be mapped.
+    //  The file is opened normally instead if the netcdf library cannot map it, e.g. if it is built without mmap support.
+    MemoryMapped,
+
+    // Selects one of the modes above from the size and format of the file and the access pattern, see SelectOpenMode.
+    Automatic
 };
 
+/** Selects the mode in which a file is opened when NetCdfOpenMode::Automatic is requested.
+    Files no larger than maximumDisklessSize are read into memory, since every later read is then free of system calls.
+    Larger classic format files whose time series are read point by point are memory mapped, such that
+        the strided reads are served from the page cache. All other files are opened normally.
+    @return Diskless, MemoryMapped or Normal. */
+NetCdfOpenMode SelectOpenMode(uint64_t fileSize, bool isClassicFormat, NetCdfAccessPattern accessPattern, uint64_t maximumDisklessSize);
+
+/** @return the size of the file with the provided name in bytes, or zero if it cannot be opened. */
+uint64_t GetSizeOfFile(const std::string& filename);
+
 class NetCdfFileReader
 {
 public:
@@ -34,12 +156,37 @@ public:
 
     ~NetCdfFileReader();
 
+    /** A reader owns its file handle and can therefore not be copied, only moved.
+        Any NetCdfTimeBlockReader created from the moved-from reader is invalidated,
+        while a LazyNetCdfTensor follows the reader it was created from into the moved-to reader. */
+    NetCdfFileReader(const NetCdfFileReader&) = delete;
+    NetCdfFileReader& operator=(const NetCdfFileReader&) = delete;
+    NetCdfFileReader(NetCdfFileReader&& other) noexcept;
+    NetCdfFileReader& operator=(NetCdfFileReader&& other) noexcept;
+
     /** Attempts to open the net-cdf file with the provided filename,
+        @param mode How the netcdf library should access the file.
+        @param accessPattern How the file is going to be read, this is only used to select the mode when mode is Automatic.
         @throws NetCdfException if this cannot be done. */
-    void Open(const std::string& filename);
+    void Open(const std::string& filename, NetCdfOpenMode mode = NetCdfOpenMode::Normal, NetCdfAccessPattern accessPattern = NetCdfAccessPattern::WholeField);
+
+    /** Opens a net-cdf file whose contents are held in memory, such as a file received over a pipe,
+        without writing it to disk first. The reader keeps the contents until it is closed.
+        @param name The name of the file, used in error messages.
+        @throws NetCdfException if the contents is not a valid net-cdf file. */
+    void OpenFromMemory(std::vector<char> contents, const std::string& name = "<memory>");
 
+    // The largest file which NetCdfOpenMode::Automatic reads into memory.
+    static const uint64_t DefaultMaximumDisklessSize = (uint64_t)1 << 28;
+
+    /** Closes the file. Any LazyNetCdfTensor created from this reader is detached, see DetachLazyTensors. */
     void Close();
 
+    /** Detaches all LazyNetCdfTensors created from this reader, such that they no longer read from this file.
+        The blocks already loaded by a detached tensor can still be accessed, accessing any other value throws a NetCdfException.
+        This is called when the reader is closed, or when it is returned to a NetCdfReaderPool. */
+    void DetachLazyTensors();
+
     /** Prints information on the currently opened net cdf file to console. */
     void PrintFileInformation();
 
@@ -52,9 +199,106 @@ public:
     int GetIndexOfVariable(const std::string& variableName);
 
     /** Reads one variable from this netcdf file and returns the result.
+        Values which are marked as missing by the attributes _FillValue, missing_value or valid_range
+            are set to NaN and flagged as invalid in NetCdfTensor::validity.
         @throws NetCdfException if the variable cannot be found or the file cannot be read. */
     NetCdfTensor ReadVariable(const std::string& variableName);
 
+    /** Reads one variable from this netcdf file into the provided tensor, see ReadVariable above.
+        The memory already allocated by the tensor is reused if it is large enough,
+            such that the same tensor can be used to read many variables (or files) without reallocating.
+        @throws NetCdfException if the variable cannot be found or the file cannot be read. */
+    void ReadVariable(const std::string& variableName, NetCdfTensor& result);
+
+    /** Reads a hyperslab of one variable from this netcdf file and returns the result.
+        The slab begins at the index 'start' and has the length 'count' in each dimension,
+        both must contain one value for each dimension of the variable.
+        The size of the returned tensor equals 'count'.
+        @throws NetCdfException if the variable cannot be found, if the slab does not lie
+            inside of the variable or if the file cannot be read. */
+    NetCdfTensor ReadSlab(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count);
+
+    /** Reads a hyperslab of one variable into the provided tensor, reusing the memory already allocated by the tensor.
+        See ReadSlab and ReadVariable above.
+        @throws NetCdfException if the variable cannot be found, if the slab does not lie
+            inside of the variable or if the file cannot be read. */
+    void ReadSlab(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count, NetCdfTensor& result);
+
+    /** Reads the small 2x2x2 cube of values surrounding one point from a four-dimensional
+        variable with the dimensions [time, level, latitude, longitude], for all points in time.
+        The size of the returned tensor is [time, 2, 2, 2].
+        @param spatialIndices The fractional (level, latitude, longitude) indices of the point in the variable.
+        @param localIndices Will on return be filled with the fractional indices of the same point
+            inside of the returned cube. These can be passed on directly to InterpolateWind or InterpolateValue.
+        @param longitudeWrapsAround True if the longitude axis is periodic (see CoordinateAxis::WrapsAround), the point
+            may then lie between the last and the first longitude. See GetNeighbourhoodSlab.
+        @throws NetCdfException if the variable cannot be found, is not four-dimensional,
+            if the point lies outside of the variable or if the file cannot be read. */
+    NetCdfTensor ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, std::vector<double>& localIndices, bool longitudeWrapsAround = false);
+
+    /** Reads the small 2x2x2 cube of values surrounding one point, as above, but only for the time steps in the provided range.
+        The size of the returned tensor is [timeRange.count, 2, 2, 2].
+        @throws NetCdfException if the variable cannot be found, is not four-dimensional,
+            if the point or the time range lies outside of the variable or if the file cannot be read. */
+    NetCdfTensor ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, const TimeRange& timeRange, std::vector<double>& localIndices, bool longitudeWrapsAround = false);
+
+    /** Reads the time coordinate variable and decodes it using its 'units' attribute.
+        @throws NetCdfException if the variable cannot be found, has no 'units' attribute which can be parsed,
+            if the time steps are not sorted in increasing order or if the file cannot be read. */
+    TimeCoordinate ReadTimeCoordinate(const std::string& variableName = "time");
+
+    /** Creates a reader which reads one variable in successive blocks along its first (time) dimension.
+        The number of time steps in each block is selected such that one block
+            occupies at most maximumBytesPerBlock in memory (but a block always contains at least one time step).
+        The returned reader refers to this file, which must be kept open while the blocks are read.
+        @throws NetCdfException if the variable cannot be found or has no dimensions. */
+    NetCdfTimeBlockReader ReadVariableInTimeBlocks(const std::string& variableName, size_t maximumBytesPerBlock);
+
+    /** Creates a handle to one variable, where the values are read from file only when they are accessed.
+        The variable is read in blocks, which by default follow the chunks of a NetCdf-4 file. Variables which are not
+            stored in chunks are divided into blocks of DefaultLazyBlockLength values along the first (time) dimension
+            and 8 values along each of the remaining dimensions.
+        The returned tensor reads from this reader, which may be moved but must be kept open while the values are accessed.
+        @param maximumBytesInMemory The least recently used blocks are released when the loaded blocks (values and validity)
+            would occupy more than this.
+        @throws NetCdfException if the variable cannot be found or has no dimensions. */
+    LazyNetCdfTensor ReadVariableLazy(const std::string& variableName, size_t maximumBytesInMemory = DefaultMaximumLazyBytesInMemory);
+
+    /** Creates a lazy handle as above, where the variable is read in blocks of the provided size.
+        @throws NetCdfException if the variable cannot be found, has no dimensions
+            or if blockSize does not have one value for each dimension of the variable. */
+    LazyNetCdfTensor ReadVariableLazy(const std::string& variableName, const std::vector<size_t>& blockSize, size_t maximumBytesInMemory = DefaultMaximumLazyBytesInMemory);
+
+    // The number of time steps in each block of a lazily read variable which is not stored in chunks.
+    static const size_t DefaultLazyBlockLength = 256;
+
+    // The largest amount of memory which a lazily read variable occupies by default.
+    static const size_t DefaultMaximumLazyBytesInMemory = (size_t)1 << 28;
+
+    /** Reads one variable, or a hyperslab of one variable, in the type T which must be one of
+        int, short, float or double. The values are converted directly from the type in the file by the
+        netcdf library, e.g. an integer time coordinate can be read as int or double without any loss of precision.
+        The linear scaling and missing values of the variable are returned with the values, but not applied.
+        See ReadVariable and ReadSlab.
+        @throws NetCdfException if the variable cannot be found, if the slab does not lie inside of the variable,
+            if the file cannot be read or if the values cannot be represented in the type T. */
+    template<class T>
+    TypedNetCdfTensor<T> ReadVariable(const std::string& variableName);
+
+    template<class T>
+    TypedNetCdfTensor<T> ReadSlab(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count);
+
+    /** Reads one variable, which is stored as 16-bit integers (short) in the file,
+        without decoding the values. The linear scaling and the missing values of the variable are returned with the values.
+        @throws NetCdfException if the variable cannot be found, is not stored as short or the file cannot be read. */
+    PackedNetCdfTensor ReadVariablePacked(const std::string& variableName);
+
+    /** Reads a hyperslab of one variable, which is stored as 16-bit integers (short) in the file,
+        without decoding the values. See ReadSlab and ReadVariablePacked.
+        @throws NetCdfException if the variable cannot be found, is not stored as short,
+            if the slab does not lie inside of the variable or if the file cannot be read. */
+    PackedNetCdfTensor ReadSlabPacked(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count);
+
     /** Attempts to read the variable with the provided index
         and return the result as a float array.
         If the variable is a multi-dimensional array then the array will
@@ -66,6 +310,28 @@ public:
     std::vector<float> ReadVariableAsFloat(int variableIdx);
     std::vector<float> ReadVariableAsFloat(const std::string& variableName);
 
+    /** Attempts to read a hyperslab of the variable with the provided index
+        and return the result as a float array.
+        The slab begins at the index 'start' and has the length 'count' in each dimension.
+        If the slab is multi-dimensional then the result will be flattened,
+            in the same order as the full variable.
+        The overload taking the name of the variable will also search for
+            linear scaling factors in the file and apply these.
+        @throws NetCdfException if this cannot be retrieved. */
+    std::vector<float> ReadSlabAsFloat(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count);
+    std::vector<float> ReadSlabAsFloat(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count);
+
+    /** Reads the provided variable, or hyperslab of the variable, into a buffer provided by the caller.
+        The linear scaling of the variable is applied, as in ReadVariableAsFloat and ReadSlabAsFloat above,
+            and the missing values are masked out as in ReadVariable.
+        @param destination The buffer to fill, this must have room for destinationSize values. Missing values are set to NaN.
+        @param validity Will on return be filled with the validity bitmap of the values (see NetCdfTensor::validity),
+            this is empty if the variable has no missing values. The memory of the vector is reused.
+        @throws NetCdfException if the buffer is too small to hold the values,
+            if the variable cannot be found or the file cannot be read. */
+    void ReadVariableAsFloat(const std::string& variableName, float* destination, size_t destinationSize, std::vector<uint8_t>& validity);
+    void ReadSlabAsFloat(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count, float* destination, size_t destinationSize, std::vector<uint8_t>& validity);
+
     /** Attempts to retrieve the size of the provided variable.
         For a multi-dimensional variable, the result will contain multiple dimensions.
         This will also read the entire variable from file at once,
@@ -74,22 +340,117 @@ public:
     std::vector<size_t> GetSizeOfVariable(int variableIdx);
     std::vector<size_t> GetSizeOfVariable(const std::string& variableName);
 
+    /** @return the dimensions of the variable with the provided name, in the order of the variable.
+        @throws NetCdfException if the variable cannot be found. */
+    std::vector<NetCdfDimension> GetDimensionsOfVariable(const std::string& variableName);
+
+    /** @return the indices of the dimensions of the variable with the provided index, in the order of the variable.
+        @throws NetCdfException if there is no such variable. */
+    std::vector<int> GetDimensionIndicesOfVariable(int variableIdx);
+
+    /** retrieves the LinearScaling which is to be applied to the variable with the provided index.
+        @return true if either scale_factor OR add_offset is set. */
+    bool GetLinearScalingForVariable(int variableIdx, LinearScaling& scaling);
+
+    /** @return the name and length of each dimension in the file. */
+    std::map<std::string, size_t> GetDimensionLengths() const;
+
+    /** @return the value of the text attribute with the provided name of one variable.
+        @throws NetCdfException if the variable cannot be found or does not have a text attribute with the provided name. */
+    std::string GetTextAttribute(const std::string& variableName, const std::string& attributeName);
+
     /** @return the number of attributes associated with one variable.
-        @return -1 if the reading failed for some reason */
+        @return -1 if there is no variable with the provided index */
     int GetNumberOfAttributesForVariable(int variableIdx);
 
+    /** @return the size of each chunk of the provided variable, in each dimension.
+        @return an empty vector if the variable is not stored in chunks (as in all classic format files).
+        @throws NetCdfException if the variable cannot be found or the file cannot be read. */
+    std::vector<size_t> GetChunkingOfVariable(const std::string& variableName);
+
+    /** Sets the chunk cache which the netcdf library uses when reading the provided variable.
+        This only applies to NetCdf-4 files, where compressed chunks are kept decompressed in the cache.
+        @throws NetCdfException if the variable cannot be found or the file is not a NetCdf-4 file. */
+    void SetChunkCache(const std::string& variableName, const ChunkCacheSettings& settings);
+
+    /** @return the chunk cache which the netcdf library uses when reading the provided variable.
+        @throws NetCdfException if the variable cannot be found or the file is not a NetCdf-4 file. */
+    ChunkCacheSettings GetChunkCache(const std::string& variableName);
+
+    /** Sizes the chunk cache of the provided variable for the provided access pattern,
+        see CalculateChunkCacheSettings. This does nothing if the variable is not stored in chunks.
+        @param maximumSizeInBytes The cache is never made larger than this.
+        @throws NetCdfException if the variable cannot be found or the file cannot be read. */
+    void TuneChunkCache(const std::string& variableName, NetCdfAccessPattern accessPattern, size_t maximumSizeInBytes = DefaultMaximumChunkCacheSize);
+
+    // The largest chunk cache which TuneChunkCache creates by default, per variable.
+    static const size_t DefaultMaximumChunkCacheSize = (size_t)1 << 30;
+
 private:
     int m_netCdfFileHandle = 0;
 
-    struct LinearScaling
+    // The contents of a file opened using OpenFromMemory, this must be kept until the file is closed.
+    std::vector<char> m_fileContents;
+
+    // Points to this reader for the LazyNetCdfTensors created from it, updated when the reader is moved
+    //  and set to null when they are detached. Created by the first call to ReadVariableLazy.
+    std::shared_ptr<NetCdfFileReader*> m_lazyTensorHandle;
+
+    /** Reads the catalogue of the just opened file, closing the file again if this fails.
+        Must be called while holding the library mutex.
+        @throws NetCdfException if the catalogue cannot be read. */
+    void ReadCatalogueOrClose();
+
+    // ---------- The catalogue of the contents of the file, this is read when the file is opened ----------
+    struct AttributeInformation
     {
-        double offset = 0.0;
-        double scaleFactor = 1.0;
+        std::string name;
+        int type = 0;
+
+        // The values of a numeric attribute.
+        std::vector<double> values;
+
+        // The value of a text attribute.
+        std::string text;
     };
 
-    /** retrieves the LinearScaling which is to be applied to the variable with the provided index.
-        @return true if either scale_factor OR add_offset is set. */
-    bool GetLinearScalingForVariable(int variableIdx, LinearScaling& scaling);
+    struct VariableInformation
+    {
+        std::string name;
+        int type = 0;
+        std::vector<int> dimensionIndices;
+        std::vector<AttributeInformation> attributes;
+
+        // The scaling defined by the attributes scale_factor and add_offset.
+        bool hasLinearScaling = false;
+        LinearScaling scaling;
+
+        // The values defined by the attributes _FillValue, missing_value and valid_range (or valid_min and valid_max).
+        MissingValues missingValues;
+    };
+
+    struct DimensionInformation
+    {
+        std::string name;
+        size_t length = 0;
+    };
+
+    std::vector<DimensionInformation> m_dimensions;
+
+    std::vector<VariableInformation> m_variables;
+
+    std::unordered_map<std::string, int> m_variableIndices;
+
+    // Holds the packed values while these are decoded, kept between reads to avoid allocating it again.
+    std::vector<short> m_packedValueBuffer;
+
+    /** Reads the dimensions, variables and attributes of the currently opened file into the catalogue.
+        @throws NetCdfException if this cannot be read. */
+    void ReadCatalogue();
+
+    /** @return the catalogue information on the variable with the provided index.
+        @throws NetCdfException if there is no such variable. */
+    const VariableInformation& GetVariableInformation(int variableIdx) const;
 
     /** Attempts to read the variable with the provided index
         and return the result as a float array.
@@ -102,5 +463,110 @@ private:
     std::vector<float> ReadVariableAsFloat(int variableIdx, const LinearScaling& scaling);
     std::vector<float> ReadVariableAsFloat(const std::string& variableName, const LinearScaling& scaling);
 
-    std::vector<int> GetDimensionIndicesOfVariable(int variableIdx);
+    /** Attempts to read a hyperslab of the variable with the provided index
+        and applies the provided linear scaling factor to the result.
+        @throws NetCdfException if this cannot be retrieved. */
+    std::vector<float> ReadSlabAsFloat(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, const LinearScaling& scaling);
+
+    /** Reads a hyperslab of the variable with the provided index into the destination,
+        which must have room for all the values of the slab. No scaling is applied.
+        @throws NetCdfException if this cannot be retrieved. */
+    void ReadSlabIntoBuffer(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, float* destination);
+    void ReadSlabIntoBuffer(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, double* destination);
+    void ReadSlabIntoBuffer(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, int* destination);
+    void ReadSlabIntoBuffer(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, short* destination);
+
+    /** Reads a hyperslab of the variable with the provided index into the destination, applies the provided
+        linear scaling and masks out the missing values in the same pass. If there are any missing values then
+        validity is filled with the validity bitmap of the result (see NetCdfTensor::validity), otherwise it is cleared.
+        @throws NetCdfException if this cannot be retrieved. */
+    void ReadSlabIntoBuffer(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, const LinearScaling& scaling, const MissingValues& missingValues, float* destination, std::vector<uint8_t>& validity);
+
+    /** Verifies that the hyperslab defined by 'start' and 'count' lies inside of
+        a variable with the provided size. This must be called before any memory is allocated for the slab.
+        @param variableName The name of the variable, used in the error message.
+        @throws NetCdfException if this is not the case. */
+    void VerifySlabIsInsideOfVariable(const std::string& variableName, const std::vector<size_t>& variableSize, const std::vector<size_t>& start, const std::vector<size_t>& count);
+
+    /** Verifies that the hyperslab lies inside of the variable with the provided index, as above.
+        @throws NetCdfException if there is no such variable or if the slab does not lie inside of it. */
+    void VerifySlabIsInsideOfVariable(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count);
+
+    std::vector<NetCdfDimension> GetDimensionsOfVariable(int variableIdx);
+};
+
+template<class T>
+TypedNetCdfTensor<T> NetCdfFileReader::ReadVariable(const std::string& variableName)
+{
+    std::vector<size_t> variableSize = GetSizeOfVariable(variableName);
+    std::vector<size_t> start(variableSize.size(), 0);
+
+    return ReadSlab<T>(variableName, start, variableSize);
+}
+
+template<class T>
+TypedNetCdfTensor<T> NetCdfFileReader::ReadSlab(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count)
+{
+    const int variableIdx = GetIndexOfVariable(variableName);
+
+    VerifySlabIsInsideOfVariable(variableIdx, start, count);
+
+    size_t numberOfValues = 1;
+    for (size_t length : count)
+    {
+        numberOfValues *= length;
+    }
+
+    TypedNetCdfTensor<T> result;
+    result.size = count;
+    result.dimensions = GetDimensionsOfVariable(variableIdx);
+    result.values.resize(numberOfValues);
+
+    // The overload for the type T selects the matching nc_get_vara function.
+    ReadSlabIntoBuffer(variableIdx, start, count, result.values.data());
+
+    GetLinearScalingForVariable(variableIdx, result.scaling);
+    result.missingValues = GetVariableInformation(variableIdx).missingValues;
+    result.name = variableName;
+
+    return result;
+}
+
+/** NetCdfTimeBlockReader reads one variable from a net cdf file as a sequence of blocks
+    along the first (time) dimension, such that files larger than the available memory can be processed.
+    Each block has the full extent of the variable in all other dimensions.
+    Created using NetCdfFileReader::ReadVariableInTimeBlocks. */
+class NetCdfTimeBlockReader
+{
+public:
+    /** Reads the next block of the variable into 'block'.
+        @return false if all blocks of the variable have already been read.
+        @throws NetCdfException if the file cannot be read. */
+    bool ReadNextBlock(NetCdfTensor& block);
+
+    /** @return the index along the time dimension of the first time step in the most recently read block. */
+    size_t FirstTimeIndexOfBlock() const { return m_firstTimeIndexOfBlock; }
+
+    /** @return the (maximum) number of time steps in each block. */
+    size_t TimeStepsPerBlock() const { return m_timeStepsPerBlock; }
+
+    /** @return the total number of time steps in the variable. */
+    size_t NumberOfTimeSteps() const { return m_variableSize[0]; }
+
+private:
+    friend class NetCdfFileReader;
+
+    NetCdfTimeBlockReader(NetCdfFileReader& reader, const std::string& variableName, const std::vector<size_t>& variableSize, size_t timeStepsPerBlock);
+
+    NetCdfFileReader* m_reader = nullptr;
+
+    std::string m_variableName;
+
+    std::vector<size_t> m_variableSize;
+
+    size_t m_timeStepsPerBlock = 1;
+
+    size_t m_firstTimeIndexOfBlock = 0;
+
+    size_t m_nextTimeIndex = 0;
 };
\ No newline at end of file
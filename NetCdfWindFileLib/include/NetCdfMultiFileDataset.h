@@ -0,0 +1,126 @@
+#pragma once
+#include <map>
+#include <vector>
+#include <string>
+#include <memory>
+#include "NetCdfException.h"
+#include "NetCdfTensor.h"
+#include "TimeCoordinate.h"
+
+class NetCdfFileReader;
+
+/** NetCdfMultiFileDataset presents a time series of net cdf files (e.g. one file per month)
+    which share the same grid as one dataset, where each variable is concatenated along the time dimension.
+    The files are ordered by their first time value and their time coordinates must have the same units and calendar.
+    Only the files which overlap the requested range in time are opened when reading values from the dataset. */
+class NetCdfMultiFileDataset
+{
+public:
+    /** @param timeVariableName the name of the time coordinate variable,
+        all variables which are read must have this as their first dimension. */
+    explicit NetCdfMultiFileDataset(const std::string& timeVariableName = "time");
+
+    ~NetCdfMultiFileDataset();
+
+    NetCdfMultiFileDataset(const NetCdfMultiFileDataset&) = delete;
+    NetCdfMultiFileDataset& operator=(const NetCdfMultiFileDataset&) = delete;
+
+    /** Opens the headers of the provided files and reads their time coordinates.
+        Files in the classic formats are indexed in parallel.
+        @throws NetCdfException if any file cannot be opened, lacks the time variable, if the time steps of the files overlap
+            or if a file does not have the same grid or the same units and calendar of time as the other files. */
+    void Open(const std::vector<std::string>& filenames);
+
+    /** Opens all the files matching the provided pattern, where the file name
+        (but not the directory) may contain the wildcards '*' and '?'.
+        @throws NetCdfException if no file matches the pattern or if the files cannot be opened. */
+    void OpenMatchingFiles(const std::string& filePattern);
+
+    void Close();
+
+    /** @return the names of all the files matching the provided pattern, in alphabetical order. */
+    static std::vector<std::string> FindMatchingFiles(const std::string& filePattern);
+
+    /** @return the number of files in this dataset. */
+    size_t NumberOfFiles() const { return m_files.size(); }
+
+    /** @return the total number of time steps in all files. */
+    size_t NumberOfTimeSteps() const { return m_times.size(); }
+
+    /** @return the values of the time coordinate of all files, concatenated. */
+    const std::vector<double>& GetTimes() const { return m_times.Values(); }
+
+    /** @return the time coordinate of all files, concatenated. */
+    const TimeCoordinate& GetTimeCoordinate() const { return m_times; }
+
+    /** @return the range of time steps in the concatenated dataset lying between the provided times (inclusive),
+            given in seconds since 1970-01-01 00:00:00 UTC. See TimeCoordinate::FindRange. */
+    TimeRange FindTimeRange(double firstTime, double lastTime) const { return m_times.FindRange(firstTime, lastTime); }
+
+    /** @return true if the files of this dataset contain a variable with the provided name. */
+    bool ContainsVariable(const std::string& variableName);
+
+    /** @return the size of the concatenated variable.
+        @throws NetCdfException if the variable cannot be found. */
+    std::vector<size_t> GetSizeOfVariable(const std::string& variableName);
+
+    /** Reads a hyperslab of the concatenated variable, see NetCdfFileReader::ReadSlab.
+        The first dimension of the slab is the index into the concatenated time series
+            and only the files overlapping this range are read.
+        @throws NetCdfException if the variable cannot be found, if the slab does not lie
+            inside of the variable or if a file cannot be read. */
+    NetCdfTensor ReadSlab(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count);
+
+    /** Reads the full concatenated variable.
+        @throws NetCdfException if the variable cannot be found or a file cannot be read. */
+    NetCdfTensor ReadVariable(const std::string& variableName);
+
+    /** Reads the small 2x2x2 cube surrounding one point of the concatenated variable,
+        see NetCdfFileReader::ReadNeighbourhood.
+        @param longitudeWrapsAround True if the longitude axis is periodic, see CoordinateAxis::WrapsAround.
+        @throws NetCdfException if the variable cannot be found or if the point lies outside of the variable. */
+    NetCdfTensor ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, std::vector<double>& localIndices, bool longitudeWrapsAround = false);
+
+    /** Reads the small 2x2x2 cube surrounding one point of the concatenated variable, as above,
+        but only for the time steps in the provided range (see FindTimeRange). Only the files overlapping the range are opened.
+        @throws NetCdfException if the variable cannot be found or if the point or the time range lies outside of the variable. */
+    NetCdfTensor ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, const TimeRange& timeRange, std::vector<double>& localIndices, bool longitudeWrapsAround = false);
+
+private:
+    struct FileInformation
+    {
+        std::string filename;
+
+        // The index of the first time step of this file in the concatenated dataset.
+        size_t firstTimeIndex = 0;
+
+        size_t numberOfTimeSteps = 0;
+
+        // The names and lengths of all dimensions, apart from the time dimension.
+        std::map<std::string, size_t> grid;
+
+        // The 'units' and 'calendar' attributes of the time variable, empty if the attribute is missing.
+        std::string timeUnits;
+        std::string calendar;
+
+        // The file is opened when it is first read from.
+        std::unique_ptr<NetCdfFileReader> reader;
+    };
+
+    const std::string m_timeVariableName;
+
+    std::vector<FileInformation> m_files;
+
+    TimeCoordinate m_times;
+
+    /** Reads the time coordinate and the grid of one file into the provided information.
+        @throws NetCdfException if this fails. */
+    void IndexFile(FileInformation& file, std::vector<double>& times) const;
+
+    /** @return the index of the file containing the provided index into the concatenated time series,
+        or the number of files if the index is beyond the last time step. */
+    size_t FindFile(size_t timeIndex) const;
+
+    /** @return the reader of the file with the provided index, opening it if necessary. */
+    NetCdfFileReader& GetReader(size_t fileIdx);
+};
@@ -0,0 +1,136 @@
+#pragma once
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "NetCdfException.h"
+#include "NetCdfFileReader.h"
+#include "NetCdfTensor.h"
+#include "ThreadPool.h"
+
+/** NetCdfReaderPool keeps several NetCdfFileReaders opened on the same file, such that
+    each thread can read through its own file handle. Several variables, or several slabs
+    of one variable, can then be read in parallel.
+    Note that all calls into the netcdf library are serialized by the global NetCdfLibraryMutex, since the library
+    is not thread-safe. Only one read from the file is therefore made at a time and the speed-up of reading in parallel
+    is limited to the decoding of the values (unpacking, scaling and masking of missing values) which is made outside of the lock.
+    Reads which need no decoding, e.g. of float variables or of the small cubes read by ReadNeighbourhoodAsync,
+    are not faster than through one reader.
+    The asynchronous methods run the reads on a thread pool owned by this object, such that the
+    caller can continue with other work (e.g. interpolating one variable while the next is read). */
+class NetCdfReaderPool
+{
+public:
+    /** A Lease gives exclusive access to one reader of the pool,
+        the reader is returned to the pool when the lease is destroyed.
+        Any LazyNetCdfTensor created through the lease is then detached from the reader. */
+    class Lease
+    {
+    public:
+        Lease(Lease&& other) noexcept;
+        ~Lease();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        NetCdfFileReader& operator*() const { return *m_reader; }
+        NetCdfFileReader* operator->() const { return m_reader; }
+
+    private:
+        friend class NetCdfReaderPool;
+        Lease(NetCdfReaderPool* pool, NetCdfFileReader* reader);
+
+        NetCdfReaderPool* m_pool = nullptr;
+        NetCdfFileReader* m_reader = nullptr;
+    };
+
+    NetCdfReaderPool();
+
+    ~NetCdfReaderPool();
+
+    NetCdfReaderPool(const NetCdfReaderPool&) = delete;
+    NetCdfReaderPool& operator=(const NetCdfReaderPool&) = delete;
+
+    /** Opens the provided file once for each reader in the pool.
+        @param numberOfReaders The number of readers to open, zero selects one reader per hardware thread.
+        @param mode How the netcdf library should access the file, see NetCdfFileReader::Open.
+            Each reader holds its own copy of a file opened as Diskless, Automatic takes this into account.
+        @param accessPattern How the file is going to be read, used to select the mode when mode is Automatic.
+        @throws NetCdfException if the file cannot be opened. */
+    void Open(const std::string& filename, size_t numberOfReaders = 0, NetCdfOpenMode mode = NetCdfOpenMode::Normal, NetCdfAccessPattern accessPattern = NetCdfAccessPattern::WholeField);
+
+    /** Waits for all pending asynchronous reads and closes all readers.
+        No lease may be held when the pool is closed. */
+    void Close();
+
+    /** @return the number of readers in the pool. */
+    size_t NumberOfReaders() const { return m_readers.size(); }
+
+    /** Sizes the chunk cache of the provided variable in each of the readers, see NetCdfFileReader::TuneChunkCache.
+        Each reader has its own cache, the memory used is therefore up to NumberOfReaders() * maximumSizeInBytes.
+        No reads may be in progress while the caches are changed.
+        @throws NetCdfException if the variable cannot be found or the file cannot be read. */
+    void TuneChunkCache(const std::string& variableName, NetCdfAccessPattern accessPattern, size_t maximumSizeInBytes = NetCdfFileReader::DefaultMaximumChunkCacheSize);
+
+    /** Takes one reader from the pool, waiting until one is available if all are in use.
+        @throws NetCdfException if the pool is not opened. */
+    Lease Acquire();
+
+    /** Starts reading one variable in the background, see NetCdfFileReader::ReadVariable.
+        Errors are reported by the returned future, which throws the NetCdfException from get().
+        @throws NetCdfException if the pool is not opened. */
+    std::future<NetCdfTensor> ReadVariableAsync(const std::string& variableName);
+
+    /** Starts reading a hyperslab of one variable in the background, see NetCdfFileReader::ReadSlab.
+        Errors are reported by the returned future, which throws the NetCdfException from get().
+        @throws NetCdfException if the pool is not opened. */
+    std::future<NetCdfTensor> ReadSlabAsync(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count);
+
+    /** Starts reading the 2x2x2 cube surrounding one point in the background, see NetCdfFileReader::ReadNeighbourhood.
+        @param localIndices Is filled in immediately with the fractional indices of the point inside of the cube.
+        @param longitudeWrapsAround True if the longitude axis is periodic, see CoordinateAxis::WrapsAround.
+        @throws NetCdfException if the pool is not opened, if the variable cannot be found
+            or if the point lies outside of the variable. */
+    std::future<NetCdfTensor> ReadNeighbourhoodAsync(const std::string& variableName, const std::vector<double>& spatialIndices, std::vector<double>& localIndices, bool longitudeWrapsAround = false);
+
+    /** Starts reading the 2x2x2 cube surrounding one point in the background, for the time steps in the provided range only.
+        See NetCdfFileReader::ReadNeighbourhood.
+        @param localIndices Is filled in immediately with the fractional indices of the point inside of the cube.
+        @throws NetCdfException if the pool is not opened, if the variable cannot be found
+            or if the point or the time range lies outside of the variable. */
+    std::future<NetCdfTensor> ReadNeighbourhoodAsync(const std::string& variableName, const std::vector<double>& spatialIndices, const TimeRange& timeRange, std::vector<double>& localIndices, bool longitudeWrapsAround = false);
+
+    /** Reads the provided variables in parallel, each variable through its own reader.
+        @return the variables, in the same order as the names.
+        @throws NetCdfException if any variable cannot be found or the file cannot be read. */
+    std::vector<NetCdfTensor> ReadVariables(const std::vector<std::string>& variableNames);
+
+    /** Reads one variable by splitting it along its first dimension into one slab per reader
+        and decoding the slabs in parallel. The result is identical to NetCdfFileReader::ReadVariable.
+        @throws NetCdfException if the variable cannot be found or the file cannot be read. */
+    NetCdfTensor ReadVariable(const std::string& variableName);
+
+private:
+    std::vector<std::unique_ptr<NetCdfFileReader>> m_readers;
+
+    // The readers which are not currently leased out.
+    std::vector<NetCdfFileReader*> m_availableReaders;
+
+    std::mutex m_mutex;
+
+    std::condition_variable m_readerReturned;
+
+    // Runs the asynchronous reads, with one thread per reader.
+    std::unique_ptr<ThreadPool> m_threadPool;
+
+    /** @throws NetCdfException if the pool is not opened. */
+    ThreadPool& GetThreadPool();
+
+    void Release(NetCdfFileReader* reader);
+
+    /** Starts reading the slab of a neighbourhood calculated by GetNeighbourhoodSlab in the background. */
+    std::future<NetCdfTensor> ReadNeighbourhoodSlabAsync(const std::string& variableName, const std::vector<size_t>& variableSize, const std::vector<size_t>& start, const std::vector<size_t>& count);
+};
@@ -0,0 +1,170 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <string>
+
+/** The linear scaling which is to be applied to the values stored in the file,
+    as defined by the attributes 'scale_factor' and 'add_offset' of a variable.
+    value = storedValue * scaleFactor + offset */
+struct LinearScaling
+{
+    double offset = 0.0;
+    double scaleFactor = 1.0;
+};
+
+/** The values which mark missing data in a variable, as defined by the attributes
+    '_FillValue', 'missing_value', 'valid_range', 'valid_min' and 'valid_max' of the variable.
+    These are compared to the values as they are stored in the file, before any linear scaling is applied. */
+struct MissingValues
+{
+    // Stored values which are equal to any of these are missing.
+    std::vector<double> invalidValues;
+
+    // Stored values outside of the range [validMinimum, validMaximum] are missing.
+    double validMinimum = -std::numeric_limits<double>::infinity();
+    double validMaximum = std::numeric_limits<double>::infinity();
+
+    // @return true if no value of the variable can be missing.
+    bool IsEmpty() const
+    {
+        return invalidValues.empty() && validMinimum == -std::numeric_limits<double>::infinity() && validMaximum == std::numeric_limits<double>::infinity();
+    }
+
+    // @return true if the provided stored value is not missing.
+    bool IsValid(double storedValue) const
+    {
+        if (!(storedValue >= validMinimum && storedValue <= validMaximum))
+        {
+            return false;
+        }
+        for (double invalidValue : invalidValues)
+        {
+            if (storedValue == invalidValue)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+struct NetCdfDimension
+{
+    int index;
+    std::string name;
+};
+
+struct NetCdfTensor
+{
+    // Defines the number of dimensions of this variable
+    //  and the size in each dimension.
+    std::vector<size_t> size;
+
+    // The dimensions of this variable
+    std::vector<NetCdfDimension> dimensions;
+
+    // Stores the values of this variable.
+    //  Multi-dimensional variables are stored as flattened arrays.
+    //  Values which are missing in the file are stored as NaN.
+    std::vector<float> values;
+
+    // Marks which of the values are valid, with one bit per value: the value with index ii
+    //  is valid if bit (ii % 8) of validity[ii / 8] is set.
+    //  This is empty if the variable does not define any missing values, then all values are valid.
+    std::vector<uint8_t> validity;
+
+    // The name of the variable.
+    std::string name;
+
+    // @return the value with the provided (flattened) index.
+    float operator[](size_t index) const
+    {
+        return values[index];
+    }
+
+    // @return true if the value with the provided (flattened) index is not missing.
+    bool IsValid(size_t index) const
+    {
+        return validity.empty() || ((validity[index >> 3] >> (index & 7)) & 1) != 0;
+    }
+};
+
+/** PackedNetCdfTensor keeps the values of a variable in the packed form
+    in which they are stored in the file (16-bit integers), together with the linear scaling
+    which is needed to decode them. This takes half of the memory of a NetCdfTensor
+    and the values are only decoded when they are accessed. */
+struct PackedNetCdfTensor
+{
+    // Defines the number of dimensions of this variable
+    //  and the size in each dimension.
+    std::vector<size_t> size;
+
+    // The dimensions of this variable
+    std::vector<NetCdfDimension> dimensions;
+
+    // Stores the packed values of this variable, as they are stored in the file.
+    //  Multi-dimensional variables are stored as flattened arrays.
+    std::vector<short> packedValues;
+
+    // The linear scaling which decodes the packed values.
+    LinearScaling scaling;
+
+    // The packed values which mark missing data.
+    MissingValues missingValues;
+
+    // The name of the variable.
+    std::string name;
+
+    // @return the decoded value with the provided (flattened) index.
+    float operator[](size_t index) const
+    {
+        return (float)(packedValues[index] * scaling.scaleFactor + scaling.offset);
+    }
+
+    // @return true if the value with the provided (flattened) index is not missing.
+    bool IsValid(size_t index) const
+    {
+        return missingValues.IsValid(packedValues[index]);
+    }
+};
+
+/** TypedNetCdfTensor keeps the values of a variable in the type in which they are read from the file
+    (int, short, float or double), without any conversion through float.
+    The linear scaling and the missing values of the variable are not applied to the values,
+    these are returned together with the values and applied when the values are accessed through operator[]. */
+template<class T>
+struct TypedNetCdfTensor
+{
+    // Defines the number of dimensions of this variable
+    //  and the size in each dimension.
+    std::vector<size_t> size;
+
+    // The dimensions of this variable
+    std::vector<NetCdfDimension> dimensions;
+
+    // Stores the values of this variable, as they are stored in the file.
+    //  Multi-dimensional variables are stored as flattened arrays.
+    std::vector<T> values;
+
+    // The linear scaling of the values.
+    LinearScaling scaling;
+
+    // The stored values which mark missing data.
+    MissingValues missingValues;
+
+    // The name of the variable.
+    std::string name;
+
+    // @return the value with the provided (flattened) index, with the linear scaling applied.
+    double operator[](size_t index) const
+    {
+        return values[index] * scaling.scaleFactor + scaling.offset;
+    }
+
+    // @return true if the value with the provided (flattened) index is not missing.
+    bool IsValid(size_t index) const
+    {
+        return missingValues.IsValid((double)values[index]);
+    }
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <mutex>
+#include <vector>
+#include "NetCdfTensor.h"
+
+/** NetCdfTensorPool keeps the memory of tensors which are no longer used, such that it can be reused
+    when the next variable (or file) is read. Together with NetCdfFileReader::ReadVariable(name, tensor)
+    this avoids allocating (and page-faulting in) new, possibly very large, buffers for every read.
+    The pool is thread-safe. */
+class NetCdfTensorPool
+{
+public:
+    /** @param maximumNumberOfTensors The largest number of tensors kept in the pool,
+        when more tensors are released the smallest ones are freed. */
+    explicit NetCdfTensorPool(size_t maximumNumberOfTensors = 8);
+
+    NetCdfTensorPool(const NetCdfTensorPool&) = delete;
+    NetCdfTensorPool& operator=(const NetCdfTensorPool&) = delete;
+
+    /** Takes one tensor from the pool. This is the smallest tensor which has room for numberOfValues values,
+        or the largest tensor in the pool if none is large enough. If the pool is empty then a new tensor is returned.
+        The returned tensor is empty, but keeps its allocated memory. */
+    NetCdfTensor Acquire(size_t numberOfValues = 0);
+
+    /** Returns a tensor to the pool, such that its memory can be reused by the next call to Acquire. */
+    void Release(NetCdfTensor&& tensor);
+
+    /** @return the number of tensors currently kept in the pool. */
+    size_t NumberOfTensors() const;
+
+    /** Frees all the tensors kept in the pool. */
+    void Clear();
+
+private:
+    const size_t m_maximumNumberOfTensors;
+
+    std::vector<NetCdfTensor> m_tensors;
+
+    mutable std::mutex m_mutex;
+};
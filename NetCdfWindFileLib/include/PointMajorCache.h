@@ -0,0 +1,147 @@
+#pragma once
+#include <fstream>
+#include <map>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "FileFingerprint.h"
+#include "NetCdfException.h"
+#include "NetCdfTensor.h"
+#include "TimeCoordinate.h"
+
+/** The point-major cache is a binary file holding variables with the dimensions [time, level, latitude, longitude]
+    transposed such that the full time series of each grid cell is stored contiguously.
+    Extracting the time series at one point from a net cdf file means reading one value every
+    level * latitude * longitude values, from the point-major cache the same series is one sequential read.
+    The values are stored as float (in the byte order of the machine), with the linear scaling applied and
+    missing values stored as NaN.
+    The header of the cache holds the fingerprint of the net cdf file it was created from, such that a cache
+    which no longer matches its source can be detected, and the values of the coordinate variables.
+    The cache is created once using ConvertToPointMajorCache and can then be read many times using PointMajorCacheFile. */
+
+/** PointMajorCacheWriter creates a point-major cache file, which is filled in one block of grid cells at a time. */
+class PointMajorCacheWriter
+{
+public:
+    PointMajorCacheWriter() = default;
+
+    ~PointMajorCacheWriter();
+
+    PointMajorCacheWriter(const PointMajorCacheWriter&) = delete;
+    PointMajorCacheWriter& operator=(const PointMajorCacheWriter&) = delete;
+
+    /** Creates the cache file with room for the provided variables and their sizes.
+        The first dimension of each variable is the time.
+        @param sourceFingerprint The fingerprint of the net cdf file which the values are read from.
+        @param coordinates The values of the coordinate variables of the source file, stored in the header.
+        @throws NetCdfException if the file cannot be created or if a variable has no dimensions. */
+    void Create(const std::string& filename, const FileFingerprint& sourceFingerprint, const std::map<std::string, std::vector<size_t>>& variables, const std::map<std::string, std::vector<double>>& coordinates);
+
+    /** Writes the full time series of a range of consecutive grid cells of one variable into the cache.
+        The series of these cells are adjacent in the cache, the block is therefore written in one contiguous run.
+        @param firstCellIndex The flattened [level, latitude, longitude] index of the first cell in the block.
+        @param block The values of the block, with all the time steps of the variable along the first dimension.
+            The cells of one time step, in the order of their flattened index, must be consecutive cells of the variable,
+            e.g. as read by NetCdfFileReader::ReadSlab with the full extent in all but one of the spatial dimensions.
+        @throws NetCdfException if the variable is not in the cache, if the block does not fit into
+            the variable or if the file cannot be written. */
+    void WriteCells(const std::string& variableName, size_t firstCellIndex, const NetCdfTensor& block);
+
+    /** Completes the cache file.
+        @throws NetCdfException if the file cannot be written. */
+    void Close();
+
+private:
+    struct VariableInformation
+    {
+        std::vector<size_t> size;
+        uint64_t dataOffset = 0;
+    };
+
+    std::ofstream m_file;
+
+    std::string m_filename;
+
+    std::map<std::string, VariableInformation> m_variables;
+
+    // The time series of each cell in the block being written.
+    std::vector<float> m_transposedBlock;
+};
+
+/** PointMajorCacheFile reads the time series of points from a point-major cache file. This is not thread-safe. */
+class PointMajorCacheFile
+{
+public:
+    PointMajorCacheFile() = default;
+
+    PointMajorCacheFile(const PointMajorCacheFile&) = delete;
+    PointMajorCacheFile& operator=(const PointMajorCacheFile&) = delete;
+
+    /** Opens the cache file with the provided filename and reads its header.
+        @throws NetCdfException if the file cannot be opened or is not a point-major cache file. */
+    void Open(const std::string& filename);
+
+    void Close();
+
+    /** @return the fingerprint of the net cdf file which the cache was created from. */
+    const FileFingerprint& GetSourceFingerprint() const { return m_sourceFingerprint; }
+
+    /** @return true if the provided net cdf file is unchanged since the cache was created from it.
+        @throws NetCdfException if the fingerprint of the file cannot be retrieved. */
+    bool IsUpToDate(const std::string& sourceFilename) const;
+
+    /** @return true if the cache contains the values of the coordinate variable with the provided name. */
+    bool ContainsCoordinate(const std::string& coordinateName) const;
+
+    /** @return the values of the coordinate variable with the provided name, with the linear scaling applied.
+        @throws NetCdfException if the coordinate cannot be found. */
+    const std::vector<double>& GetCoordinate(const std::string& coordinateName) const;
+
+    /** @return true if the cache contains a variable with the provided name. */
+    bool ContainsVariable(const std::string& variableName) const;
+
+    /** @return the size of the variable with the provided name, in the order [time, level, latitude, longitude].
+        @throws NetCdfException if the variable cannot be found. */
+    std::vector<size_t> GetSizeOfVariable(const std::string& variableName) const;
+
+    /** Reads the 2x2x2 cube of values surrounding one point, for all points in time,
+        in the same layout as NetCdfFileReader::ReadNeighbourhood, such that the result can be passed on to InterpolateWind.
+        @param longitudeWrapsAround True if the longitude axis is periodic, see CoordinateAxis::WrapsAround.
+        @throws NetCdfException if the variable cannot be found, if the point lies outside of the variable
+            or if the file cannot be read. */
+    NetCdfTensor ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, std::vector<double>& localIndices, bool longitudeWrapsAround = false);
+
+    /** Reads the 2x2x2 cube of values surrounding one point, as above, for the time steps in the provided range only.
+        @throws NetCdfException if the variable cannot be found, if the point or the time range lies outside of the variable
+            or if the file cannot be read. */
+    NetCdfTensor ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, const TimeRange& timeRange, std::vector<double>& localIndices, bool longitudeWrapsAround = false);
+
+private:
+    struct VariableInformation
+    {
+        std::vector<size_t> size;
+        uint64_t dataOffset = 0;
+    };
+
+    std::ifstream m_file;
+
+    std::string m_filename;
+
+    std::map<std::string, VariableInformation> m_variables;
+
+    FileFingerprint m_sourceFingerprint;
+
+    std::map<std::string, std::vector<double>> m_coordinates;
+
+    // The time series of the corners of the cube being read.
+    std::vector<float> m_timeSeries;
+
+    const VariableInformation& FindVariable(const std::string& variableName) const;
+};
+
+/** Creates a point-major cache file holding the provided variables of the net cdf file with the provided name,
+    together with the coordinate variables of their dimensions.
+    The variables are read in tiles of consecutive grid cells with all their time steps, of at most maximumBytesPerTile
+    (but a tile always holds at least one cell), transposed in memory and each tile written in one contiguous run.
+    @throws NetCdfException if the file cannot be opened, if a variable cannot be found or read or if the cache cannot be written. */
+void ConvertToPointMajorCache(const std::string& sourceFilename, const std::vector<std::string>& variableNames, const std::string& cacheFilename, size_t maximumBytesPerTile = (size_t)1 << 28);
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "NetCdfTensor.h"
+
+// Decodes numberOfValues packed 16-bit values into floats by applying the provided linear scaling, i.e.
+//  destination[ii] = (float)(source[ii] * scaling.scaleFactor + scaling.offset)
+//  The values are converted and scaled in one pass, using AVX2 or SSE2 instructions where these are available.
+//  The result is identical to performing the calculation above one value at a time.
+//  Very large arrays are split over several threads.
+void DecodePackedValues(const short* source, size_t numberOfValues, const LinearScaling& scaling, float* destination);
+
+// Decodes the packed values as above and masks out the missing values in the same pass.
+//  Missing values are written as NaN to the destination. The validity of each value is written
+//  to the bitmap 'validity' (see NetCdfTensor::validity), starting at bit number 'firstBit'.
+//  Only the bits of the decoded values are changed.
+void DecodePackedValues(const short* source, size_t numberOfValues, const LinearScaling& scaling, const MissingValues& missingValues, float* destination, uint8_t* validity, size_t firstBit);
+
+// Applies the linear scaling to the provided values, in place.
+void ApplyLinearScaling(std::vector<float>& values, const LinearScaling& scaling);
+void ApplyLinearScaling(float* values, size_t numberOfValues, const LinearScaling& scaling);
+
+// Applies the linear scaling to the provided values, in place, and masks out the missing values in the same pass.
+//  Missing values are set to NaN and the validity of each value is written to the bitmap 'validity',
+//  which must have room for one bit per value.
+void ApplyLinearScaling(std::vector<float>& values, const LinearScaling& scaling, const MissingValues& missingValues, uint8_t* validity);
+void ApplyLinearScaling(float* values, size_t numberOfValues, const LinearScaling& scaling, const MissingValues& missingValues, uint8_t* validity);
+
+// Applies the linear scaling to values which were read as double, writes the scaled values as floats to the destination
+//  and masks out the missing values in the same pass. Used for variables of other types than short and float,
+//  such that the missing values are found before the values are rounded to float
+//  (e.g. the integer fill value -2147483647 is not representable as a float).
+void ApplyLinearScaling(const double* source, size_t numberOfValues, const LinearScaling& scaling, const MissingValues& missingValues, float* destination, uint8_t* validity);
+
+// Copies the validity bits of numberOfValues values from the bitmap 'source' (starting at bit zero)
+//  to the bitmap 'destination', starting at bit number 'firstDestinationBit'.
+void CopyValidityBits(const uint8_t* source, size_t numberOfValues, uint8_t* destination, size_t firstDestinationBit);
+
+// @return true if both the processor and the operating system support AVX2 instructions.
+//  Always false when not compiling for x86 / x64.
+bool CpuSupportsAvx2();
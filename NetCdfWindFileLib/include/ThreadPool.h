@@ -0,0 +1,61 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/** ThreadPool runs submitted tasks on a fixed number of worker threads.
+    Each task returns a std::future, through which its result (or exception) is retrieved.
+    The pool finishes all submitted tasks before it is destroyed. */
+class ThreadPool
+{
+public:
+    /** @param numberOfThreads The number of worker threads, zero selects one per hardware thread. */
+    explicit ThreadPool(size_t numberOfThreads = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** @return the number of worker threads in the pool. */
+    size_t NumberOfThreads() const { return m_threads.size(); }
+
+    /** Queues the provided function to be run on one of the worker threads.
+        @return a future which receives the return value of the function, or the exception thrown by it. */
+    template<class Function>
+    auto Submit(Function function) -> std::future<decltype(function())>
+    {
+        // std::result_of is deprecated in C++17 and removed in C++20, the type is deduced from the call instead.
+        typedef decltype(function()) ResultType;
+
+        // std::function must be copyable, the task is therefore shared.
+        auto task = std::make_shared<std::packaged_task<ResultType()>>(std::move(function));
+        std::future<ResultType> result = task->get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push([task]() { (*task)(); });
+        }
+        m_taskAdded.notify_one();
+
+        return result;
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+
+    std::queue<std::function<void()>> m_tasks;
+
+    std::mutex m_mutex;
+
+    std::condition_variable m_taskAdded;
+
+    bool m_stopping = false;
+
+    void RunTasks();
+};
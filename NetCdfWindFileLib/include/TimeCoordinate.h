@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "NetCdfException.h"
+
+/** The units of a time coordinate, as given by its 'units' attribute
+    following the CF conventions, e.g. "hours since 1900-01-01 00:00:00.0". */
+struct TimeUnits
+{
+    // The length of one unit, in seconds.
+    double secondsPerUnit = 1.0;
+
+    // The reference time, in seconds since 1970-01-01 00:00:00 UTC.
+    double referenceTime = 0.0;
+};
+
+/** Parses the 'units' attribute of a time coordinate, on the form "<unit> since <date> [<time>] [<time zone>]".
+    The unit may be seconds, minutes, hours or days (or the abbreviations s, min, h and d).
+    @throws NetCdfException if the units cannot be parsed. */
+TimeUnits ParseTimeUnits(const std::string& units);
+
+/** Parses a date and time on the form "yyyy-mm-dd [hh:mm[:ss]] [time zone]",
+    where the date and time may also be separated by 'T' and the time zone is 'Z', 'UTC' or an offset such as "+01:00".
+    @return the time in seconds since 1970-01-01 00:00:00 UTC.
+    @throws NetCdfException if the text cannot be parsed. */
+double ParseDateTime(const std::string& dateTime);
+
+/** A range of indices [first, first + count) along the time dimension. */
+struct TimeRange
+{
+    size_t first = 0;
+    size_t count = 0;
+};
+
+/** TimeCoordinate is the decoded time coordinate of a net cdf file, which allows
+    finding the time steps lying inside of a window in time without looking at every time step.
+    Created using NetCdfFileReader::ReadTimeCoordinate. */
+class TimeCoordinate
+{
+public:
+    TimeCoordinate() = default;
+
+    /** @param values The values of the time coordinate, in the provided units.
+        @throws NetCdfException if the values are not sorted in increasing order. */
+    TimeCoordinate(std::vector<double> values, const TimeUnits& units);
+
+    /** @return the number of time steps. */
+    size_t size() const { return m_values.size(); }
+
+    /** @return the time of the provided time step, in seconds since 1970-01-01 00:00:00 UTC. */
+    double SecondsSinceEpoch(size_t index) const { return m_units.referenceTime + m_values[index] * m_units.secondsPerUnit; }
+
+    /** @return the range of time steps lying between the provided times (inclusive),
+            given in seconds since 1970-01-01 00:00:00 UTC. The range is empty if no time step lies in the window.
+        The range is found using a binary search. */
+    TimeRange FindRange(double firstTime, double lastTime) const;
+
+    /** @return the values of the time coordinate, in the units of the file. */
+    const std::vector<double>& Values() const { return m_values; }
+
+    const TimeUnits& Units() const { return m_units; }
+
+private:
+    std::vector<double> m_values;
+
+    TimeUnits m_units;
+};
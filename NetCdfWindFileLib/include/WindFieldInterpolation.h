@@ -1,5 +1,11 @@
 #pragma once
 #include <vector>
+#include "NetCdfTensor.h"
+#include "InterpolationKernels.h"
+
+class MappedNetCdfVariable;
+class LazyNetCdfTensor;
+class ThreadPool;
 
 // Returns the (first) index into the provided vector where the valueToFind lies between
 //  the value before and the value after.
@@ -13,16 +19,17 @@ double GetFractionalIndex(const std::vector<float>& values, float valueToFind);
 //  @throws std::invalid_argument if index < 0 or index >= values.size();
 double Interpolate(const std::vector<float>& values, double index);
 
-struct EstimatedValue
-{
-    double value;
-    double uncertainty;
-};
-
 // Performs a tri-linear interpolation on the input values, which must have the dimensions 2x2x2
 //  at the index values (which all must be in the interval [0,1])
+//  See InterpolationKernels.h for the versions on std::array, which do not allocate any memory.
 EstimatedValue TriLinearInterpolation(const std::vector<double>& inputCube, double idxZ, double idxY, double idxX);
 
+// Performs the same interpolation as above, using only the corners of the cube which are marked as valid.
+//  The weights of the remaining corners are re-normalized. If there are no valid corners with a non-zero weight
+//  then the value is NaN. If only one of the levels (idxZ = 0 or idxZ = 1) has valid corners
+//  then the uncertainty cannot be estimated and is zero.
+EstimatedValue TriLinearInterpolation(const std::vector<double>& inputCube, const std::vector<bool>& validCorners, double idxZ, double idxY, double idxX);
+
 struct InterpolatedWind
 {
     std::vector<double> speed;
@@ -53,6 +60,59 @@ void InterpolateWind(
     const std::vector<double>& spatialIndices,
     InterpolatedWind& result);
 
+/** Performs the same interpolation as InterpolateWind above, for one block of time steps of a larger wind-field.
+    This makes it possible to process a wind-field in blocks as they are read from file (see NetCdfTimeBlockReader).
+    @param firstTimeIndex The index of the first time step in u and v, within the full wind-field.
+    @param result The results for the time steps in this block are written to the
+        indices [firstTimeIndex, firstTimeIndex + size[0]) in the result. Any other values in result are left unchanged.
+    @throws invalid_argument if u and v are not four-dimensional matrices. */
+void InterpolateWind(
+    const std::vector<float>& u,
+    const std::vector<float>& v,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    size_t firstTimeIndex,
+    InterpolatedWind& result);
+
+/** Performs the same interpolation as InterpolateWind above, on wind-fields read using NetCdfFileReader.
+    Values which are missing in the file (see NetCdfTensor::validity) are left out of the interpolation
+        and the remaining corners of the cube are re-weighted, see TriLinearInterpolation.
+    @throws invalid_argument if u and v are not four-dimensional or do not have the same size. */
+void InterpolateWind(
+    const NetCdfTensor& u,
+    const NetCdfTensor& v,
+    const std::vector<double>& spatialIndices,
+    InterpolatedWind& result);
+
+/** Performs the same interpolation as InterpolateWind above, on wind-fields which are kept packed in memory.
+    Only the values which are used in the interpolation are decoded. Missing values are handled
+        in the same way as for NetCdfTensor.
+    @throws invalid_argument if u and v are not four-dimensional or do not have the same size. */
+void InterpolateWind(
+    const PackedNetCdfTensor& u,
+    const PackedNetCdfTensor& v,
+    const std::vector<double>& spatialIndices,
+    InterpolatedWind& result);
+
+/** Performs the same interpolation as InterpolateWind above,
+    reading the values directly from views into a memory mapped net cdf file.
+    @throws invalid_argument if u and v are not four-dimensional or do not have the same size. */
+void InterpolateWind(
+    const MappedNetCdfVariable& u,
+    const MappedNetCdfVariable& v,
+    const std::vector<double>& spatialIndices,
+    InterpolatedWind& result);
+
+/** Performs the same interpolation as InterpolateWind above, on wind-fields which are read lazily from file.
+    Only the blocks of u and v which contain the surrounding values are read.
+    @throws invalid_argument if u and v are not four-dimensional or do not have the same size.
+    @throws NetCdfException if the values cannot be read. */
+void InterpolateWind(
+    const LazyNetCdfTensor& u,
+    const LazyNetCdfTensor& v,
+    const std::vector<double>& spatialIndices,
+    InterpolatedWind& result);
+
 /** Performs a linear interpolation to retrieve values from the given four-dimensional
     vector at all points in time for the provided spatial indices.
     This differens from the function 'InterpolateWind' in that no values are calculated,
@@ -65,3 +125,114 @@ void InterpolateValue(
     const std::vector<double>& spatialIndices,
     std::vector<double>& result);
 
+/** Performs the same interpolation as InterpolateValue above, for one block of time steps of a larger tensor.
+    The results are written to the indices [firstTimeIndex, firstTimeIndex + size[0]) in the result.
+    @throws invalid_argument if values is not a four-dimensional matrix.
+    */
+void InterpolateValue(
+    const std::vector<float>& values,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    size_t firstTimeIndex,
+    std::vector<double>& result);
+
+/** Performs the same interpolation as InterpolateValue above, on values read using NetCdfFileReader.
+    Values which are missing in the file (see NetCdfTensor::validity) are left out of the interpolation.
+    @throws invalid_argument if values is not a four-dimensional matrix.
+    */
+void InterpolateValue(
+    const NetCdfTensor& values,
+    const std::vector<double>& spatialIndices,
+    std::vector<double>& result);
+
+/** Performs the same interpolation as InterpolateValue above,
+    reading the values directly from a view into a memory mapped net cdf file.
+    @throws invalid_argument if values is not a four-dimensional matrix.
+    */
+void InterpolateValue(
+    const MappedNetCdfVariable& values,
+    const std::vector<double>& spatialIndices,
+    std::vector<double>& result);
+
+/** Performs the same interpolation as InterpolateValue above, on values which are kept packed in memory.
+    Only the values which are used in the interpolation are decoded. Missing values are left out of the interpolation.
+    @throws invalid_argument if values is not a four-dimensional matrix.
+    */
+void InterpolateValue(
+    const PackedNetCdfTensor& values,
+    const std::vector<double>& spatialIndices,
+    std::vector<double>& result);
+
+/** Performs the same interpolation as InterpolateValue above, on values which are read lazily from file.
+    Only the blocks which contain the surrounding values are read. Missing values are left out of the interpolation.
+    @throws invalid_argument if values is not a four-dimensional matrix.
+    @throws NetCdfException if the values cannot be read.
+    */
+void InterpolateValue(
+    const LazyNetCdfTensor& values,
+    const std::vector<double>& spatialIndices,
+    std::vector<double>& result);
+
+/** Performs the same interpolation as InterpolateWind above, with the time steps split over the threads of the provided pool.
+    Each thread interpolates its own range of time steps directly into the result, which is allocated before the threads start.
+        The result is therefore identical to that of the single-threaded version, independently of the number of threads.
+    Short series are interpolated on the calling thread.
+    This must not be called from one of the tasks of the same pool, since it waits for the tasks it submits.
+    LazyNetCdfTensor is not supported, since its cache of blocks cannot be shared between threads.
+    @throws invalid_argument if u and v are not four-dimensional matrices. */
+void InterpolateWind(
+    const std::vector<float>& u,
+    const std::vector<float>& v,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    InterpolatedWind& result);
+
+void InterpolateWind(
+    const NetCdfTensor& u,
+    const NetCdfTensor& v,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    InterpolatedWind& result);
+
+void InterpolateWind(
+    const PackedNetCdfTensor& u,
+    const PackedNetCdfTensor& v,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    InterpolatedWind& result);
+
+void InterpolateWind(
+    const MappedNetCdfVariable& u,
+    const MappedNetCdfVariable& v,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    InterpolatedWind& result);
+
+/** Performs the same interpolation as InterpolateValue above, with the time steps split over the threads of the provided pool,
+    in the same way as the multi-threaded InterpolateWind.
+    @throws invalid_argument if values is not a four-dimensional matrix. */
+void InterpolateValue(
+    const std::vector<float>& values,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    std::vector<double>& result);
+
+void InterpolateValue(
+    const NetCdfTensor& values,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    std::vector<double>& result);
+
+void InterpolateValue(
+    const PackedNetCdfTensor& values,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    std::vector<double>& result);
+
+void InterpolateValue(
+    const MappedNetCdfVariable& values,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    std::vector<double>& result);
@@ -0,0 +1,54 @@
+#pragma once
+#include <map>
+#include <vector>
+#include <string>
+#include "NetCdfException.h"
+
+class NetCdfFileReader;
+class CoordinateAxis;
+
+/** The names of the variables which make up a wind field in a net cdf file.
+    The fields have the dimensions [time, level, latitude, longitude], which are
+    defined by the one-dimensional coordinate variables. */
+struct WindFieldVariableNames
+{
+    std::string time = "time";
+    std::string level = "level";
+    std::string latitude = "latitude";
+    std::string longitude = "longitude";
+
+    // The fields which must exist in the file.
+    std::vector<std::string> requiredFields = { "u", "v" };
+
+    // The fields which are validated if they exist in the file.
+    std::vector<std::string> optionalFields = { "r", "rh", "cc" };
+};
+
+/** The names and lengths of the dimensions of one variable, as given by the catalogue of the file. */
+struct VariableShape
+{
+    std::vector<std::string> dimensionNames;
+    std::vector<size_t> size;
+};
+
+/** Checks that the coordinate variables are one-dimensional and that each of the fields has the
+    dimensions [time, level, latitude, longitude] of the coordinate variables, in this order and with the same lengths.
+    Variables which are missing from 'variables' are treated as missing from the file.
+    @return a description of each problem found, or an empty vector if the wind field is consistent. */
+std::vector<std::string> FindWindFieldInconsistencies(const std::map<std::string, VariableShape>& variables, const WindFieldVariableNames& names = WindFieldVariableNames());
+
+/** Performs the checks of FindWindFieldInconsistencies on the variables of the provided file.
+    Only the catalogue of the file is used, no values are read.
+    @throws NetCdfException with all the problems found, if the wind field is not consistent. */
+void ValidateWindField(NetCdfFileReader& reader, const WindFieldVariableNames& names = WindFieldVariableNames());
+
+/** Checks that the site lies inside of the grid spanned by the provided coordinates.
+    The longitude of the site may be given in either of the ranges [-180, 180] or [0, 360], independently of the grid,
+    and global grids are considered to wrap around from the last to the first longitude (see CoordinateAxis).
+    @throws NetCdfException if the site lies outside of the grid. */
+void ValidateSiteIsInsideOfGrid(const std::vector<float>& latitude, const std::vector<float>& longitude, double siteLatitude, double siteLongitude);
+
+/** Checks that the site lies inside of the grid spanned by the provided axes, as above.
+    The longitude axis should be periodic, such that it wraps around if the grid is global.
+    @throws NetCdfException if the site lies outside of the grid. */
+void ValidateSiteIsInsideOfGrid(const CoordinateAxis& latitudeAxis, const CoordinateAxis& longitudeAxis, double siteLatitude, double siteLongitude);
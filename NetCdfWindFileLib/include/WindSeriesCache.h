@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "FileFingerprint.h"
+#include "NetCdfException.h"
+#include "WindFieldInterpolation.h"
+
+/** The location of one site (volcano) for which the wind is extracted. */
+struct SiteLocation
+{
+    double latitude = 0.0;
+    double longitude = 0.0;
+
+    // The altitude in meters above sea level.
+    double altitude = 0.0;
+};
+
+/** Appends the time steps of 'additionalTimeSteps' to the end of 'series'. */
+void AppendTimeSteps(InterpolatedWind& series, const InterpolatedWind& additionalTimeSteps);
+
+/** WindSeriesCache is an on-disk cache of the interpolated wind series at sites, such that
+    repeated extractions of the same site from the same input file can skip reading and interpolating the file.
+    There is one cache entry for each input file and site. An entry is used in full if the fingerprint of
+    the input file is identical to when the entry was stored. If the file has only grown along time since then,
+    i.e. it is strictly larger and the hash of the time steps in the entry matches the first time steps of the file,
+    then the entry is used for these time steps and only the new time steps need to be interpolated.
+    This assumes that the time steps which already were in the file are not rewritten. Any other change discards the entry. */
+class WindSeriesCache
+{
+public:
+    /** @param cacheDirectory The directory in which the entries are stored, this must exist. */
+    explicit WindSeriesCache(const std::string& cacheDirectory);
+
+    /** Looks up the cached series for the provided input file and site.
+        @param times The time of each time step in the input file, in seconds since 1970-01-01 00:00:00 UTC.
+        @param series Will on return be filled with the cached time steps.
+        @return the number of cached time steps, these are always the first time steps of the file.
+            Returns zero if there is no usable entry. */
+    size_t Lookup(const std::string& inputFilename, const FileFingerprint& fingerprint, const SiteLocation& site, const std::vector<double>& times, InterpolatedWind& series) const;
+
+    /** Stores the series of the first time steps of the provided input file, replacing any previous entry.
+        @param times The time of each time step in the series, in seconds since 1970-01-01 00:00:00 UTC.
+        @throws NetCdfException if the series does not have one value for each time, if the cloud coverage or the
+            relative humidity is neither empty nor has one value for each time, or if the entry cannot be written. */
+    void Store(const std::string& inputFilename, const FileFingerprint& fingerprint, const SiteLocation& site, const std::vector<double>& times, const InterpolatedWind& series);
+
+    /** Removes the entry of the provided input file and site, if there is one. */
+    void Remove(const std::string& inputFilename, const SiteLocation& site);
+
+private:
+    std::string m_cacheDirectory;
+
+    /** @return the name of the file holding the entry for the provided input file and site. */
+    std::string GetEntryFilename(const std::string& inputFilename, const SiteLocation& site) const;
+};
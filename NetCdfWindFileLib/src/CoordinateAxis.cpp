@@ -0,0 +1,161 @@
+#include "CoordinateAxis.h"
+#include "WindFieldInterpolation.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+CoordinateAxis::CoordinateAxis(const std::vector<float>& values)
+    : m_values(values)
+{
+    if (m_values.size() < 2)
+    {
+        return;
+    }
+
+    if (std::adjacent_find(m_values.begin(), m_values.end(), std::greater_equal<float>()) == m_values.end())
+    {
+        m_ordering = Ordering::Ascending;
+    }
+    else if (std::adjacent_find(m_values.begin(), m_values.end(), std::less_equal<float>()) == m_values.end())
+    {
+        m_ordering = Ordering::Descending;
+    }
+    else
+    {
+        return;
+    }
+
+    // The axis is uniform if every value lies (within the precision of float) where an evenly spaced axis would have it.
+    m_step = ((double)m_values.back() - (double)m_values.front()) / (double)(m_values.size() - 1);
+    const double tolerance = 1e-4 * std::abs(m_step);
+    m_isUniform = true;
+    for (size_t ii = 0; ii < m_values.size() && m_isUniform; ++ii)
+    {
+        m_isUniform = std::abs((double)m_values[ii] - ((double)m_values.front() + ii * m_step)) <= tolerance;
+    }
+}
+
+CoordinateAxis::CoordinateAxis(const std::vector<float>& values, double period)
+    : CoordinateAxis(values)
+{
+    if (m_values.size() == 0 || period <= 0.0)
+    {
+        return;
+    }
+
+    m_period = period;
+    m_minimum = *std::min_element(m_values.begin(), m_values.end());
+
+    if (m_ordering == Ordering::Unsorted)
+    {
+        return;
+    }
+
+    double largestSpacing = 0.0;
+    for (size_t ii = 1; ii < m_values.size(); ++ii)
+    {
+        largestSpacing = std::max(largestSpacing, std::abs((double)m_values[ii] - (double)m_values[ii - 1]));
+    }
+    const double gap = period - std::abs((double)m_values.back() - (double)m_values.front());
+    m_wrapsAround = gap > 0.0 && gap <= largestSpacing * (1.0 + 1e-4);
+}
+
+double CoordinateAxis::IndexInInterval(size_t intervalIdx, double value) const
+{
+    const double low = m_values[intervalIdx];
+    const double high = m_values[intervalIdx + 1];
+    return (double)intervalIdx + (value - low) / (high - low);
+}
+
+double CoordinateAxis::FindFractionalIndex(double value) const
+{
+    if (m_period > 0.0)
+    {
+        double offset = std::fmod(value - m_minimum, m_period);
+        if (offset < 0.0)
+        {
+            offset += m_period;
+        }
+        value = m_minimum + offset;
+    }
+
+    if (m_ordering == Ordering::Unsorted)
+    {
+        try
+        {
+            return ::GetFractionalIndex(m_values, (float)value);
+        }
+        catch (std::invalid_argument&)
+        {
+            return -1.0;
+        }
+    }
+
+    const double first = m_values.front();
+    const double last = m_values.back();
+    if (!(m_ordering == Ordering::Ascending ? (value >= first && value <= last) : (value <= first && value >= last)))
+    {
+        if (!m_wrapsAround)
+        {
+            return -1.0;
+        }
+
+        // The value lies in the gap between the last and the first value (one period later).
+        const double lastIdx = (double)(m_values.size() - 1);
+        const double index = (m_ordering == Ordering::Ascending) ?
+            lastIdx + (value - last) / (first + m_period - last) :
+            lastIdx + (last + m_period - value) / (last + m_period - first);
+
+        // A value which is rounded onto the first value one period later is the first value.
+        return (index < (double)m_values.size()) ? index : 0.0;
+    }
+
+    size_t intervalIdx = 0;
+    if (m_isUniform)
+    {
+        // Calculate the interval directly and correct it if the rounding of the stored values puts the value in a neighbour.
+        intervalIdx = std::min((size_t)((value - first) / m_step), m_values.size() - 2);
+        if (intervalIdx > 0 && (m_ordering == Ordering::Ascending ? value < m_values[intervalIdx] : value > m_values[intervalIdx]))
+        {
+            --intervalIdx;
+        }
+        else if (intervalIdx + 2 < m_values.size() && (m_ordering == Ordering::Ascending ? value > m_values[intervalIdx + 1] : value < m_values[intervalIdx + 1]))
+        {
+            ++intervalIdx;
+        }
+    }
+    else if (m_ordering == Ordering::Ascending)
+    {
+        // The first interval whose upper end is not below the value.
+        intervalIdx = (size_t)(std::lower_bound(m_values.begin() + 1, m_values.end(), value, [](float element, double v) { return element < v; }) - m_values.begin()) - 1;
+    }
+    else
+    {
+        intervalIdx = (size_t)(std::lower_bound(m_values.begin() + 1, m_values.end(), value, [](float element, double v) { return element > v; }) - m_values.begin()) - 1;
+    }
+
+    return IndexInInterval(intervalIdx, value);
+}
+
+double CoordinateAxis::GetFractionalIndex(double value) const
+{
+    const double index = FindFractionalIndex(value);
+    if (index < 0.0)
+    {
+        throw std::invalid_argument("Cannot find the value in the provided coordinate axis.");
+    }
+    return index;
+}
+
+std::vector<double> CoordinateAxis::GetFractionalIndices(const std::vector<double>& values) const
+{
+    std::vector<double> indices(values.size());
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        const double index = FindFractionalIndex(values[ii]);
+        indices[ii] = (index < 0.0) ? std::numeric_limits<double>::quiet_NaN() : index;
+    }
+    return indices;
+}
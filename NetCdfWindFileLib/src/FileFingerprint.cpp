@@ -0,0 +1,49 @@
+#include "FileFingerprint.h"
+#include <netcdf.h>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// The number of bytes at the start of the input file which are included in the header hash.
+static const size_t FingerprintHeaderLength = 64 * 1024;
+
+uint64_t HashBytes(const char* data, size_t length, uint64_t hash)
+{
+    for (size_t ii = 0; ii < length; ++ii)
+    {
+        hash ^= (uint8_t)data[ii];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+FileFingerprint GetFileFingerprint(const std::string& filename)
+{
+    FileFingerprint fingerprint;
+
+#ifdef _WIN32
+    struct _stat64 fileStatus;
+    const int status = _stat64(filename.c_str(), &fileStatus);
+#else
+    struct stat fileStatus;
+    const int status = stat(filename.c_str(), &fileStatus);
+#endif
+    std::ifstream file(filename, std::ios::binary);
+    if (status != 0 || !file.is_open())
+    {
+        std::stringstream msg;
+        msg << "Failed to retrieve the fingerprint of the file with path: '" << filename << "'";
+        throw NetCdfException(msg.str().c_str(), NC_EIO);
+    }
+
+    fingerprint.fileSize = (uint64_t)fileStatus.st_size;
+    fingerprint.modificationTime = (int64_t)fileStatus.st_mtime;
+
+    std::vector<char> header(FingerprintHeaderLength);
+    file.read(header.data(), header.size());
+    fingerprint.headerHash = HashBytes(header.data(), (size_t)file.gcount());
+
+    return fingerprint;
+}
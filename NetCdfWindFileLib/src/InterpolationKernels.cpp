@@ -0,0 +1,200 @@
+#include <InterpolationKernels.h>
+#include <ScalingKernels.h>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define NETCDF_USE_SSE2
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+// Functions using AVX2 instructions must be marked as such for gcc and clang,
+//  MSVC allows the intrinsics to be used without any special flags.
+#if defined(__GNUC__)
+#define NETCDF_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NETCDF_TARGET_AVX2
+#endif
+
+static void TriLinearInterpolationScalar(const CornerBatch<3>& corners, size_t firstTimeStep, size_t numberOfTimeSteps, const CubePosition<3>& position, double* value, double* uncertainty)
+{
+    CornerValues<3> cube;
+    for (size_t timeIdx = firstTimeStep; timeIdx < numberOfTimeSteps; ++timeIdx)
+    {
+        for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+        {
+            cube[cornerIdx] = corners[cornerIdx][timeIdx];
+        }
+
+        const EstimatedValue result = MultiLinearInterpolation<3>(cube, position);
+        value[timeIdx] = result.value;
+        if (uncertainty != nullptr)
+        {
+            uncertainty[timeIdx] = result.uncertainty;
+        }
+    }
+}
+
+static void CalculateWindSpeedScalar(const CornerBatch<3>& u, const CornerBatch<3>& v, size_t firstTimeStep, size_t numberOfTimeSteps, CornerBatch<3>& speed)
+{
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        for (size_t timeIdx = firstTimeStep; timeIdx < numberOfTimeSteps; ++timeIdx)
+        {
+            const double uValue = u[cornerIdx][timeIdx];
+            const double vValue = v[cornerIdx][timeIdx];
+            speed[cornerIdx][timeIdx] = std::sqrt(uValue * uValue + vValue * vValue);
+        }
+    }
+}
+
+#ifdef NETCDF_USE_SSE2
+
+// Interpolates two time steps at a time, with the same operations in the same order as MultiLinearInterpolation.
+//  @return the number of time steps which were interpolated.
+static size_t TriLinearInterpolationSse2(const CornerBatch<3>& corners, size_t numberOfTimeSteps, const CubePosition<3>& position, double* value, double* uncertainty)
+{
+    const __m128d alphaZ = _mm_set1_pd(position[2]);
+    const __m128d betaZ = _mm_set1_pd(1.0 - position[2]);
+    const __m128d alphaY = _mm_set1_pd(position[1]);
+    const __m128d betaY = _mm_set1_pd(1.0 - position[1]);
+    const __m128d alphaX = _mm_set1_pd(position[0]);
+    const __m128d betaX = _mm_set1_pd(1.0 - position[0]);
+
+    size_t ii = 0;
+    for (; ii + 2 <= numberOfTimeSteps; ii += 2)
+    {
+        __m128d c[8];
+        for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+        {
+            c[cornerIdx] = _mm_loadu_pd(corners[cornerIdx].data() + ii);
+        }
+
+        const __m128d c00 = _mm_add_pd(_mm_mul_pd(c[0], betaZ), _mm_mul_pd(c[1], alphaZ));
+        const __m128d c01 = _mm_add_pd(_mm_mul_pd(c[2], betaZ), _mm_mul_pd(c[3], alphaZ));
+        const __m128d c10 = _mm_add_pd(_mm_mul_pd(c[4], betaZ), _mm_mul_pd(c[5], alphaZ));
+        const __m128d c11 = _mm_add_pd(_mm_mul_pd(c[6], betaZ), _mm_mul_pd(c[7], alphaZ));
+
+        const __m128d c0 = _mm_add_pd(_mm_mul_pd(c00, betaY), _mm_mul_pd(c01, alphaY));
+        const __m128d c1 = _mm_add_pd(_mm_mul_pd(c10, betaY), _mm_mul_pd(c11, alphaY));
+
+        _mm_storeu_pd(value + ii, _mm_add_pd(_mm_mul_pd(c0, betaX), _mm_mul_pd(c1, alphaX)));
+        if (uncertainty != nullptr)
+        {
+            _mm_storeu_pd(uncertainty + ii, _mm_sub_pd(c1, c0));
+        }
+    }
+
+    return ii;
+}
+
+NETCDF_TARGET_AVX2
+static size_t TriLinearInterpolationAvx2(const CornerBatch<3>& corners, size_t numberOfTimeSteps, const CubePosition<3>& position, double* value, double* uncertainty)
+{
+    const __m256d alphaZ = _mm256_set1_pd(position[2]);
+    const __m256d betaZ = _mm256_set1_pd(1.0 - position[2]);
+    const __m256d alphaY = _mm256_set1_pd(position[1]);
+    const __m256d betaY = _mm256_set1_pd(1.0 - position[1]);
+    const __m256d alphaX = _mm256_set1_pd(position[0]);
+    const __m256d betaX = _mm256_set1_pd(1.0 - position[0]);
+
+    size_t ii = 0;
+    for (; ii + 4 <= numberOfTimeSteps; ii += 4)
+    {
+        __m256d c[8];
+        for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+        {
+            c[cornerIdx] = _mm256_loadu_pd(corners[cornerIdx].data() + ii);
+        }
+
+        const __m256d c00 = _mm256_add_pd(_mm256_mul_pd(c[0], betaZ), _mm256_mul_pd(c[1], alphaZ));
+        const __m256d c01 = _mm256_add_pd(_mm256_mul_pd(c[2], betaZ), _mm256_mul_pd(c[3], alphaZ));
+        const __m256d c10 = _mm256_add_pd(_mm256_mul_pd(c[4], betaZ), _mm256_mul_pd(c[5], alphaZ));
+        const __m256d c11 = _mm256_add_pd(_mm256_mul_pd(c[6], betaZ), _mm256_mul_pd(c[7], alphaZ));
+
+        const __m256d c0 = _mm256_add_pd(_mm256_mul_pd(c00, betaY), _mm256_mul_pd(c01, alphaY));
+        const __m256d c1 = _mm256_add_pd(_mm256_mul_pd(c10, betaY), _mm256_mul_pd(c11, alphaY));
+
+        _mm256_storeu_pd(value + ii, _mm256_add_pd(_mm256_mul_pd(c0, betaX), _mm256_mul_pd(c1, alphaX)));
+        if (uncertainty != nullptr)
+        {
+            _mm256_storeu_pd(uncertainty + ii, _mm256_sub_pd(c1, c0));
+        }
+    }
+
+    return ii;
+}
+
+// Calculates the speed of two time steps at a time. _mm_sqrt_pd is correctly rounded, as is std::sqrt.
+//  @return the number of time steps which were calculated.
+static size_t CalculateWindSpeedSse2(const CornerBatch<3>& u, const CornerBatch<3>& v, size_t numberOfTimeSteps, CornerBatch<3>& speed)
+{
+    size_t ii = 0;
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        for (ii = 0; ii + 2 <= numberOfTimeSteps; ii += 2)
+        {
+            const __m128d uValues = _mm_loadu_pd(u[cornerIdx].data() + ii);
+            const __m128d vValues = _mm_loadu_pd(v[cornerIdx].data() + ii);
+            _mm_storeu_pd(speed[cornerIdx].data() + ii, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(uValues, uValues), _mm_mul_pd(vValues, vValues))));
+        }
+    }
+
+    return ii;
+}
+
+NETCDF_TARGET_AVX2
+static size_t CalculateWindSpeedAvx2(const CornerBatch<3>& u, const CornerBatch<3>& v, size_t numberOfTimeSteps, CornerBatch<3>& speed)
+{
+    size_t ii = 0;
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        for (ii = 0; ii + 4 <= numberOfTimeSteps; ii += 4)
+        {
+            const __m256d uValues = _mm256_loadu_pd(u[cornerIdx].data() + ii);
+            const __m256d vValues = _mm256_loadu_pd(v[cornerIdx].data() + ii);
+            _mm256_storeu_pd(speed[cornerIdx].data() + ii, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(uValues, uValues), _mm256_mul_pd(vValues, vValues))));
+        }
+    }
+
+    return ii;
+}
+
+#endif // NETCDF_USE_SSE2
+
+void TriLinearInterpolation(const CornerBatch<3>& corners, size_t numberOfTimeSteps, const CubePosition<3>& position, double* value, double* uncertainty)
+{
+    size_t firstScalarTimeStep = 0;
+
+#ifdef NETCDF_USE_SSE2
+    static const bool useAvx2 = CpuSupportsAvx2();
+    firstScalarTimeStep = useAvx2 ?
+        TriLinearInterpolationAvx2(corners, numberOfTimeSteps, position, value, uncertainty) :
+        TriLinearInterpolationSse2(corners, numberOfTimeSteps, position, value, uncertainty);
+#endif
+
+    TriLinearInterpolationScalar(corners, firstScalarTimeStep, numberOfTimeSteps, position, value, uncertainty);
+}
+
+void CalculateWindSpeedAndDirection(const CornerBatch<3>& u, const CornerBatch<3>& v, size_t numberOfTimeSteps, CornerBatch<3>& speed, CornerBatch<3>& direction)
+{
+    size_t firstScalarTimeStep = 0;
+
+#ifdef NETCDF_USE_SSE2
+    static const bool useAvx2 = CpuSupportsAvx2();
+    firstScalarTimeStep = useAvx2 ?
+        CalculateWindSpeedAvx2(u, v, numberOfTimeSteps, speed) :
+        CalculateWindSpeedSse2(u, v, numberOfTimeSteps, speed);
+#endif
+
+    CalculateWindSpeedScalar(u, v, firstScalarTimeStep, numberOfTimeSteps, speed);
+
+    // There is no vectorized atan2, the directions are calculated one at a time.
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        for (size_t timeIdx = 0; timeIdx < numberOfTimeSteps; ++timeIdx)
+        {
+            direction[cornerIdx][timeIdx] = 180.0 * std::atan2(-u[cornerIdx][timeIdx], -v[cornerIdx][timeIdx]) / 3.14159265358979323846;
+        }
+    }
+}
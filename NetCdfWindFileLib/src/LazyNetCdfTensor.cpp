@@ -0,0 +1,109 @@
+#include "LazyNetCdfTensor.h"
+#include "NetCdfFileReader.h"
+#include <netcdf.h>
+#include <algorithm>
+#include <sstream>
+
+LazyNetCdfTensor::LazyNetCdfTensor(std::shared_ptr<NetCdfFileReader*> reader, const std::string& variableName, const std::vector<size_t>& variableSize, const std::vector<size_t>& blockSize, size_t maximumNumberOfBlocks)
+    : size(variableSize), name(variableName), m_reader(std::move(reader)), m_blockSize(blockSize), m_maximumNumberOfBlocks(std::max(maximumNumberOfBlocks, (size_t)1))
+{
+    m_numberOfBlocks.resize(size.size());
+    for (size_t ii = 0; ii < size.size(); ++ii)
+    {
+        m_blockSize[ii] = std::max((size_t)1, std::min(m_blockSize[ii], size[ii]));
+        m_numberOfBlocks[ii] = (size[ii] + m_blockSize[ii] - 1) / m_blockSize[ii];
+    }
+}
+
+float LazyNetCdfTensor::operator[](size_t index) const
+{
+    size_t indexInBlock = 0;
+    const NetCdfTensor& block = GetBlock(index, indexInBlock);
+    return block.values[indexInBlock];
+}
+
+bool LazyNetCdfTensor::IsValid(size_t index) const
+{
+    size_t indexInBlock = 0;
+    const NetCdfTensor& block = GetBlock(index, indexInBlock);
+    return block.IsValid(indexInBlock);
+}
+
+void LazyNetCdfTensor::ClearCache()
+{
+    m_blocks.clear();
+    m_blockPositions.clear();
+}
+
+const NetCdfTensor& LazyNetCdfTensor::GetBlock(size_t index, size_t& indexInBlock) const
+{
+    // Split the flattened index into the index of the block and the index inside of the block,
+    //  starting with the last (fastest varying) dimension.
+    size_t blockIdx = 0;
+    size_t blockStride = 1;
+    size_t remainingIndex = index;
+    for (size_t ii = size.size(); ii-- > 0;)
+    {
+        const size_t coordinate = remainingIndex % size[ii];
+        remainingIndex /= size[ii];
+
+        blockIdx += (coordinate / m_blockSize[ii]) * blockStride;
+        blockStride *= m_numberOfBlocks[ii];
+    }
+
+    auto position = m_blockPositions.find(blockIdx);
+    if (position != m_blockPositions.end())
+    {
+        // move the block first in the list, as the most recently used
+        m_blocks.splice(m_blocks.begin(), m_blocks, position->second);
+    }
+    else
+    {
+        if (m_reader == nullptr || *m_reader == nullptr)
+        {
+            std::stringstream msg;
+            msg << "Failed to read a block of the variable '" << name << "' lazily. The reader it was created from has been closed.";
+            throw NetCdfException(msg.str().c_str(), NC_EBADID);
+        }
+
+        std::vector<size_t> start(size.size());
+        std::vector<size_t> count(size.size());
+        size_t remainingBlockIdx = blockIdx;
+        for (size_t ii = size.size(); ii-- > 0;)
+        {
+            start[ii] = (remainingBlockIdx % m_numberOfBlocks[ii]) * m_blockSize[ii];
+            count[ii] = std::min(m_blockSize[ii], size[ii] - start[ii]);
+            remainingBlockIdx /= m_numberOfBlocks[ii];
+        }
+
+        // Reuse the memory of the least recently used block, if the cache is full.
+        NetCdfTensor block;
+        if (m_blocks.size() >= m_maximumNumberOfBlocks)
+        {
+            block = std::move(m_blocks.back().second);
+            m_blockPositions.erase(m_blocks.back().first);
+            m_blocks.pop_back();
+        }
+
+        (*m_reader)->ReadSlab(name, start, count, block);
+
+        m_blocks.emplace_front(blockIdx, std::move(block));
+        m_blockPositions[blockIdx] = m_blocks.begin();
+    }
+
+    // The index inside of the block
+    const NetCdfTensor& block = m_blocks.front().second;
+    indexInBlock = 0;
+    size_t stride = 1;
+    remainingIndex = index;
+    for (size_t ii = size.size(); ii-- > 0;)
+    {
+        const size_t coordinate = remainingIndex % size[ii];
+        remainingIndex /= size[ii];
+
+        indexInBlock += (coordinate % m_blockSize[ii]) * stride;
+        stride *= block.size[ii];
+    }
+
+    return block;
+}
@@ -0,0 +1,633 @@
+#include "MappedNetCdfFile.h"
+#include "NetCdfTypes.h"
+#include <MathUtils.h>
+#include <netcdf.h>
+#include <sstream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The tags which starts the lists in the header of a classic net cdf file.
+static const uint32_t NetCdfDimensionTag = 0x0A;
+static const uint32_t NetCdfVariableTag = 0x0B;
+static const uint32_t NetCdfAttributeTag = 0x0C;
+
+// All values in classic net cdf files are stored in big-endian order.
+static uint16_t ReadBigEndian16(const unsigned char* data)
+{
+    return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+static uint32_t ReadBigEndian32(const unsigned char* data)
+{
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+}
+
+static uint64_t ReadBigEndian64(const unsigned char* data)
+{
+    return ((uint64_t)ReadBigEndian32(data) << 32) | (uint64_t)ReadBigEndian32(data + 4);
+}
+
+// Multiplies two sizes read from the header, a corrupt header must not make this silently overflow.
+static uint64_t CheckedMultiply(uint64_t a, uint64_t b)
+{
+    if (a != 0 && b > ~(uint64_t)0 / a)
+    {
+        throw NetCdfException("Failed to parse the header of the net-cdf file, the size of a variable or attribute is too large.", NC_ENOTNC);
+    }
+    return a * b;
+}
+
+static double DecodeValue(const unsigned char* data, int type)
+{
+    switch (type)
+    {
+    case NC_BYTE: return (double)(signed char)data[0];
+    case NC_CHAR: return (double)data[0];
+    case NC_SHORT: return (double)(int16_t)ReadBigEndian16(data);
+    case NC_INT: return (double)(int32_t)ReadBigEndian32(data);
+    case NC_FLOAT:
+    {
+        uint32_t bits = ReadBigEndian32(data);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return (double)value;
+    }
+    case NC_DOUBLE:
+    {
+        uint64_t bits = ReadBigEndian64(data);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    case NC_UBYTE: return (double)data[0];
+    case NC_USHORT: return (double)ReadBigEndian16(data);
+    case NC_UINT: return (double)ReadBigEndian32(data);
+    case NC_INT64: return (double)(int64_t)ReadBigEndian64(data);
+    case NC_UINT64: return (double)ReadBigEndian64(data);
+    default: return 0.0;
+    }
+}
+
+double MappedNetCdfVariable::ValueAt(size_t index) const
+{
+    const unsigned char* valueData;
+    if (m_recordSize > 0)
+    {
+        const size_t record = index / m_valuesPerRecord;
+        const size_t indexInRecord = index - record * m_valuesPerRecord;
+        valueData = m_data + record * m_recordSize + indexInRecord * m_elementSize;
+    }
+    else
+    {
+        valueData = m_data + index * m_elementSize;
+    }
+
+    return DecodeValue(valueData, m_type) * scaling.scaleFactor + scaling.offset;
+}
+
+// Helper for reading the header of a classic net cdf file, with checks that the header is not truncated.
+class HeaderParser
+{
+public:
+    HeaderParser(const unsigned char* data, size_t size, int formatVersion)
+        : m_position(data), m_end(data + size), m_formatVersion(formatVersion)
+    {
+    }
+
+    uint32_t ReadInt32()
+    {
+        Require(4);
+        uint32_t value = ReadBigEndian32(m_position);
+        m_position += 4;
+        return value;
+    }
+
+    // Reads a non-negative value (number of elements, length), these are 64 bits in CDF-5 files.
+    uint64_t ReadNonNegative()
+    {
+        if (m_formatVersion == 5)
+        {
+            Require(8);
+            uint64_t value = ReadBigEndian64(m_position);
+            m_position += 8;
+            return value;
+        }
+        return ReadInt32();
+    }
+
+    // Reads the offset of a variable, these are 64 bits in all but the classic format.
+    uint64_t ReadOffset()
+    {
+        if (m_formatVersion == 1)
+        {
+            return ReadInt32();
+        }
+        Require(8);
+        uint64_t value = ReadBigEndian64(m_position);
+        m_position += 8;
+        return value;
+    }
+
+    std::string ReadName()
+    {
+        const uint64_t length = ReadNonNegative();
+        Require(PaddedLength(length));
+        std::string name((const char*)m_position, (size_t)length);
+        Skip(PaddedLength(length));
+        return name;
+    }
+
+    // Reads the number of elements in a list where each element occupies at least minimumElementSize bytes.
+    //  A count which cannot fit in the remainder of the header is rejected before anything is allocated for it.
+    size_t ReadCount(size_t minimumElementSize)
+    {
+        const uint64_t count = ReadNonNegative();
+        if (count > Remaining() / minimumElementSize)
+        {
+            throw NetCdfException("Failed to parse the header of the net-cdf file, the header is truncated.", NC_ENOTNC);
+        }
+        return (size_t)count;
+    }
+
+    const unsigned char* Position() const { return m_position; }
+
+    // @return the number of bytes from the current position to the end of the file.
+    size_t Remaining() const { return (size_t)(m_end - m_position); }
+
+    void Skip(uint64_t numberOfBytes)
+    {
+        Require(numberOfBytes);
+        m_position += (size_t)numberOfBytes;
+    }
+
+    // All blocks in the header are padded to a multiple of four bytes.
+    //  Values which cannot be padded without overflowing are kept as they are, these are rejected by Require.
+    static uint64_t PaddedLength(uint64_t length)
+    {
+        return (length > ~(uint64_t)0 - 3) ? length : (length + 3) & ~(uint64_t)3;
+    }
+
+private:
+    const unsigned char* m_position;
+    const unsigned char* m_end;
+    const int m_formatVersion;
+
+    void Require(uint64_t numberOfBytes)
+    {
+        if ((uint64_t)Remaining() < numberOfBytes)
+        {
+            throw NetCdfException("Failed to parse the header of the net-cdf file, the header is truncated.", NC_ENOTNC);
+        }
+    }
+};
+
+MappedNetCdfFile::MappedNetCdfFile()
+{
+}
+
+MappedNetCdfFile::~MappedNetCdfFile()
+{
+    Close();
+}
+
+bool MappedNetCdfFile::IsClassicFormatFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    char signature[4];
+    if (!file.read(signature, 4))
+    {
+        return false;
+    }
+
+    return signature[0] == 'C' && signature[1] == 'D' && signature[2] == 'F' &&
+        (signature[3] == 1 || signature[3] == 2 || signature[3] == 5);
+}
+
+void MappedNetCdfFile::Open(const std::string& filename)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        std::stringstream msg;
+        msg << "Failed to open net-cdf file with path: '" << filename << "'";
+        throw NetCdfException(msg.str().c_str(), NC_EIO);
+    }
+    m_fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    m_fileSize = (size_t)fileSize.QuadPart;
+
+    if (m_fileSize > 0)
+    {
+        m_mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mappingHandle != nullptr)
+        {
+            m_fileData = (const unsigned char*)MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        }
+    }
+#else
+    int file = open(filename.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        std::stringstream msg;
+        msg << "Failed to open net-cdf file with path: '" << filename << "'";
+        throw NetCdfException(msg.str().c_str(), NC_EIO);
+    }
+
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0)
+    {
+        m_fileSize = (size_t)fileStatus.st_size;
+        void* mapping = mmap(nullptr, m_fileSize, PROT_READ, MAP_SHARED, file, 0);
+        if (mapping != MAP_FAILED)
+        {
+            m_fileData = (const unsigned char*)mapping;
+        }
+    }
+
+    // the mapping remains valid after the file descriptor is closed.
+    close(file);
+#endif
+
+    if (m_fileData == nullptr)
+    {
+        Close();
+        std::stringstream msg;
+        msg << "Failed to memory map net-cdf file with path: '" << filename << "'";
+        throw NetCdfException(msg.str().c_str(), NC_EIO);
+    }
+
+    try
+    {
+        ParseHeader();
+    }
+    catch (NetCdfException&)
+    {
+        Close();
+        throw;
+    }
+}
+
+void MappedNetCdfFile::Close()
+{
+#ifdef _WIN32
+    if (m_fileData != nullptr)
+    {
+        UnmapViewOfFile(m_fileData);
+    }
+    if (m_mappingHandle != nullptr)
+    {
+        CloseHandle(m_mappingHandle);
+        m_mappingHandle = nullptr;
+    }
+    if (m_fileHandle != nullptr)
+    {
+        CloseHandle(m_fileHandle);
+        m_fileHandle = nullptr;
+    }
+#else
+    if (m_fileData != nullptr)
+    {
+        munmap((void*)m_fileData, m_fileSize);
+    }
+#endif
+
+    m_fileData = nullptr;
+    m_fileSize = 0;
+    m_formatVersion = 0;
+    m_numberOfRecords = 0;
+    m_recordSize = 0;
+    m_dimensions.clear();
+    m_variables.clear();
+}
+
+void MappedNetCdfFile::ParseHeader()
+{
+    if (m_fileSize < 4 || m_fileData[0] != 'C' || m_fileData[1] != 'D' || m_fileData[2] != 'F')
+    {
+        throw NetCdfException("Failed to parse the header of the net-cdf file, the file is not a classic format net-cdf file.", NC_ENOTNC);
+    }
+
+    m_formatVersion = m_fileData[3];
+    if (m_formatVersion != 1 && m_formatVersion != 2 && m_formatVersion != 5)
+    {
+        throw NetCdfException("Failed to parse the header of the net-cdf file, unknown format version.", NC_ENOTNC);
+    }
+
+    HeaderParser header(m_fileData, m_fileSize, m_formatVersion);
+    header.Skip(4);
+
+    // The smallest possible size of one element in each of the lists of the header, used to reject impossible counts.
+    const size_t sizeOfNonNegative = (m_formatVersion == 5) ? 8 : 4;
+    const size_t minimumDimensionSize = 2 * sizeOfNonNegative; // name length and dimension length
+    const size_t minimumAttributeSize = 2 * sizeOfNonNegative + 4; // name length, type and number of values
+    const size_t minimumVariableSize = 4 * sizeOfNonNegative + 8 + ((m_formatVersion == 1) ? 4 : 8); // name length, number of dimensions, attribute list, type, vsize and begin
+
+    const uint64_t numberOfRecords = header.ReadNonNegative();
+    const bool isStreaming = (m_formatVersion == 5) ? (numberOfRecords == ~(uint64_t)0) : (numberOfRecords == 0xFFFFFFFF);
+
+    // The dimensions
+    {
+        uint32_t tag = header.ReadInt32();
+        size_t numberOfDimensions = header.ReadCount(minimumDimensionSize);
+        if (tag != NetCdfDimensionTag && (tag != 0 || numberOfDimensions != 0))
+        {
+            throw NetCdfException("Failed to parse the header of the net-cdf file, invalid list of dimensions.", NC_ENOTNC);
+        }
+
+        m_dimensions.resize(numberOfDimensions);
+        for (Dimension& dimension : m_dimensions)
+        {
+            dimension.name = header.ReadName();
+            dimension.length = (size_t)header.ReadNonNegative();
+        }
+    }
+
+    // Reads a list of attributes, the global attributes are not used.
+    auto readAttributes = [&](std::vector<Attribute>& attributes)
+    {
+        uint32_t tag = header.ReadInt32();
+        size_t numberOfAttributes = header.ReadCount(minimumAttributeSize);
+        if (tag != NetCdfAttributeTag && (tag != 0 || numberOfAttributes != 0))
+        {
+            throw NetCdfException("Failed to parse the header of the net-cdf file, invalid list of attributes.", NC_ENOTNC);
+        }
+
+        attributes.resize(numberOfAttributes);
+        for (Attribute& attribute : attributes)
+        {
+            attribute.name = header.ReadName();
+            attribute.type = (int)header.ReadInt32();
+            if (SizeOfType(attribute.type) == 0)
+            {
+                std::stringstream msg;
+                msg << "Failed to parse the header of the net-cdf file, unknown type of attribute '" << attribute.name << "'.";
+                throw NetCdfException(msg.str().c_str(), NC_EBADTYPE);
+            }
+            const uint64_t numberOfValues = header.ReadNonNegative();
+            const uint64_t sizeOfValues = CheckedMultiply(numberOfValues, SizeOfType(attribute.type));
+            attribute.data = header.Position();
+            header.Skip(HeaderParser::PaddedLength(sizeOfValues));
+            attribute.numberOfValues = (size_t)numberOfValues;
+        }
+    };
+
+    std::vector<Attribute> globalAttributes;
+    readAttributes(globalAttributes);
+
+    // The variables
+    {
+        uint32_t tag = header.ReadInt32();
+        size_t numberOfVariables = header.ReadCount(minimumVariableSize);
+        if (tag != NetCdfVariableTag && (tag != 0 || numberOfVariables != 0))
+        {
+            throw NetCdfException("Failed to parse the header of the net-cdf file, invalid list of variables.", NC_ENOTNC);
+        }
+
+        m_variables.resize(numberOfVariables);
+        for (Variable& variable : m_variables)
+        {
+            variable.name = header.ReadName();
+
+            size_t numberOfDimensions = header.ReadCount(sizeOfNonNegative);
+            variable.dimensionIndices.resize(numberOfDimensions);
+            for (size_t& dimensionIdx : variable.dimensionIndices)
+            {
+                dimensionIdx = (size_t)header.ReadNonNegative();
+                if (dimensionIdx >= m_dimensions.size())
+                {
+                    throw NetCdfException("Failed to parse the header of the net-cdf file, invalid dimension of variable.", NC_ENOTNC);
+                }
+            }
+
+            readAttributes(variable.attributes);
+
+            variable.type = (int)header.ReadInt32();
+            if (SizeOfType(variable.type) == 0)
+            {
+                throw NetCdfException("Failed to parse the header of the net-cdf file, unknown type of variable.", NC_EBADTYPE);
+            }
+
+            header.ReadNonNegative(); // vsize, this is calculated below instead since it overflows for large variables.
+            variable.begin = header.ReadOffset();
+
+            // the unlimited dimension is stored with the length zero
+            variable.isRecordVariable = variable.dimensionIndices.size() > 0 && m_dimensions[variable.dimensionIndices[0]].length == 0;
+
+            // the size of the variable (one record of a record variable) must fit in the file, this also guarantees
+            //  that the multiplications in ValuesPerRecord and in the reading of the values cannot overflow.
+            uint64_t sizeOfVariable = SizeOfType(variable.type);
+            for (size_t ii = variable.isRecordVariable ? 1 : 0; ii < variable.dimensionIndices.size(); ++ii)
+            {
+                sizeOfVariable = CheckedMultiply(sizeOfVariable, m_dimensions[variable.dimensionIndices[ii]].length);
+            }
+            if (variable.begin > m_fileSize || sizeOfVariable > m_fileSize - variable.begin)
+            {
+                std::stringstream msg;
+                msg << "Failed to parse the header of the net-cdf file, the variable '" << variable.name << "' extends beyond the end of the file.";
+                throw NetCdfException(msg.str().c_str(), NC_ENOTNC);
+            }
+        }
+    }
+
+    // Calculate the size of one record. If there is only one record variable then there is no padding.
+    //  Each term is at most the size of the file (checked above), hence the sum cannot overflow.
+    size_t numberOfRecordVariables = 0;
+    uint64_t firstRecordBegin = 0;
+    m_recordSize = 0;
+    for (const Variable& variable : m_variables)
+    {
+        if (variable.isRecordVariable)
+        {
+            m_recordSize += (size_t)HeaderParser::PaddedLength(ValuesPerRecord(variable) * SizeOfType(variable.type));
+            firstRecordBegin = (numberOfRecordVariables == 0) ? variable.begin : std::min(firstRecordBegin, variable.begin);
+            ++numberOfRecordVariables;
+        }
+    }
+    if (numberOfRecordVariables == 1)
+    {
+        for (const Variable& variable : m_variables)
+        {
+            if (variable.isRecordVariable)
+            {
+                m_recordSize = ValuesPerRecord(variable) * SizeOfType(variable.type);
+            }
+        }
+    }
+
+    if (isStreaming)
+    {
+        m_numberOfRecords = (m_recordSize > 0 && m_fileSize > firstRecordBegin) ? (size_t)((m_fileSize - firstRecordBegin) / m_recordSize) : 0;
+    }
+    else
+    {
+        m_numberOfRecords = (size_t)numberOfRecords;
+    }
+
+    // Verify that all variables are inside of the file
+    for (const Variable& variable : m_variables)
+    {
+        uint64_t endOfVariable = variable.begin;
+        if (!variable.isRecordVariable)
+        {
+            endOfVariable += ValuesPerRecord(variable) * SizeOfType(variable.type);
+        }
+        else if (m_numberOfRecords > 0)
+        {
+            const uint64_t sizeOfRecords = CheckedMultiply(m_numberOfRecords - 1, m_recordSize);
+            endOfVariable = (sizeOfRecords > m_fileSize) ? sizeOfRecords : endOfVariable + sizeOfRecords + ValuesPerRecord(variable) * SizeOfType(variable.type);
+        }
+
+        if (endOfVariable > m_fileSize)
+        {
+            std::stringstream msg;
+            msg << "Failed to parse the header of the net-cdf file, the variable '" << variable.name << "' extends beyond the end of the file.";
+            throw NetCdfException(msg.str().c_str(), NC_ENOTNC);
+        }
+    }
+}
+
+size_t MappedNetCdfFile::ValuesPerRecord(const Variable& variable) const
+{
+    size_t numberOfValues = 1;
+    for (size_t ii = variable.isRecordVariable ? 1 : 0; ii < variable.dimensionIndices.size(); ++ii)
+    {
+        numberOfValues *= m_dimensions[variable.dimensionIndices[ii]].length;
+    }
+    return numberOfValues;
+}
+
+const MappedNetCdfFile::Variable& MappedNetCdfFile::FindVariable(const std::string& variableName) const
+{
+    for (const Variable& variable : m_variables)
+    {
+        if (variable.name == variableName)
+        {
+            return variable;
+        }
+    }
+
+    std::stringstream msg;
+    msg << "Failed to retrieve the index of variable '" << variableName << "'.";
+    throw NetCdfException(msg.str().c_str(), NC_ENOTVAR);
+}
+
+bool MappedNetCdfFile::ContainsVariable(const std::string& variableName) const
+{
+    for (const Variable& variable : m_variables)
+    {
+        if (variable.name == variableName)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::map<std::string, size_t> MappedNetCdfFile::GetDimensionLengths() const
+{
+    std::map<std::string, size_t> lengths;
+    for (const Dimension& dimension : m_dimensions)
+    {
+        lengths[dimension.name] = (dimension.length == 0) ? m_numberOfRecords : dimension.length;
+    }
+    return lengths;
+}
+
+std::string MappedNetCdfFile::GetTextAttribute(const std::string& variableName, const std::string& attributeName) const
+{
+    const Variable& variable = FindVariable(variableName);
+
+    for (const Attribute& attribute : variable.attributes)
+    {
+        if (attribute.name == attributeName && attribute.type == NC_CHAR)
+        {
+            // the text may be padded with null characters
+            std::string text((const char*)attribute.data, attribute.numberOfValues);
+            return text.substr(0, text.find('\0'));
+        }
+    }
+
+    std::stringstream msg;
+    msg << "Failed to find the text attribute '" << attributeName << "' of variable '" << variableName << "'.";
+    throw NetCdfException(msg.str().c_str(), NC_ENOTATT);
+}
+
+std::vector<size_t> MappedNetCdfFile::GetSizeOfVariable(const std::string& variableName) const
+{
+    const Variable& variable = FindVariable(variableName);
+
+    std::vector<size_t> sizes(variable.dimensionIndices.size());
+    for (size_t ii = 0; ii < variable.dimensionIndices.size(); ++ii)
+    {
+        sizes[ii] = m_dimensions[variable.dimensionIndices[ii]].length;
+    }
+
+    if (variable.isRecordVariable)
+    {
+        sizes[0] = m_numberOfRecords;
+    }
+
+    return sizes;
+}
+
+MappedNetCdfVariable MappedNetCdfFile::GetVariable(const std::string& variableName) const
+{
+    const Variable& variable = FindVariable(variableName);
+
+    MappedNetCdfVariable result;
+    result.name = variable.name;
+    result.size = GetSizeOfVariable(variableName);
+
+    result.dimensions.resize(variable.dimensionIndices.size());
+    for (size_t ii = 0; ii < variable.dimensionIndices.size(); ++ii)
+    {
+        result.dimensions[ii].index = (int)variable.dimensionIndices[ii];
+        result.dimensions[ii].name = m_dimensions[variable.dimensionIndices[ii]].name;
+    }
+
+    for (const Attribute& attribute : variable.attributes)
+    {
+        if (attribute.numberOfValues == 0 || attribute.type == NC_CHAR)
+        {
+            continue;
+        }
+        if (attribute.name == "scale_factor")
+        {
+            result.scaling.scaleFactor = DecodeValue(attribute.data, attribute.type);
+        }
+        else if (attribute.name == "add_offset")
+        {
+            result.scaling.offset = DecodeValue(attribute.data, attribute.type);
+        }
+    }
+
+    result.m_data = m_fileData + variable.begin;
+    result.m_type = variable.type;
+    result.m_elementSize = SizeOfType(variable.type);
+    result.m_numberOfElements = ProductOfElements(result.size);
+
+    if (variable.isRecordVariable)
+    {
+        result.m_recordSize = m_recordSize;
+        result.m_valuesPerRecord = ValuesPerRecord(variable);
+    }
+
+    return result;
+}
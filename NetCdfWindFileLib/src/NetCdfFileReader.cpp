@@ -1,7 +1,17 @@
 #include "NetCdfFileReader.h"
+#include "NetCdfTypes.h"
 #include <MathUtils.h>
+#include <ScalingKernels.h>
+#include <MappedNetCdfFile.h>
 #include <netcdf.h>
 #include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// The maximum number of packed values which are read from file at once, before these are decoded.
+static const size_t MaximumNumberOfPackedValuesInMemory = 1 << 24;
 
 NetCdfFileReader::NetCdfFileReader()
 {
@@ -13,30 +23,378 @@ NetCdfFileReader::~NetCdfFileReader()
     Close();
 }
 
-void NetCdfFileReader::Open(const std::string& filename)
+std::mutex& NetCdfLibraryMutex()
+{
+    static std::mutex netCdfLibraryMutex;
+    return netCdfLibraryMutex;
+}
+
+NetCdfFileReader::NetCdfFileReader(NetCdfFileReader&& other) noexcept
+    : m_netCdfFileHandle(other.m_netCdfFileHandle),
+    m_fileContents(std::move(other.m_fileContents)),
+    m_lazyTensorHandle(std::move(other.m_lazyTensorHandle)),
+    m_dimensions(std::move(other.m_dimensions)),
+    m_variables(std::move(other.m_variables)),
+    m_variableIndices(std::move(other.m_variableIndices)),
+    m_packedValueBuffer(std::move(other.m_packedValueBuffer))
+{
+    other.m_netCdfFileHandle = 0;
+    if (m_lazyTensorHandle != nullptr)
+    {
+        *m_lazyTensorHandle = this;
+    }
+}
+
+NetCdfFileReader& NetCdfFileReader::operator=(NetCdfFileReader&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+
+        m_netCdfFileHandle = other.m_netCdfFileHandle;
+        m_dimensions = std::move(other.m_dimensions);
+        m_variables = std::move(other.m_variables);
+        m_variableIndices = std::move(other.m_variableIndices);
+        m_fileContents = std::move(other.m_fileContents);
+        m_packedValueBuffer = std::move(other.m_packedValueBuffer);
+        m_lazyTensorHandle = std::move(other.m_lazyTensorHandle);
+        if (m_lazyTensorHandle != nullptr)
+        {
+            *m_lazyTensorHandle = this;
+        }
+
+        other.m_netCdfFileHandle = 0;
+    }
+    return *this;
+}
+
+uint64_t GetSizeOfFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    return file.is_open() ? (uint64_t)file.tellg() : 0;
+}
+
+// The CF conventions define valid_range, valid_min and valid_max in the units of the packed (stored) values
+//  when the attribute has the type of the variable and otherwise, e.g. float limits of a packed short variable,
+//  in the units of the unpacked values. The limits in unpacked units are here converted to packed units,
+//  such that all limits can be compared with the stored values.
+static void ConvertValidRangeToPackedUnits(int variableType, int validMinimumType, int validMaximumType, const LinearScaling& scaling, MissingValues& missingValues)
+{
+    if (scaling.scaleFactor == 0.0)
+    {
+        return;
+    }
+
+    const bool minimumIsUnpacked = validMinimumType != NC_NAT && validMinimumType != variableType;
+    const bool maximumIsUnpacked = validMaximumType != NC_NAT && validMaximumType != variableType;
+    if (!minimumIsUnpacked && !maximumIsUnpacked)
+    {
+        return;
+    }
+
+    double minimum = missingValues.validMinimum;
+    double maximum = missingValues.validMaximum;
+    if (minimumIsUnpacked)
+    {
+        minimum = (minimum - scaling.offset) / scaling.scaleFactor;
+    }
+    if (maximumIsUnpacked)
+    {
+        maximum = (maximum - scaling.offset) / scaling.scaleFactor;
+    }
+
+    // A negative scale factor reverses the order of the unpacked limits.
+    if (scaling.scaleFactor < 0.0)
+    {
+        if (minimumIsUnpacked && maximumIsUnpacked)
+        {
+            std::swap(minimum, maximum);
+        }
+        else if (minimumIsUnpacked)
+        {
+            maximum = std::min(maximum, minimum);
+            minimum = -std::numeric_limits<double>::infinity();
+        }
+        else
+        {
+            minimum = std::max(minimum, maximum);
+            maximum = std::numeric_limits<double>::infinity();
+        }
+    }
+
+    missingValues.validMinimum = minimum;
+    missingValues.validMaximum = maximum;
+}
+
+NetCdfOpenMode SelectOpenMode(uint64_t fileSize, bool isClassicFormat, NetCdfAccessPattern accessPattern, uint64_t maximumDisklessSize)
+{
+    if (fileSize <= maximumDisklessSize)
+    {
+        return NetCdfOpenMode::Diskless;
+    }
+    if (isClassicFormat && accessPattern == NetCdfAccessPattern::TimeSeriesAtPoint)
+    {
+        return NetCdfOpenMode::MemoryMapped;
+    }
+    return NetCdfOpenMode::Normal;
+}
+
+void NetCdfFileReader::Open(const std::string& filename, NetCdfOpenMode mode, NetCdfAccessPattern accessPattern)
 {
     if (m_netCdfFileHandle != 0)
     {
         Close();
     }
 
-    int status = nc_open(filename.c_str(), NC_NOWRITE, &m_netCdfFileHandle);
+    if (mode == NetCdfOpenMode::Automatic)
+    {
+        mode = SelectOpenMode(GetSizeOfFile(filename), MappedNetCdfFile::IsClassicFormatFile(filename), accessPattern, DefaultMaximumDisklessSize);
+    }
+
+    int openFlags = NC_NOWRITE;
+    switch (mode)
+    {
+    case NetCdfOpenMode::Diskless: openFlags |= NC_DISKLESS; break;
+    case NetCdfOpenMode::MemoryMapped: openFlags |= NC_DISKLESS | NC_MMAP; break;
+    default: break;
+    }
+
+    std::lock_guard<std::mutex> lock(NetCdfLibraryMutex());
+
+    int status = nc_open(filename.c_str(), openFlags, &m_netCdfFileHandle);
+
+    if (status != NC_NOERR && mode == NetCdfOpenMode::MemoryMapped)
+    {
+        // The library may be built without support for mmap (this is always the case on Windows), read the file normally instead.
+        status = nc_open(filename.c_str(), NC_NOWRITE, &m_netCdfFileHandle);
+    }
 
     if (status != NC_NOERR)
     {
+        m_netCdfFileHandle = 0;
+
         std::stringstream msg;
         msg << "Failed to open net-cdf file with path: '" << filename << "' Error code returned was: " << status;
         throw NetCdfException(msg.str().c_str(), status);
     }
+
+    ReadCatalogueOrClose();
+}
+
+void NetCdfFileReader::OpenFromMemory(std::vector<char> contents, const std::string& name)
+{
+    if (m_netCdfFileHandle != 0)
+    {
+        Close();
+    }
+
+    m_fileContents = std::move(contents);
+
+    std::lock_guard<std::mutex> lock(NetCdfLibraryMutex());
+
+    int status = nc_open_mem(name.c_str(), NC_NOWRITE, m_fileContents.size(), m_fileContents.data(), &m_netCdfFileHandle);
+
+    if (status != NC_NOERR)
+    {
+        m_netCdfFileHandle = 0;
+        m_fileContents.clear();
+
+        std::stringstream msg;
+        msg << "Failed to open net-cdf file '" << name << "' from memory. Error code returned was: " << status;
+        throw NetCdfException(msg.str().c_str(), status);
+    }
+
+    ReadCatalogueOrClose();
+}
+
+void NetCdfFileReader::ReadCatalogueOrClose()
+{
+    try
+    {
+        ReadCatalogue();
+    }
+    catch (NetCdfException&)
+    {
+        nc_close(m_netCdfFileHandle);
+        m_netCdfFileHandle = 0;
+        m_fileContents.clear();
+        m_dimensions.clear();
+        m_variables.clear();
+        m_variableIndices.clear();
+        throw;
+    }
 }
 
 void NetCdfFileReader::Close()
 {
+    DetachLazyTensors();
+
     if (m_netCdfFileHandle != 0)
     {
+        std::lock_guard<std::mutex> lock(NetCdfLibraryMutex());
         nc_close(m_netCdfFileHandle);
         m_netCdfFileHandle = 0;
     }
+
+    m_fileContents.clear();
+    m_fileContents.shrink_to_fit();
+    m_dimensions.clear();
+    m_variables.clear();
+    m_variableIndices.clear();
+}
+
+void NetCdfFileReader::DetachLazyTensors()
+{
+    if (m_lazyTensorHandle != nullptr)
+    {
+        *m_lazyTensorHandle = nullptr;
+        m_lazyTensorHandle.reset();
+    }
+}
+
+void NetCdfFileReader::ReadCatalogue()
+{
+    int nofDimensions = 0;
+    int nofVariables = 0;
+    int status = nc_inq(m_netCdfFileHandle, &nofDimensions, &nofVariables, nullptr, nullptr);
+    if (status != NC_NOERR)
+    {
+        std::stringstream msg;
+        msg << "Failed to retrieve the contents of the net-cdf file. Error code returned was: " << status;
+        throw NetCdfException(msg.str().c_str(), status);
+    }
+
+    std::vector<char> name(NC_MAX_NAME + 1);
+
+    m_dimensions.resize(nofDimensions);
+    for (int dimensionIdx = 0; dimensionIdx < nofDimensions; ++dimensionIdx)
+    {
+        status = nc_inq_dim(m_netCdfFileHandle, dimensionIdx, name.data(), &m_dimensions[dimensionIdx].length);
+        if (status != NC_NOERR)
+        {
+            std::stringstream msg;
+            msg << "Failed to retrieve dimension '" << dimensionIdx << "'. Error code returned was: " << status;
+            throw NetCdfException(msg.str().c_str(), status);
+        }
+        m_dimensions[dimensionIdx].name = std::string(name.data());
+    }
+
+    m_variables.resize(nofVariables);
+    for (int variableIdx = 0; variableIdx < nofVariables; ++variableIdx)
+    {
+        VariableInformation& variable = m_variables[variableIdx];
+
+        nc_type type = 0;
+        int nofVariableDimensions = 0;
+        int nofAttributes = 0;
+        status = nc_inq_var(m_netCdfFileHandle, variableIdx, name.data(), &type, &nofVariableDimensions, nullptr, &nofAttributes);
+        if (status != NC_NOERR)
+        {
+            std::stringstream msg;
+            msg << "Failed to retrieve variable '" << variableIdx << "'. Error code returned was: " << status;
+            throw NetCdfException(msg.str().c_str(), status);
+        }
+
+        variable.name = std::string(name.data());
+        variable.type = type;
+
+        variable.dimensionIndices.resize(nofVariableDimensions);
+        status = nc_inq_vardimid(m_netCdfFileHandle, variableIdx, variable.dimensionIndices.data());
+        if (status != NC_NOERR)
+        {
+            std::stringstream msg;
+            msg << "Failed to retrieve the dimension indices of variable '" << variable.name << "'. Error code returned was: " << status;
+            throw NetCdfException(msg.str().c_str(), status);
+        }
+
+        // The types of the attributes defining the valid range, see ConvertValidRangeToPackedUnits.
+        int validMinimumType = NC_NAT;
+        int validMaximumType = NC_NAT;
+
+        variable.attributes.resize(nofAttributes);
+        for (int attributeIdx = 0; attributeIdx < nofAttributes; ++attributeIdx)
+        {
+            AttributeInformation& attribute = variable.attributes[attributeIdx];
+            nc_type attributeType = 0;
+            size_t numberOfValues = 0;
+            if (NC_NOERR != nc_inq_attname(m_netCdfFileHandle, variableIdx, attributeIdx, name.data()) ||
+                NC_NOERR != nc_inq_att(m_netCdfFileHandle, variableIdx, name.data(), &attributeType, &numberOfValues))
+            {
+                continue;
+            }
+
+            attribute.name = std::string(name.data());
+            attribute.type = attributeType;
+
+            if (attributeType == NC_CHAR)
+            {
+                std::vector<char> text(numberOfValues + 1, 0);
+                if (NC_NOERR == nc_get_att_text(m_netCdfFileHandle, variableIdx, name.data(), text.data()))
+                {
+                    attribute.text = std::string(text.data());
+                }
+            }
+            else if (attributeType != NC_STRING && numberOfValues > 0)
+            {
+                attribute.values.resize(numberOfValues);
+                if (NC_NOERR != nc_get_att_double(m_netCdfFileHandle, variableIdx, name.data(), attribute.values.data()))
+                {
+                    attribute.values.clear();
+                }
+            }
+
+            if (attribute.name == "scale_factor" && attribute.values.size() > 0)
+            {
+                variable.scaling.scaleFactor = attribute.values[0];
+                variable.hasLinearScaling = true;
+            }
+            else if (attribute.name == "add_offset" && attribute.values.size() > 0)
+            {
+                variable.scaling.offset = attribute.values[0];
+                variable.hasLinearScaling = true;
+            }
+            else if ((attribute.name == "_FillValue" || attribute.name == "missing_value") && attribute.values.size() > 0)
+            {
+                variable.missingValues.invalidValues.insert(end(variable.missingValues.invalidValues), begin(attribute.values), end(attribute.values));
+            }
+            else if (attribute.name == "valid_range" && attribute.values.size() == 2)
+            {
+                variable.missingValues.validMinimum = attribute.values[0];
+                variable.missingValues.validMaximum = attribute.values[1];
+                validMinimumType = attribute.type;
+                validMaximumType = attribute.type;
+            }
+            else if (attribute.name == "valid_min" && attribute.values.size() > 0)
+            {
+                variable.missingValues.validMinimum = attribute.values[0];
+                validMinimumType = attribute.type;
+            }
+            else if (attribute.name == "valid_max" && attribute.values.size() > 0)
+            {
+                variable.missingValues.validMaximum = attribute.values[0];
+                validMaximumType = attribute.type;
+            }
+        }
+
+        if (variable.hasLinearScaling)
+        {
+            ConvertValidRangeToPackedUnits(variable.type, validMinimumType, validMaximumType, variable.scaling, variable.missingValues);
+        }
+
+        m_variableIndices[variable.name] = variableIdx;
+    }
+}
+
+const NetCdfFileReader::VariableInformation& NetCdfFileReader::GetVariableInformation(int variableIdx) const
+{
+    if (variableIdx < 0 || variableIdx >= (int)m_variables.size())
+    {
+        std::stringstream msg;
+        msg << "Failed to retrieve variable '" << variableIdx << "', there is no such variable in the file.";
+        throw NetCdfException(msg.str().c_str(), NC_ENOTVAR);
+    }
+
+    return m_variables[variableIdx];
 }
 
 static std::string FormatType(nc_type type)
@@ -56,6 +414,8 @@ static std::string FormatType(nc_type type)
 
 void NetCdfFileReader::PrintFileInformation()
 {
+    std::lock_guard<std::mutex> lock(NetCdfLibraryMutex());
+
     // Inquire the file about groups
     int nofDimensions = 0;
     int nofVariables = 0;
@@ -145,130 +505,281 @@ void NetCdfFileReader::PrintFileInformation()
 
 std::vector<int> NetCdfFileReader::GetDimensionIndicesOfVariable(int variableIdx)
 {
-    int nofDimensions = 0;
-    int status = nc_inq_varndims(m_netCdfFileHandle, variableIdx, &nofDimensions);
-    if (status != NC_NOERR)
-    {
-        std::stringstream msg;
-        msg << "Failed to retrieve the number of dimensions of variable '" << variableIdx << "'. Error code returned was: " << status;
-        throw NetCdfException(msg.str().c_str(), status);
-    }
+    return GetVariableInformation(variableIdx).dimensionIndices;
+}
 
-    std::vector<int> dimensions(nofDimensions);
-    status = nc_inq_vardimid(m_netCdfFileHandle, variableIdx, dimensions.data());
-    if (status != NC_NOERR)
+std::vector<NetCdfDimension> NetCdfFileReader::GetDimensionsOfVariable(int variableIdx)
+{
+    const VariableInformation& variable = GetVariableInformation(variableIdx);
+
+    std::vector<NetCdfDimension> dimensions(variable.dimensionIndices.size());
+    for (size_t ii = 0; ii < variable.dimensionIndices.size(); ++ii)
     {
-        std::stringstream msg;
-        msg << "Failed to retrieve the dimension indices of variable '" << variableIdx << "'. Error code returned was: " << status;
-        throw NetCdfException(msg.str().c_str(), status);
+        dimensions[ii].index = variable.dimensionIndices[ii];
+        dimensions[ii].name = m_dimensions[variable.dimensionIndices[ii]].name;
     }
 
     return dimensions;
 }
 
+std::vector<NetCdfDimension> NetCdfFileReader::GetDimensionsOfVariable(const std::string& variableName)
+{
+    return GetDimensionsOfVariable(GetIndexOfVariable(variableName));
+}
+
 int NetCdfFileReader::GetIndexOfVariable(const std::string& variableName)
 {
-    int index = 0;
-    int status = nc_inq_varid(m_netCdfFileHandle, variableName.c_str(), &index);
+    auto variable = m_variableIndices.find(variableName);
 
-    if (status != NC_NOERR)
+    if (variable == m_variableIndices.end())
     {
         std::stringstream msg;
-        msg << "Failed to retrieve the index of variable '" << variableName << "'. Error code returned was: " << status;
-        throw NetCdfException(msg.str().c_str(), status);
+        msg << "Failed to retrieve the index of variable '" << variableName << "'. Error code returned was: " << NC_ENOTVAR;
+        throw NetCdfException(msg.str().c_str(), NC_ENOTVAR);
     }
 
-    return index;
+    return variable->second;
 }
 
 NetCdfTensor NetCdfFileReader::ReadVariable(const std::string& variableName)
 {
     NetCdfTensor result;
+    ReadVariable(variableName, result);
+    return result;
+}
+
+void NetCdfFileReader::ReadVariable(const std::string& variableName, NetCdfTensor& result)
+{
+    // retrieves the variable index, this throws an exception if the variable cannot be found.
+    int variableIndex = GetIndexOfVariable(variableName);
+
+    std::vector<size_t> variableSize = this->GetSizeOfVariable(variableIndex);
+    std::vector<size_t> start(variableSize.size(), 0);
+
+    ReadSlab(variableName, start, variableSize, result);
+}
+
+NetCdfTensor NetCdfFileReader::ReadSlab(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count)
+{
+    NetCdfTensor result;
+    ReadSlab(variableName, start, count, result);
+    return result;
+}
 
+void NetCdfFileReader::ReadSlab(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count, NetCdfTensor& result)
+{
     // retrieves the variable index, this throws an exception if the variable cannot be found.
     int variableIndex = GetIndexOfVariable(variableName);
 
-    result.size = this->GetSizeOfVariable(variableIndex);
+    // the slab is verified before the memory for it is allocated.
+    VerifySlabIsInsideOfVariable(variableIndex, start, count);
 
-    {
-        std::vector<char> name;
-        name.resize(NC_MAX_NAME + 1);
-        auto dimensionIndices = this->GetDimensionIndicesOfVariable(variableIndex);
-        result.dimensions.resize(dimensionIndices.size());
-        for (size_t ii = 0; ii < dimensionIndices.size(); ++ii)
-        {
-            result.dimensions[ii].index = dimensionIndices[ii];
+    result.size = count;
 
-            if (NC_NOERR == nc_inq_dimname(this->m_netCdfFileHandle, dimensionIndices[ii], name.data()))
-            {
-                result.dimensions[ii].name = std::string(name.data());
-            }
-        }
-    }
+    result.dimensions = this->GetDimensionsOfVariable(variableIndex);
 
-    LinearScaling variableScaling;
-    if (GetLinearScalingForVariable(variableIndex, variableScaling))
-    {
-        result.values = this->ReadVariableAsFloat(variableIndex, variableScaling);
-    }
-    else
-    {
-        result.values = this->ReadVariableAsFloat(variableIndex);
-    }
+    // resizing keeps the memory already allocated by the tensor, if this is large enough.
+    result.values.resize(ProductOfElements(count));
+
+    const VariableInformation& variable = GetVariableInformation(variableIndex);
+    this->ReadSlabIntoBuffer(variableIndex, start, count, variable.scaling, variable.missingValues, result.values.data(), result.validity);
 
     result.name = variableName;
+}
 
-    return result;
+PackedNetCdfTensor NetCdfFileReader::ReadVariablePacked(const std::string& variableName)
+{
+    int variableIndex = GetIndexOfVariable(variableName);
+
+    std::vector<size_t> variableSize = this->GetSizeOfVariable(variableIndex);
+    std::vector<size_t> start(variableSize.size(), 0);
+
+    return ReadSlabPacked(variableName, start, variableSize);
 }
 
-bool NetCdfFileReader::ContainsVariable(const std::string& variableName)
+PackedNetCdfTensor NetCdfFileReader::ReadSlabPacked(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count)
 {
-    int index = 0;
-    int status = nc_inq_varid(m_netCdfFileHandle, variableName.c_str(), &index);
+    PackedNetCdfTensor result;
 
-    if (status == NC_NOERR)
+    int variableIndex = GetIndexOfVariable(variableName);
+
+    if (GetVariableInformation(variableIndex).type != NC_SHORT)
     {
-        return true;
+        std::stringstream msg;
+        msg << "Failed to read the packed values of variable '" << variableName << "', the variable is not stored as short.";
+        throw NetCdfException(msg.str().c_str(), NC_EBADTYPE);
     }
-    else if (status == NC_ENOTVAR)
+
+    VerifySlabIsInsideOfVariable(variableIndex, start, count);
+
+    result.size = count;
+    result.dimensions = this->GetDimensionsOfVariable(variableIndex);
+    GetLinearScalingForVariable(variableIndex, result.scaling);
+    result.missingValues = GetVariableInformation(variableIndex).missingValues;
+    result.name = variableName;
+
+    result.packedValues.resize(ProductOfElements(count));
+    int status = NC_NOERR;
     {
-        return false;
+        std::lock_guard<std::mutex> lock(NetCdfLibraryMutex());
+        status = nc_get_vara_short(m_netCdfFileHandle, variableIndex, start.data(), count.data(), result.packedValues.data());
     }
-    else
+    if (status != NC_NOERR)
     {
         std::stringstream msg;
-        msg << "Failed to retrieve variable '" << variableName << "'. Error code returned was: " << status;
+        msg << "Failed to retrieve the values of variable '" << variableName << "'. Error code returned was: " << status;
         throw NetCdfException(msg.str().c_str(), status);
     }
+
+    return result;
 }
 
-std::vector<size_t> NetCdfFileReader::GetSizeOfVariable(int variableIdx)
+NetCdfTensor NetCdfFileReader::ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, std::vector<double>& localIndices, bool longitudeWrapsAround)
 {
-    auto dimensionIndices = GetDimensionIndicesOfVariable(variableIdx);
+    int variableIndex = GetIndexOfVariable(variableName);
+
+    std::vector<size_t> variableSize = this->GetSizeOfVariable(variableIndex);
 
-    std::vector<size_t> sizes(dimensionIndices.size());
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    GetNeighbourhoodSlab(variableName, variableSize, spatialIndices, start, count, localIndices, longitudeWrapsAround);
 
-    for (size_t ii = 0; ii < dimensionIndices.size(); ++ii)
+    return ReadNeighbourhoodSlab(variableSize, start, count, [&](const std::vector<size_t>& slabStart, const std::vector<size_t>& slabCount)
     {
-        size_t value = 0;
-        int status = nc_inq_dimlen(m_netCdfFileHandle, dimensionIndices[ii], &value);
+        return ReadSlab(variableName, slabStart, slabCount);
+    });
+}
 
-        if (status != NC_NOERR)
-        {
-            std::stringstream msg;
-            msg << "Failed to retrieve the dimensions of variable '" << variableIdx << "'. Error code returned was: " << status;
-            throw NetCdfException(msg.str().c_str(), status);
-        }
+NetCdfTensor NetCdfFileReader::ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, const TimeRange& timeRange, std::vector<double>& localIndices, bool longitudeWrapsAround)
+{
+    int variableIndex = GetIndexOfVariable(variableName);
 
-        sizes[ii] = value;
-    }
+    std::vector<size_t> variableSize = this->GetSizeOfVariable(variableIndex);
 
-    return sizes;
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    GetNeighbourhoodSlab(variableName, variableSize, spatialIndices, timeRange, start, count, localIndices, longitudeWrapsAround);
+
+    return ReadNeighbourhoodSlab(variableSize, start, count, [&](const std::vector<size_t>& slabStart, const std::vector<size_t>& slabCount)
+    {
+        return ReadSlab(variableName, slabStart, slabCount);
+    });
 }
 
-std::vector<size_t> NetCdfFileReader::GetSizeOfVariable(const std::string& variableName)
+TimeCoordinate NetCdfFileReader::ReadTimeCoordinate(const std::string& variableName)
 {
-    int index = GetIndexOfVariable(variableName);
+    const TimeUnits units = ParseTimeUnits(GetTextAttribute(variableName, "units"));
+
+    // Read as double, integer hours or seconds since a distant reference cannot be represented exactly as float.
+    TypedNetCdfTensor<double> time = ReadVariable<double>(variableName);
+    std::vector<double> values(time.values.size());
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        values[ii] = time[ii];
+    }
+
+    return TimeCoordinate(std::move(values), units);
+}
+
+NetCdfTimeBlockReader NetCdfFileReader::ReadVariableInTimeBlocks(const std::string& variableName, size_t maximumBytesPerBlock)
+{
+    int variableIndex = GetIndexOfVariable(variableName);
+
+    std::vector<size_t> variableSize = this->GetSizeOfVariable(variableIndex);
+    if (variableSize.size() == 0)
+    {
+        std::stringstream msg;
+        msg << "Failed to read variable '" << variableName << "' in blocks. The variable has no dimensions.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+    }
+
+    std::vector<size_t> sizeOfOneTimeStep(variableSize.begin() + 1, variableSize.end());
+    const size_t bytesPerTimeStep = sizeof(float) * ProductOfElements(sizeOfOneTimeStep);
+
+    size_t timeStepsPerBlock = (bytesPerTimeStep > 0) ? maximumBytesPerBlock / bytesPerTimeStep : variableSize[0];
+    timeStepsPerBlock = std::max(timeStepsPerBlock, (size_t)1);
+
+    return NetCdfTimeBlockReader(*this, variableName, variableSize, timeStepsPerBlock);
+}
+
+LazyNetCdfTensor NetCdfFileReader::ReadVariableLazy(const std::string& variableName, size_t maximumBytesInMemory)
+{
+    const int variableIndex = GetIndexOfVariable(variableName);
+
+    // Follow the chunks of the file, such that each block is read from as few chunks as possible.
+    std::vector<size_t> blockSize = GetChunkingOfVariable(variableName);
+    if (blockSize.size() == 0)
+    {
+        blockSize.resize(GetVariableInformation(variableIndex).dimensionIndices.size(), 8);
+        if (blockSize.size() > 0)
+        {
+            blockSize[0] = DefaultLazyBlockLength;
+        }
+    }
+
+    return ReadVariableLazy(variableName, blockSize, maximumBytesInMemory);
+}
+
+LazyNetCdfTensor NetCdfFileReader::ReadVariableLazy(const std::string& variableName, const std::vector<size_t>& blockSize, size_t maximumBytesInMemory)
+{
+    const int variableIndex = GetIndexOfVariable(variableName);
+
+    std::vector<size_t> variableSize = this->GetSizeOfVariable(variableIndex);
+    if (variableSize.size() == 0)
+    {
+        std::stringstream msg;
+        msg << "Failed to read variable '" << variableName << "' lazily. The variable has no dimensions.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+    }
+    if (blockSize.size() != variableSize.size())
+    {
+        std::stringstream msg;
+        msg << "Failed to read variable '" << variableName << "' lazily. The block size has " << blockSize.size();
+        msg << " dimensions but the variable has " << variableSize.size() << " dimensions.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+    }
+
+    // Each block holds its values and, if any value is missing, one bit of validity per value.
+    size_t valuesPerBlock = 1;
+    for (size_t ii = 0; ii < blockSize.size(); ++ii)
+    {
+        valuesPerBlock *= std::max((size_t)1, std::min(blockSize[ii], variableSize[ii]));
+    }
+    const size_t bytesPerBlock = valuesPerBlock * sizeof(float) + (valuesPerBlock + 7) / 8;
+    const size_t maximumNumberOfBlocks = maximumBytesInMemory / bytesPerBlock;
+
+    if (m_lazyTensorHandle == nullptr)
+    {
+        m_lazyTensorHandle = std::make_shared<NetCdfFileReader*>(this);
+    }
+
+    LazyNetCdfTensor result(m_lazyTensorHandle, variableName, variableSize, blockSize, maximumNumberOfBlocks);
+    result.dimensions = this->GetDimensionsOfVariable(variableIndex);
+    return result;
+}
+
+bool NetCdfFileReader::ContainsVariable(const std::string& variableName)
+{
+    return m_variableIndices.find(variableName) != m_variableIndices.end();
+}
+
+std::vector<size_t> NetCdfFileReader::GetSizeOfVariable(int variableIdx)
+{
+    const VariableInformation& variable = GetVariableInformation(variableIdx);
+
+    std::vector<size_t> sizes(variable.dimensionIndices.size());
+
+    for (size_t ii = 0; ii < variable.dimensionIndices.size(); ++ii)
+    {
+        sizes[ii] = m_dimensions[variable.dimensionIndices[ii]].length;
+    }
+
+    return sizes;
+}
+
+std::vector<size_t> NetCdfFileReader::GetSizeOfVariable(const std::string& variableName)
+{
+    int index = GetIndexOfVariable(variableName);
 
     return GetSizeOfVariable(index);
 }
@@ -276,32 +787,220 @@ std::vector<size_t> NetCdfFileReader::GetSizeOfVariable(const std::string& varia
 std::vector<float> NetCdfFileReader::ReadVariableAsFloat(int variableIdx)
 {
     std::vector<size_t> variableSize = GetSizeOfVariable(variableIdx);
+    std::vector<size_t> start(variableSize.size(), 0);
+
+    return ReadSlabAsFloat(variableIdx, start, variableSize);
+}
+
+std::vector<float> NetCdfFileReader::ReadVariableAsFloat(int variableIdx, const LinearScaling& scaling)
+{
+    std::vector<size_t> variableSize = GetSizeOfVariable(variableIdx);
+    std::vector<size_t> start(variableSize.size(), 0);
+
+    return ReadSlabAsFloat(variableIdx, start, variableSize, scaling);
+}
+
+void NetCdfFileReader::VerifySlabIsInsideOfVariable(const std::string& variableName, const std::vector<size_t>& variableSize, const std::vector<size_t>& start, const std::vector<size_t>& count)
+{
+    if (start.size() != variableSize.size() || count.size() != variableSize.size())
+    {
+        std::stringstream msg;
+        msg << "Failed to read a slab of variable '" << variableName << "'. The variable has " << variableSize.size() << " dimensions but the slab has " << start.size() << ".";
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+    }
+
+    for (size_t ii = 0; ii < variableSize.size(); ++ii)
+    {
+        if (start[ii] > variableSize[ii])
+        {
+            std::stringstream msg;
+            msg << "Failed to read a slab of variable '" << variableName << "'. The start index " << start[ii] << " in dimension " << ii << " is outside of the variable.";
+            throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+        }
+        if (count[ii] > variableSize[ii] - start[ii])
+        {
+            std::stringstream msg;
+            msg << "Failed to read a slab of variable '" << variableName << "'. The slab extends outside of the variable in dimension " << ii << ".";
+            throw NetCdfException(msg.str().c_str(), NC_EEDGE);
+        }
+    }
+}
+
+void NetCdfFileReader::VerifySlabIsInsideOfVariable(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count)
+{
+    VerifySlabIsInsideOfVariable(GetVariableInformation(variableIdx).name, GetSizeOfVariable(variableIdx), start, count);
+}
+
+std::vector<float> NetCdfFileReader::ReadSlabAsFloat(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count)
+{
+    VerifySlabIsInsideOfVariable(variableIdx, start, count);
+
+    std::vector<float> values(ProductOfElements(count));
+
+    ReadSlabIntoBuffer(variableIdx, start, count, values.data());
+
+    return values;
+}
+
+std::vector<float> NetCdfFileReader::ReadSlabAsFloat(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, const LinearScaling& scaling)
+{
+    VerifySlabIsInsideOfVariable(variableIdx, start, count);
 
-    size_t totalNumberOfElements = ProductOfElements(variableSize);
+    std::vector<float> values(ProductOfElements(count));
+    std::vector<uint8_t> validity;
 
-    std::vector<float> values(totalNumberOfElements);
+    ReadSlabIntoBuffer(variableIdx, start, count, scaling, MissingValues(), values.data(), validity);
+
+    return values;
+}
 
-    int status = nc_get_var_float(m_netCdfFileHandle, variableIdx, values.data());
+// Reads a hyperslab of one variable using the nc_get_vara function for the type T,
+//  the netcdf library converts the values from the type in the file.
+template<class T>
+static void ReadSlabUsing(
+    int (*getValues)(int, int, const size_t*, const size_t*, T*),
+    int fileHandle,
+    int variableIdx,
+    const std::vector<size_t>& start,
+    const std::vector<size_t>& count,
+    T* destination)
+{
+    int status = NC_NOERR;
+    {
+        std::lock_guard<std::mutex> lock(NetCdfLibraryMutex());
+        status = getValues(fileHandle, variableIdx, start.data(), count.data(), destination);
+    }
     if (status != NC_NOERR)
     {
         std::stringstream msg;
         msg << "Failed to retrieve the values of variable '" << variableIdx << "'. Error code returned was: " << status;
         throw NetCdfException(msg.str().c_str(), status);
     }
+}
 
-    return values;
+void NetCdfFileReader::ReadSlabIntoBuffer(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, float* destination)
+{
+    VerifySlabIsInsideOfVariable(variableIdx, start, count);
+    ReadSlabUsing(nc_get_vara_float, m_netCdfFileHandle, variableIdx, start, count, destination);
 }
 
-std::vector<float> NetCdfFileReader::ReadVariableAsFloat(int variableIdx, const LinearScaling& scaling)
+void NetCdfFileReader::ReadSlabIntoBuffer(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, double* destination)
 {
-    std::vector<float> values = ReadVariableAsFloat(variableIdx);
+    VerifySlabIsInsideOfVariable(variableIdx, start, count);
+    ReadSlabUsing(nc_get_vara_double, m_netCdfFileHandle, variableIdx, start, count, destination);
+}
 
-    for (size_t ii = 0; ii < values.size(); ++ii)
+void NetCdfFileReader::ReadSlabIntoBuffer(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, int* destination)
+{
+    VerifySlabIsInsideOfVariable(variableIdx, start, count);
+    ReadSlabUsing(nc_get_vara_int, m_netCdfFileHandle, variableIdx, start, count, destination);
+}
+
+void NetCdfFileReader::ReadSlabIntoBuffer(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, short* destination)
+{
+    VerifySlabIsInsideOfVariable(variableIdx, start, count);
+    ReadSlabUsing(nc_get_vara_short, m_netCdfFileHandle, variableIdx, start, count, destination);
+}
+
+void NetCdfFileReader::ReadSlabIntoBuffer(int variableIdx, const std::vector<size_t>& start, const std::vector<size_t>& count, const LinearScaling& scaling, const MissingValues& missingValues, float* destination, std::vector<uint8_t>& validity)
+{
+    // the slab is verified before the buffers below are sized from it.
+    VerifySlabIsInsideOfVariable(variableIdx, start, count);
+
+    const bool maskMissingValues = !missingValues.IsEmpty();
+    const size_t numberOfValues = ProductOfElements(count);
+
+    validity.clear();
+    if (maskMissingValues)
     {
-        values[ii] = values[ii] * scaling.scaleFactor + scaling.offset;
+        validity.resize((numberOfValues + 7) / 8);
     }
 
-    return values;
+    const int type = GetVariableInformation(variableIdx).type;
+    if (maskMissingValues && type != NC_SHORT && type != NC_FLOAT)
+    {
+        // The missing values must be found on the values in their native type, before they are rounded to float.
+        //  Doubles represent all values of the classic integer types exactly.
+        std::vector<double> nativeValues(numberOfValues);
+        ReadSlabIntoBuffer(variableIdx, start, count, nativeValues.data());
+        ApplyLinearScaling(nativeValues.data(), numberOfValues, scaling, missingValues, destination, validity.data());
+        return;
+    }
+
+    if (type != NC_SHORT || count.size() == 0)
+    {
+        ReadSlabIntoBuffer(variableIdx, start, count, destination);
+
+        if (maskMissingValues)
+        {
+            ApplyLinearScaling(destination, numberOfValues, scaling, missingValues, validity.data());
+        }
+        else if (scaling.scaleFactor != 1.0 || scaling.offset != 0.0)
+        {
+            ApplyLinearScaling(destination, numberOfValues, scaling);
+        }
+
+        return;
+    }
+
+    // Packed values are read in their native type and converted and scaled in one pass.
+    //  This is done in parts along the first dimension, such that only a limited amount of
+    //  packed values needs to be kept in memory at the same time.
+    if (numberOfValues == 0)
+    {
+        return;
+    }
+
+    const size_t valuesPerRow = numberOfValues / count[0];
+    const size_t rowsPerPart = std::max(MaximumNumberOfPackedValuesInMemory / valuesPerRow, (size_t)1);
+
+    // The buffer for the packed values is kept between the calls, to avoid allocating it again.
+    m_packedValueBuffer.resize(std::min(rowsPerPart, count[0]) * valuesPerRow);
+    std::vector<size_t> partStart = start;
+    std::vector<size_t> partCount = count;
+
+    for (size_t row = 0; row < count[0]; row += rowsPerPart)
+    {
+        partStart[0] = start[0] + row;
+        partCount[0] = std::min(rowsPerPart, count[0] - row);
+
+        // The lock is released while the values are decoded, such that other readers can continue.
+        int status = NC_NOERR;
+        {
+            std::lock_guard<std::mutex> lock(NetCdfLibraryMutex());
+            status = nc_get_vara_short(m_netCdfFileHandle, variableIdx, partStart.data(), partCount.data(), m_packedValueBuffer.data());
+        }
+        if (status != NC_NOERR)
+        {
+            std::stringstream msg;
+            msg << "Failed to retrieve the values of variable '" << variableIdx << "'. Error code returned was: " << status;
+            throw NetCdfException(msg.str().c_str(), status);
+        }
+
+        if (maskMissingValues)
+        {
+            DecodePackedValues(m_packedValueBuffer.data(), partCount[0] * valuesPerRow, scaling, missingValues, destination + row * valuesPerRow, validity.data(), row * valuesPerRow);
+        }
+        else
+        {
+            DecodePackedValues(m_packedValueBuffer.data(), partCount[0] * valuesPerRow, scaling, destination + row * valuesPerRow);
+        }
+    }
+}
+
+std::vector<float> NetCdfFileReader::ReadSlabAsFloat(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count)
+{
+    int index = GetIndexOfVariable(variableName);
+
+    LinearScaling variableScaling;
+    if (GetLinearScalingForVariable(index, variableScaling))
+    {
+        return ReadSlabAsFloat(index, start, count, variableScaling);
+    }
+    else
+    {
+        return ReadSlabAsFloat(index, start, count);
+    }
 }
 
 std::vector<float> NetCdfFileReader::ReadVariableAsFloat(const std::string& variableName)
@@ -326,40 +1025,374 @@ std::vector<float> NetCdfFileReader::ReadVariableAsFloat(const std::string& vari
     return ReadVariableAsFloat(index, scaling);
 }
 
+void NetCdfFileReader::ReadSlabAsFloat(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count, float* destination, size_t destinationSize, std::vector<uint8_t>& validity)
+{
+    int index = GetIndexOfVariable(variableName);
+
+    if (destinationSize < ProductOfElements(count))
+    {
+        std::stringstream msg;
+        msg << "Failed to read variable '" << variableName << "', the buffer has room for " << destinationSize << " values but " << ProductOfElements(count) << " are required.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVAL);
+    }
+
+    const VariableInformation& variable = GetVariableInformation(index);
+    ReadSlabIntoBuffer(index, start, count, variable.scaling, variable.missingValues, destination, validity);
+}
+
+void NetCdfFileReader::ReadVariableAsFloat(const std::string& variableName, float* destination, size_t destinationSize, std::vector<uint8_t>& validity)
+{
+    std::vector<size_t> variableSize = GetSizeOfVariable(variableName);
+    std::vector<size_t> start(variableSize.size(), 0);
+
+    ReadSlabAsFloat(variableName, start, variableSize, destination, destinationSize, validity);
+}
+
+std::map<std::string, size_t> NetCdfFileReader::GetDimensionLengths() const
+{
+    std::map<std::string, size_t> lengths;
+    for (const DimensionInformation& dimension : m_dimensions)
+    {
+        lengths[dimension.name] = dimension.length;
+    }
+    return lengths;
+}
+
+std::string NetCdfFileReader::GetTextAttribute(const std::string& variableName, const std::string& attributeName)
+{
+    const VariableInformation& variable = GetVariableInformation(GetIndexOfVariable(variableName));
+
+    for (const AttributeInformation& attribute : variable.attributes)
+    {
+        if (attribute.name == attributeName && attribute.type == NC_CHAR)
+        {
+            return attribute.text;
+        }
+    }
+
+    std::stringstream msg;
+    msg << "Failed to find the text attribute '" << attributeName << "' of variable '" << variableName << "'.";
+    throw NetCdfException(msg.str().c_str(), NC_ENOTATT);
+}
+
 int NetCdfFileReader::GetNumberOfAttributesForVariable(int variableIdx)
 {
-    int numberOfAttributes = 0;
-    int error = nc_inq_natts(this->m_netCdfFileHandle, &numberOfAttributes);
+    if (variableIdx < 0 || variableIdx >= (int)m_variables.size())
+    {
+        return -1;
+    }
+
+    return (int)m_variables[variableIdx].attributes.size();
+}
+
+bool NetCdfFileReader::GetLinearScalingForVariable(int variableIdx, LinearScaling& scaling)
+{
+    if (variableIdx < 0 || variableIdx >= (int)m_variables.size() || !m_variables[variableIdx].hasLinearScaling)
+    {
+        return false;
+    }
+
+    scaling = m_variables[variableIdx].scaling;
+    return true;
+}
+
+// @return the smallest prime number which is not less than value.
+static size_t NextPrime(size_t value)
+{
+    for (;; ++value)
+    {
+        bool isPrime = value >= 2;
+        for (size_t divisor = 2; isPrime && divisor * divisor <= value; ++divisor)
+        {
+            isPrime = (value % divisor) != 0;
+        }
+        if (isPrime)
+        {
+            return value;
+        }
+    }
+}
+
+ChunkCacheSettings CalculateChunkCacheSettings(
+    const std::vector<size_t>& variableSize,
+    const std::vector<size_t>& chunkSize,
+    size_t elementSize,
+    NetCdfAccessPattern accessPattern,
+    size_t maximumSizeInBytes)
+{
+    ChunkCacheSettings settings;
+    if (variableSize.size() == 0 || chunkSize.size() != variableSize.size())
+    {
+        return settings;
+    }
+
+    size_t bytesPerChunk = elementSize;
+    std::vector<size_t> numberOfChunks(variableSize.size());
+    for (size_t ii = 0; ii < variableSize.size(); ++ii)
+    {
+        const size_t length = std::max(chunkSize[ii], (size_t)1);
+        bytesPerChunk *= length;
+        numberOfChunks[ii] = std::max((variableSize[ii] + length - 1) / length, (size_t)1);
+    }
+
+    // The number of chunks which must be kept in the cache such that no chunk is decompressed twice.
+    size_t chunksInCache = 1;
+    switch (accessPattern)
+    {
+    case NetCdfAccessPattern::WholeField:
+        // The variable is read in parts along the first dimension, the chunks which
+        //  straddle two parts must be kept until the next part is read.
+        //  Each chunk is completely read once the next part has been read.
+        for (size_t ii = 1; ii < numberOfChunks.size(); ++ii)
+        {
+            chunksInCache *= numberOfChunks[ii];
+        }
+        settings.preemption = 1.0F;
+        break;
+
+    case NetCdfAccessPattern::TimeSlab:
+        // The same as WholeField, but one block may touch two rows of chunks along time.
+        chunksInCache = std::min(numberOfChunks[0], (size_t)2);
+        for (size_t ii = 1; ii < numberOfChunks.size(); ++ii)
+        {
+            chunksInCache *= numberOfChunks[ii];
+        }
+        settings.preemption = 0.75F;
+        break;
+
+    case NetCdfAccessPattern::TimeSeriesAtPoint:
+        // The neighbourhood of a point spans at most two chunks in each spatial dimension,
+        //  but all the chunks along time. These are only partially read, and are kept for the next point.
+        chunksInCache = numberOfChunks[0];
+        for (size_t ii = 1; ii < numberOfChunks.size(); ++ii)
+        {
+            chunksInCache *= std::min(numberOfChunks[ii], (size_t)2);
+        }
+        settings.preemption = 0.0F;
+        break;
+    }
+
+    settings.sizeInBytes = std::min(chunksInCache * bytesPerChunk, maximumSizeInBytes);
+
+    // The hash table should have a prime number of slots, about 100 times the number of chunks in the cache.
+    const size_t chunksWhichFit = std::max(settings.sizeInBytes / bytesPerChunk, (size_t)1);
+    settings.numberOfSlots = NextPrime(std::max(100 * chunksWhichFit, (size_t)1009));
+
+    return settings;
+}
+
+std::vector<size_t> NetCdfFileReader::GetChunkingOfVariable(const std::string& variableName)
+{
+    const int variableIdx = GetIndexOfVariable(variableName);
+    std::vector<size_t> chunkSize(GetVariableInformation(variableIdx).dimensionIndices.size());
+
+    int storage = NC_CONTIGUOUS;
+    int status = NC_NOERR;
+    {
+        std::lock_guard<std::mutex> lock(NetCdfLibraryMutex());
+        status = nc_inq_var_chunking(m_netCdfFileHandle, variableIdx, &storage, chunkSize.data());
+    }
+
+    // Files in the classic formats are never chunked.
+    if (status == NC_ENOTNC4 || (status == NC_NOERR && storage != NC_CHUNKED))
+    {
+        return std::vector<size_t>();
+    }
+    else if (status != NC_NOERR)
+    {
+        std::stringstream msg;
+        msg << "Failed to retrieve the chunking of variable '" << variableName << "'. Error code returned was: " << status;
+        throw NetCdfException(msg.str().c_str(), status);
+    }
+
+    return chunkSize;
+}
+
+void NetCdfFileReader::SetChunkCache(const std::string& variableName, const ChunkCacheSettings& settings)
+{
+    const int variableIdx = GetIndexOfVariable(variableName);
+
+    int status = NC_NOERR;
+    {
+        std::lock_guard<std::mutex> lock(NetCdfLibraryMutex());
+        status = nc_set_var_chunk_cache(m_netCdfFileHandle, variableIdx, settings.sizeInBytes, settings.numberOfSlots, settings.preemption);
+    }
+
+    if (status != NC_NOERR)
+    {
+        std::stringstream msg;
+        msg << "Failed to set the chunk cache of variable '" << variableName << "'. Error code returned was: " << status;
+        throw NetCdfException(msg.str().c_str(), status);
+    }
+}
+
+ChunkCacheSettings NetCdfFileReader::GetChunkCache(const std::string& variableName)
+{
+    const int variableIdx = GetIndexOfVariable(variableName);
+
+    ChunkCacheSettings settings;
+    int status = NC_NOERR;
+    {
+        std::lock_guard<std::mutex> lock(NetCdfLibraryMutex());
+        status = nc_get_var_chunk_cache(m_netCdfFileHandle, variableIdx, &settings.sizeInBytes, &settings.numberOfSlots, &settings.preemption);
+    }
+
+    if (status != NC_NOERR)
+    {
+        std::stringstream msg;
+        msg << "Failed to retrieve the chunk cache of variable '" << variableName << "'. Error code returned was: " << status;
+        throw NetCdfException(msg.str().c_str(), status);
+    }
 
-    if (error == NC_NOERR)
+    return settings;
+}
+
+void NetCdfFileReader::TuneChunkCache(const std::string& variableName, NetCdfAccessPattern accessPattern, size_t maximumSizeInBytes)
+{
+    std::vector<size_t> chunkSize = GetChunkingOfVariable(variableName);
+    if (chunkSize.size() == 0)
     {
-        return numberOfAttributes;
+        return;
     }
-    return -1;
+
+    // Strings and user defined types are sized as eight bytes per value.
+    const int variableIdx = GetIndexOfVariable(variableName);
+    const size_t sizeOfType = SizeOfType(GetVariableInformation(variableIdx).type);
+    const ChunkCacheSettings settings = CalculateChunkCacheSettings(
+        GetSizeOfVariable(variableIdx),
+        chunkSize,
+        (sizeOfType > 0) ? sizeOfType : 8,
+        accessPattern,
+        maximumSizeInBytes);
+
+    SetChunkCache(variableName, settings);
+}
+
+NetCdfTimeBlockReader::NetCdfTimeBlockReader(NetCdfFileReader& reader, const std::string& variableName, const std::vector<size_t>& variableSize, size_t timeStepsPerBlock)
+    : m_reader(&reader), m_variableName(variableName), m_variableSize(variableSize), m_timeStepsPerBlock(timeStepsPerBlock)
+{
 }
 
-bool NetCdfFileReader::GetLinearScalingForVariable(int variableIdx, NetCdfFileReader::LinearScaling& scaling)
+bool NetCdfTimeBlockReader::ReadNextBlock(NetCdfTensor& block)
 {
-    int numberOfAttributes = GetNumberOfAttributesForVariable(variableIdx);
-    if (numberOfAttributes < 0)
+    if (m_nextTimeIndex >= m_variableSize[0])
     {
         return false;
     }
 
-    bool scalingFoundInFile = false;
-    double scaleFactorValue = 1.0;
-    if (NC_NOERR == nc_get_att_double(this->m_netCdfFileHandle, variableIdx, "scale_factor", &scaleFactorValue))
+    std::vector<size_t> start(m_variableSize.size(), 0);
+    std::vector<size_t> count = m_variableSize;
+    start[0] = m_nextTimeIndex;
+    count[0] = std::min(m_timeStepsPerBlock, m_variableSize[0] - m_nextTimeIndex);
+
+    // the block is read into the memory of the previous block
+    m_reader->ReadSlab(m_variableName, start, count, block);
+
+    m_firstTimeIndexOfBlock = m_nextTimeIndex;
+    m_nextTimeIndex += count[0];
+
+    return true;
+}
+
+void GetNeighbourhoodSlab(
+    const std::string& variableName,
+    const std::vector<size_t>& variableSize,
+    const std::vector<double>& spatialIndices,
+    std::vector<size_t>& start,
+    std::vector<size_t>& count,
+    std::vector<double>& localIndices,
+    bool longitudeWrapsAround)
+{
+    if (variableSize.size() != 4 || spatialIndices.size() != 3)
     {
-        scaling.scaleFactor = scaleFactorValue;
-        scalingFoundInFile = true;
+        std::stringstream msg;
+        msg << "Failed to read the neighbourhood of variable '" << variableName << "'. The variable must be four-dimensional and the point must have three spatial indices.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
     }
 
-    double additionalOffsetValue = 1.0;
-    if (NC_NOERR == nc_get_att_double(this->m_netCdfFileHandle, variableIdx, "add_offset", &additionalOffsetValue))
+    // The cube starts at the floor of each spatial index. A point exactly on the last
+    //  grid line is handled by starting one step earlier, such that the cube still has two values.
+    start = { 0, 0, 0, 0 };
+    count = { variableSize[0], 2, 2, 2 };
+    localIndices.resize(3);
+
+    for (size_t ii = 0; ii < 3; ++ii)
     {
-        scaling.offset = additionalOffsetValue;
-        scalingFoundInFile = true;
+        const size_t dimensionLength = variableSize[ii + 1];
+
+        // A point between the last and the first longitude of a periodic axis, see CoordinateAxis::WrapsAround.
+        if (ii == 2 && longitudeWrapsAround && dimensionLength >= 2 && spatialIndices[ii] > (double)(dimensionLength - 1) && spatialIndices[ii] < (double)dimensionLength)
+        {
+            start[ii + 1] = dimensionLength - 1;
+            localIndices[ii] = spatialIndices[ii] - (double)start[ii + 1];
+            continue;
+        }
+
+        // NaN fails every comparison, it is rejected by requiring the index to be at least zero.
+        if (!(spatialIndices[ii] >= 0.0) || dimensionLength < 2 || spatialIndices[ii] > (double)(dimensionLength - 1))
+        {
+            std::stringstream msg;
+            msg << "Failed to read the neighbourhood of variable '" << variableName << "'. The index " << spatialIndices[ii] << " lies outside of dimension " << ii + 1 << ".";
+            throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+        }
+
+        start[ii + 1] = std::min((size_t)std::floor(spatialIndices[ii]), dimensionLength - 2);
+        localIndices[ii] = spatialIndices[ii] - (double)start[ii + 1];
     }
+}
 
-    return scalingFoundInFile;
+void GetNeighbourhoodSlab(
+    const std::string& variableName,
+    const std::vector<size_t>& variableSize,
+    const std::vector<double>& spatialIndices,
+    const TimeRange& timeRange,
+    std::vector<size_t>& start,
+    std::vector<size_t>& count,
+    std::vector<double>& localIndices,
+    bool longitudeWrapsAround)
+{
+    GetNeighbourhoodSlab(variableName, variableSize, spatialIndices, start, count, localIndices, longitudeWrapsAround);
+
+    if (timeRange.first > variableSize[0] || timeRange.count > variableSize[0] - timeRange.first)
+    {
+        std::stringstream msg;
+        msg << "Failed to read the neighbourhood of variable '" << variableName << "'. The time steps [" << timeRange.first << ", ";
+        msg << timeRange.first + timeRange.count << ") lie outside of the variable.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+    }
+
+    start[0] = timeRange.first;
+    count[0] = timeRange.count;
+}
+
+bool NeighbourhoodWrapsAround(const std::vector<size_t>& variableSize, const std::vector<size_t>& start, const std::vector<size_t>& count)
+{
+    return variableSize.size() == 4 && start.size() == 4 && count.size() == 4 && start[3] + count[3] > variableSize[3];
+}
+
+NetCdfTensor MergeWrappedNeighbourhood(const NetCdfTensor& lastColumn, const NetCdfTensor& firstColumn)
+{
+    NetCdfTensor result;
+    result.size = lastColumn.size;
+    result.size[3] = 2;
+    result.dimensions = lastColumn.dimensions;
+    result.name = lastColumn.name;
+    result.values.resize(2 * lastColumn.values.size());
+    for (size_t ii = 0; ii < lastColumn.values.size(); ++ii)
+    {
+        result.values[2 * ii] = lastColumn.values[ii];
+        result.values[2 * ii + 1] = firstColumn.values[ii];
+    }
+
+    if (lastColumn.validity.size() > 0 || firstColumn.validity.size() > 0)
+    {
+        result.validity.assign((result.values.size() + 7) / 8, 0);
+        for (size_t ii = 0; ii < lastColumn.values.size(); ++ii)
+        {
+            result.validity[(2 * ii) >> 3] |= (uint8_t)((lastColumn.IsValid(ii) ? 1 : 0) << ((2 * ii) & 7));
+            result.validity[(2 * ii + 1) >> 3] |= (uint8_t)((firstColumn.IsValid(ii) ? 1 : 0) << ((2 * ii + 1) & 7));
+        }
+    }
+
+    return result;
 }
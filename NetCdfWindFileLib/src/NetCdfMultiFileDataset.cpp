@@ -0,0 +1,397 @@
+#include "NetCdfMultiFileDataset.h"
+#include "NetCdfFileReader.h"
+#include "MappedNetCdfFile.h"
+#include <MathUtils.h>
+#include <ScalingKernels.h>
+#include <netcdf.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <glob.h>
+#endif
+
+NetCdfMultiFileDataset::NetCdfMultiFileDataset(const std::string& timeVariableName)
+    : m_timeVariableName(timeVariableName)
+{
+}
+
+NetCdfMultiFileDataset::~NetCdfMultiFileDataset()
+{
+    Close();
+}
+
+std::vector<std::string> NetCdfMultiFileDataset::FindMatchingFiles(const std::string& filePattern)
+{
+    std::vector<std::string> result;
+
+#ifdef _WIN32
+    // FindFirstFile only returns the name of the file, not the directory
+    const size_t separator = filePattern.find_last_of("\\/");
+    const std::string directory = (separator == std::string::npos) ? "" : filePattern.substr(0, separator + 1);
+
+    WIN32_FIND_DATAA fileData;
+    HANDLE search = FindFirstFileA(filePattern.c_str(), &fileData);
+    if (search != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            if ((fileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+            {
+                result.push_back(directory + fileData.cFileName);
+            }
+        } while (FindNextFileA(search, &fileData));
+        FindClose(search);
+    }
+#else
+    glob_t globResult;
+    if (glob(filePattern.c_str(), 0, nullptr, &globResult) == 0)
+    {
+        for (size_t ii = 0; ii < globResult.gl_pathc; ++ii)
+        {
+            result.push_back(globResult.gl_pathv[ii]);
+        }
+    }
+    globfree(&globResult);
+#endif
+
+    std::sort(begin(result), end(result));
+    return result;
+}
+
+void NetCdfMultiFileDataset::OpenMatchingFiles(const std::string& filePattern)
+{
+    std::vector<std::string> filenames = FindMatchingFiles(filePattern);
+    if (filenames.size() == 0)
+    {
+        std::stringstream msg;
+        msg << "Failed to open net-cdf files, no file matches the pattern: '" << filePattern << "'";
+        throw NetCdfException(msg.str().c_str(), NC_EIO);
+    }
+
+    Open(filenames);
+}
+
+void NetCdfMultiFileDataset::Open(const std::vector<std::string>& filenames)
+{
+    Close();
+
+    std::vector<FileInformation> files(filenames.size());
+    std::vector<std::vector<double>> timesInFile(filenames.size());
+    std::vector<std::exception_ptr> errors(filenames.size());
+
+    for (size_t fileIdx = 0; fileIdx < filenames.size(); ++fileIdx)
+    {
+        files[fileIdx].filename = filenames[fileIdx];
+    }
+
+    // Index the files using a limited number of threads, each thread takes the next file which is not yet indexed.
+    std::atomic<size_t> nextFile(0);
+    auto indexFiles = [&]()
+    {
+        for (size_t fileIdx = nextFile++; fileIdx < files.size(); fileIdx = nextFile++)
+        {
+            try
+            {
+                IndexFile(files[fileIdx], timesInFile[fileIdx]);
+            }
+            catch (...)
+            {
+                errors[fileIdx] = std::current_exception();
+            }
+        }
+    };
+
+    const size_t numberOfThreads = std::min((size_t)std::max(std::thread::hardware_concurrency(), 1U), files.size());
+    std::vector<std::thread> threads;
+    for (size_t threadIdx = 1; threadIdx < numberOfThreads; ++threadIdx)
+    {
+        threads.push_back(std::thread(indexFiles));
+    }
+    indexFiles();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const std::exception_ptr& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Order the files by their first time value. Files without any time steps are ignored.
+    std::vector<size_t> order;
+    for (size_t fileIdx = 0; fileIdx < files.size(); ++fileIdx)
+    {
+        if (timesInFile[fileIdx].size() > 0)
+        {
+            order.push_back(fileIdx);
+        }
+    }
+    std::sort(begin(order), end(order), [&](size_t first, size_t second) { return timesInFile[first][0] < timesInFile[second][0]; });
+
+    std::vector<double> times;
+    for (size_t fileIdx : order)
+    {
+        // the files are compared with the first file, which is already moved into m_files
+        const FileInformation& file = files[fileIdx];
+        const FileInformation& firstFile = (m_files.size() > 0) ? m_files.front() : file;
+
+        std::string error;
+        if (file.grid != firstFile.grid)
+        {
+            error = "the file does not have the same grid as '" + firstFile.filename + "'";
+        }
+        else if (file.timeUnits != firstFile.timeUnits || file.calendar != firstFile.calendar)
+        {
+            error = "the time does not have the same units and calendar as in '" + firstFile.filename + "'";
+        }
+        else if (!std::is_sorted(begin(timesInFile[fileIdx]), end(timesInFile[fileIdx])))
+        {
+            error = "the time steps are not sorted in increasing order";
+        }
+        else if (times.size() > 0 && timesInFile[fileIdx].front() <= times.back())
+        {
+            error = "the time steps overlap the time steps of '" + m_files.back().filename + "'";
+        }
+
+        if (error.size() > 0)
+        {
+            std::stringstream msg;
+            msg << "Failed to open net-cdf file: '" << file.filename << "', " << error;
+            m_files.clear();
+            throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+        }
+
+        files[fileIdx].firstTimeIndex = times.size();
+        times.insert(end(times), begin(timesInFile[fileIdx]), end(timesInFile[fileIdx]));
+        m_files.push_back(std::move(files[fileIdx]));
+    }
+
+    const std::string timeUnits = (m_files.size() > 0) ? m_files.front().timeUnits : "";
+    m_times = TimeCoordinate(std::move(times), timeUnits.empty() ? TimeUnits() : ParseTimeUnits(timeUnits));
+}
+
+// @return the value of a text attribute, or an empty string if the variable does not have the attribute.
+template<class Reader>
+static std::string GetOptionalTextAttribute(Reader& reader, const std::string& variableName, const std::string& attributeName)
+{
+    try
+    {
+        return reader.GetTextAttribute(variableName, attributeName);
+    }
+    catch (NetCdfException& e)
+    {
+        if (e.statusCode != NC_ENOTATT)
+        {
+            throw;
+        }
+        return "";
+    }
+}
+
+// The CF conventions define 'gregorian' as an alias of 'standard', which is also the default.
+static std::string NormalizeCalendar(const std::string& calendar)
+{
+    return (calendar.empty() || calendar == "gregorian") ? "standard" : calendar;
+}
+
+void NetCdfMultiFileDataset::IndexFile(FileInformation& file, std::vector<double>& times) const
+{
+    std::string timeDimensionName;
+
+    if (MappedNetCdfFile::IsClassicFormatFile(file.filename))
+    {
+        // Classic files are read without the netcdf library, this can be done in parallel.
+        MappedNetCdfFile mappedFile;
+        mappedFile.Open(file.filename);
+
+        MappedNetCdfVariable time = mappedFile.GetVariable(m_timeVariableName);
+        times.resize(time.NumberOfElements());
+        for (size_t ii = 0; ii < times.size(); ++ii)
+        {
+            times[ii] = time.ValueAt(ii);
+        }
+
+        timeDimensionName = (time.dimensions.size() > 0) ? time.dimensions[0].name : "";
+        file.grid = mappedFile.GetDimensionLengths();
+        file.timeUnits = GetOptionalTextAttribute(mappedFile, m_timeVariableName, "units");
+        file.calendar = NormalizeCalendar(GetOptionalTextAttribute(mappedFile, m_timeVariableName, "calendar"));
+    }
+    else
+    {
+        // The netcdf library is not thread-safe, the reader serializes the calls into the library.
+        NetCdfFileReader reader;
+        reader.Open(file.filename);
+
+        TypedNetCdfTensor<double> time = reader.ReadVariable<double>(m_timeVariableName);
+        times.resize(time.values.size());
+        for (size_t ii = 0; ii < times.size(); ++ii)
+        {
+            times[ii] = time[ii];
+        }
+
+        timeDimensionName = (time.dimensions.size() > 0) ? time.dimensions[0].name : "";
+        file.grid = reader.GetDimensionLengths();
+        file.timeUnits = GetOptionalTextAttribute(reader, m_timeVariableName, "units");
+        file.calendar = NormalizeCalendar(GetOptionalTextAttribute(reader, m_timeVariableName, "calendar"));
+    }
+
+    file.numberOfTimeSteps = times.size();
+    file.grid.erase(timeDimensionName);
+}
+
+void NetCdfMultiFileDataset::Close()
+{
+    m_files.clear();
+    m_times = TimeCoordinate();
+}
+
+size_t NetCdfMultiFileDataset::FindFile(size_t timeIndex) const
+{
+    // the files are ordered by time, find the last file starting at or before the time index
+    auto file = std::upper_bound(begin(m_files), end(m_files), timeIndex,
+        [](size_t index, const FileInformation& file) { return index < file.firstTimeIndex; });
+    if (file == begin(m_files))
+    {
+        return m_files.size();
+    }
+    --file;
+
+    return (timeIndex < file->firstTimeIndex + file->numberOfTimeSteps) ? (size_t)(file - begin(m_files)) : m_files.size();
+}
+
+NetCdfFileReader& NetCdfMultiFileDataset::GetReader(size_t fileIdx)
+{
+    FileInformation& file = m_files[fileIdx];
+    if (file.reader == nullptr)
+    {
+        std::unique_ptr<NetCdfFileReader> reader(new NetCdfFileReader());
+        reader->Open(file.filename);
+        file.reader = std::move(reader);
+    }
+    return *file.reader;
+}
+
+bool NetCdfMultiFileDataset::ContainsVariable(const std::string& variableName)
+{
+    return m_files.size() > 0 && GetReader(0).ContainsVariable(variableName);
+}
+
+std::vector<size_t> NetCdfMultiFileDataset::GetSizeOfVariable(const std::string& variableName)
+{
+    if (m_files.size() == 0)
+    {
+        std::stringstream msg;
+        msg << "Failed to retrieve the size of variable '" << variableName << "', no files are opened.";
+        throw NetCdfException(msg.str().c_str(), NC_ENOTVAR);
+    }
+
+    std::vector<size_t> size = GetReader(0).GetSizeOfVariable(variableName);
+    if (size.size() == 0)
+    {
+        std::stringstream msg;
+        msg << "Failed to retrieve the size of variable '" << variableName << "', the variable has no time dimension.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+    }
+
+    size[0] = m_times.size();
+    return size;
+}
+
+NetCdfTensor NetCdfMultiFileDataset::ReadVariable(const std::string& variableName)
+{
+    std::vector<size_t> size = GetSizeOfVariable(variableName);
+    std::vector<size_t> start(size.size(), 0);
+
+    return ReadSlab(variableName, start, size);
+}
+
+NetCdfTensor NetCdfMultiFileDataset::ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, std::vector<double>& localIndices, bool longitudeWrapsAround)
+{
+    std::vector<size_t> size = GetSizeOfVariable(variableName);
+
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    GetNeighbourhoodSlab(variableName, size, spatialIndices, start, count, localIndices, longitudeWrapsAround);
+
+    return ReadNeighbourhoodSlab(size, start, count, [&](const std::vector<size_t>& slabStart, const std::vector<size_t>& slabCount)
+    {
+        return ReadSlab(variableName, slabStart, slabCount);
+    });
+}
+
+NetCdfTensor NetCdfMultiFileDataset::ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, const TimeRange& timeRange, std::vector<double>& localIndices, bool longitudeWrapsAround)
+{
+    std::vector<size_t> size = GetSizeOfVariable(variableName);
+
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    GetNeighbourhoodSlab(variableName, size, spatialIndices, timeRange, start, count, localIndices, longitudeWrapsAround);
+
+    return ReadNeighbourhoodSlab(size, start, count, [&](const std::vector<size_t>& slabStart, const std::vector<size_t>& slabCount)
+    {
+        return ReadSlab(variableName, slabStart, slabCount);
+    });
+}
+
+NetCdfTensor NetCdfMultiFileDataset::ReadSlab(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count)
+{
+    std::vector<size_t> size = GetSizeOfVariable(variableName);
+    if (start.size() != size.size() || count.size() != size.size() || start[0] > size[0] || count[0] > size[0] - start[0])
+    {
+        std::stringstream msg;
+        msg << "Failed to read a slab of variable '" << variableName << "', the slab does not lie inside of the variable.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+    }
+
+    NetCdfTensor result;
+    result.name = variableName;
+    result.size = count;
+    result.values.reserve(ProductOfElements(count));
+
+    const size_t endTimeIndex = start[0] + count[0];
+
+    // Only the files which overlap the requested time range are read, starting with the file containing the first time step.
+    for (size_t fileIdx = FindFile(start[0]); fileIdx < m_files.size() && m_files[fileIdx].firstTimeIndex < endTimeIndex; ++fileIdx)
+    {
+        const FileInformation& file = m_files[fileIdx];
+        const size_t fileEndTimeIndex = file.firstTimeIndex + file.numberOfTimeSteps;
+
+        std::vector<size_t> fileStart = start;
+        std::vector<size_t> fileCount = count;
+        fileStart[0] = std::max(start[0], file.firstTimeIndex) - file.firstTimeIndex;
+        fileCount[0] = std::min(endTimeIndex, fileEndTimeIndex) - file.firstTimeIndex - fileStart[0];
+
+        NetCdfTensor part = GetReader(fileIdx).ReadSlab(variableName, fileStart, fileCount);
+
+        if (result.dimensions.size() == 0)
+        {
+            result.dimensions = part.dimensions;
+        }
+
+        // The bitmap is only created once a file has missing values, all values before this are valid.
+        if (part.validity.size() > 0 && result.validity.size() == 0)
+        {
+            result.validity.resize((ProductOfElements(count) + 7) / 8, 0xFF);
+        }
+        if (part.validity.size() > 0)
+        {
+            CopyValidityBits(part.validity.data(), part.values.size(), result.validity.data(), result.values.size());
+        }
+
+        result.values.insert(end(result.values), begin(part.values), end(part.values));
+    }
+
+    return result;
+}
@@ -0,0 +1,293 @@
+#include "NetCdfReaderPool.h"
+#include "NetCdfFileReader.h"
+#include <MathUtils.h>
+#include <MappedNetCdfFile.h>
+#include <ScalingKernels.h>
+#include <netcdf.h>
+#include <algorithm>
+#include <exception>
+#include <sstream>
+#include <thread>
+
+NetCdfReaderPool::Lease::Lease(NetCdfReaderPool* pool, NetCdfFileReader* reader)
+    : m_pool(pool), m_reader(reader)
+{
+}
+
+NetCdfReaderPool::Lease::Lease(Lease&& other) noexcept
+    : m_pool(other.m_pool), m_reader(other.m_reader)
+{
+    other.m_pool = nullptr;
+    other.m_reader = nullptr;
+}
+
+NetCdfReaderPool::Lease::~Lease()
+{
+    if (m_pool != nullptr && m_reader != nullptr)
+    {
+        m_pool->Release(m_reader);
+    }
+}
+
+NetCdfReaderPool::NetCdfReaderPool()
+{
+}
+
+NetCdfReaderPool::~NetCdfReaderPool()
+{
+    Close();
+}
+
+void NetCdfReaderPool::Open(const std::string& filename, size_t numberOfReaders, NetCdfOpenMode mode, NetCdfAccessPattern accessPattern)
+{
+    Close();
+
+    if (numberOfReaders == 0)
+    {
+        numberOfReaders = std::max((size_t)std::thread::hardware_concurrency(), (size_t)1);
+    }
+
+    // Select the mode once for all readers, every reader keeps its own copy of a diskless file in memory.
+    if (mode == NetCdfOpenMode::Automatic)
+    {
+        mode = SelectOpenMode(
+            GetSizeOfFile(filename),
+            MappedNetCdfFile::IsClassicFormatFile(filename),
+            accessPattern,
+            NetCdfFileReader::DefaultMaximumDisklessSize / numberOfReaders);
+    }
+
+    std::vector<std::unique_ptr<NetCdfFileReader>> readers;
+    for (size_t readerIdx = 0; readerIdx < numberOfReaders; ++readerIdx)
+    {
+        std::unique_ptr<NetCdfFileReader> reader(new NetCdfFileReader());
+        reader->Open(filename, mode);
+        readers.push_back(std::move(reader));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_readers = std::move(readers);
+    for (auto& reader : m_readers)
+    {
+        m_availableReaders.push_back(reader.get());
+    }
+    m_threadPool.reset(new ThreadPool(m_readers.size()));
+}
+
+void NetCdfReaderPool::Close()
+{
+    // Destroying the thread pool completes the reads which are already queued.
+    m_threadPool.reset();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_availableReaders.clear();
+    m_readers.clear();
+}
+
+NetCdfReaderPool::Lease NetCdfReaderPool::Acquire()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_readers.size() == 0)
+    {
+        throw NetCdfException("Failed to acquire a net-cdf reader, the reader pool is not opened.", NC_EBADID);
+    }
+
+    m_readerReturned.wait(lock, [this]() { return m_availableReaders.size() > 0; });
+
+    NetCdfFileReader* reader = m_availableReaders.back();
+    m_availableReaders.pop_back();
+    return Lease(this, reader);
+}
+
+void NetCdfReaderPool::TuneChunkCache(const std::string& variableName, NetCdfAccessPattern accessPattern, size_t maximumSizeInBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& reader : m_readers)
+    {
+        reader->TuneChunkCache(variableName, accessPattern, maximumSizeInBytes);
+    }
+}
+
+void NetCdfReaderPool::Release(NetCdfFileReader* reader)
+{
+    // the next lease may be used from another thread, which must not share the reader with a lazy tensor
+    reader->DetachLazyTensors();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_availableReaders.push_back(reader);
+    }
+    m_readerReturned.notify_one();
+}
+
+ThreadPool& NetCdfReaderPool::GetThreadPool()
+{
+    if (m_threadPool == nullptr)
+    {
+        throw NetCdfException("Failed to start reading, the net-cdf reader pool is not opened.", NC_EBADID);
+    }
+    return *m_threadPool;
+}
+
+std::future<NetCdfTensor> NetCdfReaderPool::ReadVariableAsync(const std::string& variableName)
+{
+    return GetThreadPool().Submit([this, variableName]()
+    {
+        Lease reader = Acquire();
+        return reader->ReadVariable(variableName);
+    });
+}
+
+std::future<NetCdfTensor> NetCdfReaderPool::ReadSlabAsync(const std::string& variableName, const std::vector<size_t>& start, const std::vector<size_t>& count)
+{
+    return GetThreadPool().Submit([this, variableName, start, count]()
+    {
+        Lease reader = Acquire();
+        return reader->ReadSlab(variableName, start, count);
+    });
+}
+
+std::future<NetCdfTensor> NetCdfReaderPool::ReadNeighbourhoodAsync(const std::string& variableName, const std::vector<double>& spatialIndices, std::vector<double>& localIndices, bool longitudeWrapsAround)
+{
+    // The extent of the cube only depends on the catalogue, it is calculated here such that
+    //  the local indices are available immediately.
+    std::vector<size_t> variableSize;
+    {
+        Lease reader = Acquire();
+        variableSize = reader->GetSizeOfVariable(variableName);
+    }
+
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    GetNeighbourhoodSlab(variableName, variableSize, spatialIndices, start, count, localIndices, longitudeWrapsAround);
+
+    return ReadNeighbourhoodSlabAsync(variableName, variableSize, start, count);
+}
+
+std::future<NetCdfTensor> NetCdfReaderPool::ReadNeighbourhoodAsync(const std::string& variableName, const std::vector<double>& spatialIndices, const TimeRange& timeRange, std::vector<double>& localIndices, bool longitudeWrapsAround)
+{
+    std::vector<size_t> variableSize;
+    {
+        Lease reader = Acquire();
+        variableSize = reader->GetSizeOfVariable(variableName);
+    }
+
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    GetNeighbourhoodSlab(variableName, variableSize, spatialIndices, timeRange, start, count, localIndices, longitudeWrapsAround);
+
+    return ReadNeighbourhoodSlabAsync(variableName, variableSize, start, count);
+}
+
+std::future<NetCdfTensor> NetCdfReaderPool::ReadNeighbourhoodSlabAsync(const std::string& variableName, const std::vector<size_t>& variableSize, const std::vector<size_t>& start, const std::vector<size_t>& count)
+{
+    // A cube which wraps around the longitude is read as two slabs, by the same reader.
+    return GetThreadPool().Submit([this, variableName, variableSize, start, count]()
+    {
+        Lease reader = Acquire();
+        return ReadNeighbourhoodSlab(variableSize, start, count, [&](const std::vector<size_t>& slabStart, const std::vector<size_t>& slabCount)
+        {
+            return reader->ReadSlab(variableName, slabStart, slabCount);
+        });
+    });
+}
+
+std::vector<NetCdfTensor> NetCdfReaderPool::ReadVariables(const std::vector<std::string>& variableNames)
+{
+    std::vector<std::future<NetCdfTensor>> pendingReads;
+    for (const std::string& variableName : variableNames)
+    {
+        pendingReads.push_back(ReadVariableAsync(variableName));
+    }
+
+    // Wait for all reads before reporting any error, the reads refer to this object.
+    std::vector<NetCdfTensor> result(variableNames.size());
+    std::exception_ptr firstError;
+    for (size_t variableIdx = 0; variableIdx < pendingReads.size(); ++variableIdx)
+    {
+        try
+        {
+            result[variableIdx] = pendingReads[variableIdx].get();
+        }
+        catch (...)
+        {
+            if (!firstError)
+            {
+                firstError = std::current_exception();
+            }
+        }
+    }
+
+    if (firstError)
+    {
+        std::rethrow_exception(firstError);
+    }
+    return result;
+}
+
+NetCdfTensor NetCdfReaderPool::ReadVariable(const std::string& variableName)
+{
+    std::vector<size_t> size;
+    {
+        Lease reader = Acquire();
+        size = reader->GetSizeOfVariable(variableName);
+        if (size.size() == 0 || size[0] < 2 || m_readers.size() < 2)
+        {
+            return reader->ReadVariable(variableName);
+        }
+    }
+
+    // Split the first dimension into one contiguous range of rows per reader.
+    const size_t numberOfParts = std::min(m_readers.size(), size[0]);
+    const size_t rowsPerPart = (size[0] + numberOfParts - 1) / numberOfParts;
+    const size_t valuesPerRow = ProductOfElements(size) / size[0];
+
+    std::vector<size_t> firstRows;
+    std::vector<std::future<NetCdfTensor>> pendingReads;
+    for (size_t firstRow = 0; firstRow < size[0]; firstRow += rowsPerPart)
+    {
+        std::vector<size_t> start(size.size(), 0);
+        std::vector<size_t> count = size;
+        start[0] = firstRow;
+        count[0] = std::min(rowsPerPart, size[0] - firstRow);
+
+        firstRows.push_back(firstRow);
+        pendingReads.push_back(ReadSlabAsync(variableName, start, count));
+    }
+
+    NetCdfTensor result;
+    result.size = size;
+    result.name = variableName;
+    result.values.resize(ProductOfElements(size));
+
+    std::exception_ptr firstError;
+    for (size_t partIdx = 0; partIdx < pendingReads.size(); ++partIdx)
+    {
+        try
+        {
+            NetCdfTensor part = pendingReads[partIdx].get();
+            std::copy(begin(part.values), end(part.values), begin(result.values) + firstRows[partIdx] * valuesPerRow);
+            result.dimensions = part.dimensions;
+
+            if (part.validity.size() > 0)
+            {
+                // all values are valid, until shown otherwise
+                result.validity.resize((result.values.size() + 7) / 8, 0xFF);
+                CopyValidityBits(part.validity.data(), part.values.size(), result.validity.data(), firstRows[partIdx] * valuesPerRow);
+            }
+        }
+        catch (...)
+        {
+            if (!firstError)
+            {
+                firstError = std::current_exception();
+            }
+        }
+    }
+
+    if (firstError)
+    {
+        std::rethrow_exception(firstError);
+    }
+    return result;
+}
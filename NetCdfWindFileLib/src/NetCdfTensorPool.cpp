@@ -0,0 +1,59 @@
+#include "NetCdfTensorPool.h"
+#include <algorithm>
+
+NetCdfTensorPool::NetCdfTensorPool(size_t maximumNumberOfTensors)
+    : m_maximumNumberOfTensors(maximumNumberOfTensors)
+{
+}
+
+NetCdfTensor NetCdfTensorPool::Acquire(size_t numberOfValues)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_tensors.size() == 0)
+    {
+        return NetCdfTensor();
+    }
+
+    // The tensors are kept sorted by capacity, take the first one which is large enough.
+    auto tensor = std::find_if(begin(m_tensors), end(m_tensors), [numberOfValues](const NetCdfTensor& t) { return t.values.capacity() >= numberOfValues; });
+    if (tensor == end(m_tensors))
+    {
+        tensor = end(m_tensors) - 1;
+    }
+
+    NetCdfTensor result = std::move(*tensor);
+    m_tensors.erase(tensor);
+    return result;
+}
+
+void NetCdfTensorPool::Release(NetCdfTensor&& tensor)
+{
+    tensor.size.clear();
+    tensor.dimensions.clear();
+    tensor.values.clear();
+    tensor.validity.clear();
+    tensor.name.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto position = std::upper_bound(begin(m_tensors), end(m_tensors), tensor.values.capacity(),
+        [](size_t capacity, const NetCdfTensor& t) { return capacity < t.values.capacity(); });
+    m_tensors.insert(position, std::move(tensor));
+
+    if (m_tensors.size() > m_maximumNumberOfTensors)
+    {
+        m_tensors.erase(begin(m_tensors));
+    }
+}
+
+size_t NetCdfTensorPool::NumberOfTensors() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tensors.size();
+}
+
+void NetCdfTensorPool::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tensors.clear();
+}
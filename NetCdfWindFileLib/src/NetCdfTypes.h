@@ -0,0 +1,26 @@
+#pragma once
+#include <netcdf.h>
+#include <cstddef>
+
+// Internal helpers for the types of the netcdf library, shared by the readers in this library.
+
+// @return the size in bytes of one value of the provided netcdf type,
+//  or zero if this is not one of the atomic numeric or character types.
+inline size_t SizeOfType(int type)
+{
+    switch (type)
+    {
+    case NC_BYTE: return 1;
+    case NC_CHAR: return 1;
+    case NC_SHORT: return 2;
+    case NC_INT: return 4;
+    case NC_FLOAT: return 4;
+    case NC_DOUBLE: return 8;
+    case NC_UBYTE: return 1;
+    case NC_USHORT: return 2;
+    case NC_UINT: return 4;
+    case NC_INT64: return 8;
+    case NC_UINT64: return 8;
+    default: return 0;
+    }
+}
@@ -0,0 +1,480 @@
+#include "PointMajorCache.h"
+#include "NetCdfFileReader.h"
+#include <MathUtils.h>
+#include <netcdf.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+// The first bytes of every point-major cache file, followed by the version of the format.
+static const char PointMajorCacheSignature[8] = { 'N', 'C', 'P', 'M', 'C', 'A', 'C', 'H' };
+static const uint32_t PointMajorCacheVersion = 2;
+
+// The values of each variable start at a multiple of this.
+static const uint64_t PointMajorCacheAlignment = 4096;
+
+template<class T>
+static void WriteValue(std::ofstream& file, T value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<class T>
+static T ReadValue(std::ifstream& file)
+{
+    T value = 0;
+    file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+// @return the number of grid cells, i.e. the number of values in one time step, of a variable with the provided size.
+static size_t NumberOfCells(const std::vector<size_t>& variableSize)
+{
+    return ProductOfElements(std::vector<size_t>(variableSize.begin() + 1, variableSize.end()));
+}
+
+PointMajorCacheWriter::~PointMajorCacheWriter()
+{
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+}
+
+void PointMajorCacheWriter::Create(const std::string& filename, const FileFingerprint& sourceFingerprint, const std::map<std::string, std::vector<size_t>>& variables, const std::map<std::string, std::vector<double>>& coordinates)
+{
+    m_variables.clear();
+
+    // The size of the header, such that the offset of the values can be calculated before writing it.
+    uint64_t headerSize = sizeof(PointMajorCacheSignature) + 3 * sizeof(uint32_t) + 3 * sizeof(uint64_t);
+    for (const auto& coordinate : coordinates)
+    {
+        headerSize += sizeof(uint32_t) + coordinate.first.size() + sizeof(uint64_t) + sizeof(double) * coordinate.second.size();
+    }
+    for (const auto& variable : variables)
+    {
+        if (variable.second.size() == 0)
+        {
+            std::stringstream msg;
+            msg << "Failed to create the point-major cache '" << filename << "'. The variable '" << variable.first << "' has no dimensions.";
+            throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+        }
+        headerSize += 2 * sizeof(uint32_t) + variable.first.size() + (variable.second.size() + 1) * sizeof(uint64_t);
+    }
+
+    uint64_t dataOffset = headerSize;
+    for (const auto& variable : variables)
+    {
+        dataOffset = (dataOffset + PointMajorCacheAlignment - 1) / PointMajorCacheAlignment * PointMajorCacheAlignment;
+
+        VariableInformation& information = m_variables[variable.first];
+        information.size = variable.second;
+        information.dataOffset = dataOffset;
+
+        dataOffset += sizeof(float) * (uint64_t)ProductOfElements(variable.second);
+    }
+
+    m_file.open(filename, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!m_file.is_open())
+    {
+        std::stringstream msg;
+        msg << "Failed to create the point-major cache with path: '" << filename << "'";
+        throw NetCdfException(msg.str().c_str(), NC_EIO);
+    }
+    m_filename = filename;
+
+    m_file.write(PointMajorCacheSignature, sizeof(PointMajorCacheSignature));
+    WriteValue<uint32_t>(m_file, PointMajorCacheVersion);
+
+    WriteValue<uint64_t>(m_file, sourceFingerprint.fileSize);
+    WriteValue<int64_t>(m_file, sourceFingerprint.modificationTime);
+    WriteValue<uint64_t>(m_file, sourceFingerprint.headerHash);
+
+    WriteValue<uint32_t>(m_file, (uint32_t)coordinates.size());
+    for (const auto& coordinate : coordinates)
+    {
+        WriteValue<uint32_t>(m_file, (uint32_t)coordinate.first.size());
+        m_file.write(coordinate.first.data(), coordinate.first.size());
+        WriteValue<uint64_t>(m_file, coordinate.second.size());
+        m_file.write(reinterpret_cast<const char*>(coordinate.second.data()), sizeof(double) * coordinate.second.size());
+    }
+
+    WriteValue<uint32_t>(m_file, (uint32_t)m_variables.size());
+    for (const auto& variable : m_variables)
+    {
+        WriteValue<uint32_t>(m_file, (uint32_t)variable.first.size());
+        m_file.write(variable.first.data(), variable.first.size());
+        WriteValue<uint32_t>(m_file, (uint32_t)variable.second.size.size());
+        for (size_t length : variable.second.size)
+        {
+            WriteValue<uint64_t>(m_file, length);
+        }
+        WriteValue<uint64_t>(m_file, variable.second.dataOffset);
+    }
+
+    if (m_file.fail())
+    {
+        std::stringstream msg;
+        msg << "Failed to write the header of the point-major cache '" << m_filename << "'";
+        throw NetCdfException(msg.str().c_str(), NC_EIO);
+    }
+}
+
+void PointMajorCacheWriter::WriteCells(const std::string& variableName, size_t firstCellIndex, const NetCdfTensor& block)
+{
+    auto variable = m_variables.find(variableName);
+    if (variable == m_variables.end())
+    {
+        std::stringstream msg;
+        msg << "Failed to write to the point-major cache, the variable '" << variableName << "' is not in the cache.";
+        throw NetCdfException(msg.str().c_str(), NC_ENOTVAR);
+    }
+
+    const std::vector<size_t>& variableSize = variable->second.size;
+    const size_t numberOfCells = NumberOfCells(variableSize);
+    if (block.size.size() != variableSize.size() || block.size[0] != variableSize[0] ||
+        firstCellIndex + NumberOfCells(block.size) > numberOfCells)
+    {
+        std::stringstream msg;
+        msg << "Failed to write to the point-major cache, the block does not fit into the variable '" << variableName << "'.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+    }
+
+    const size_t numberOfTimeSteps = variableSize[0];
+    const size_t cellsInBlock = NumberOfCells(block.size);
+
+    // Transpose the block in tiles of cells, such that both the reads and the writes stay in the cache.
+    const size_t cellsPerTile = 256;
+    m_transposedBlock.resize(numberOfTimeSteps * cellsInBlock);
+    for (size_t firstCell = 0; firstCell < cellsInBlock; firstCell += cellsPerTile)
+    {
+        const size_t lastCell = std::min(firstCell + cellsPerTile, cellsInBlock);
+        for (size_t timeIdx = 0; timeIdx < numberOfTimeSteps; ++timeIdx)
+        {
+            const float* timeStep = block.values.data() + timeIdx * cellsInBlock;
+            for (size_t cellIdx = firstCell; cellIdx < lastCell; ++cellIdx)
+            {
+                m_transposedBlock[cellIdx * numberOfTimeSteps + timeIdx] = timeStep[cellIdx];
+            }
+        }
+    }
+
+    // The series of consecutive cells are adjacent in the file, the transposed block is therefore contiguous.
+    const uint64_t offset = variable->second.dataOffset + sizeof(float) * (uint64_t)firstCellIndex * numberOfTimeSteps;
+    m_file.seekp((std::streamoff)offset);
+    m_file.write(reinterpret_cast<const char*>(m_transposedBlock.data()), sizeof(float) * m_transposedBlock.size());
+
+    if (m_file.fail())
+    {
+        std::stringstream msg;
+        msg << "Failed to write the variable '" << variableName << "' to the point-major cache '" << m_filename << "'";
+        throw NetCdfException(msg.str().c_str(), NC_EIO);
+    }
+}
+
+void PointMajorCacheWriter::Close()
+{
+    if (!m_file.is_open())
+    {
+        return;
+    }
+
+    m_file.close();
+    m_transposedBlock.clear();
+    m_transposedBlock.shrink_to_fit();
+
+    if (m_file.fail())
+    {
+        std::stringstream msg;
+        msg << "Failed to complete the point-major cache '" << m_filename << "'";
+        throw NetCdfException(msg.str().c_str(), NC_EIO);
+    }
+}
+
+void PointMajorCacheFile::Open(const std::string& filename)
+{
+    Close();
+
+    m_file.open(filename, std::ios::binary | std::ios::in);
+    if (!m_file.is_open())
+    {
+        std::stringstream msg;
+        msg << "Failed to open the point-major cache with path: '" << filename << "'";
+        throw NetCdfException(msg.str().c_str(), NC_EIO);
+    }
+    m_filename = filename;
+
+    m_file.seekg(0, std::ios::end);
+    const uint64_t fileSize = (uint64_t)m_file.tellg();
+    m_file.seekg(0, std::ios::beg);
+
+    char signature[sizeof(PointMajorCacheSignature)] = {};
+    m_file.read(signature, sizeof(signature));
+    const uint32_t version = ReadValue<uint32_t>(m_file);
+    if (m_file.fail() || std::memcmp(signature, PointMajorCacheSignature, sizeof(signature)) != 0 || version != PointMajorCacheVersion)
+    {
+        Close();
+        std::stringstream msg;
+        msg << "Failed to open '" << filename << "', the file is not a point-major cache or has an unknown version.";
+        throw NetCdfException(msg.str().c_str(), NC_ENOTNC);
+    }
+
+    m_sourceFingerprint.fileSize = ReadValue<uint64_t>(m_file);
+    m_sourceFingerprint.modificationTime = ReadValue<int64_t>(m_file);
+    m_sourceFingerprint.headerHash = ReadValue<uint64_t>(m_file);
+
+    const uint32_t numberOfCoordinates = ReadValue<uint32_t>(m_file);
+    for (uint32_t coordinateIdx = 0; coordinateIdx < numberOfCoordinates && !m_file.fail(); ++coordinateIdx)
+    {
+        std::string name(ReadValue<uint32_t>(m_file), '\0');
+        m_file.read(&name[0], name.size());
+
+        const uint64_t length = ReadValue<uint64_t>(m_file);
+        if (m_file.fail() || length > (fileSize - (uint64_t)m_file.tellg()) / sizeof(double))
+        {
+            Close();
+            std::stringstream msg;
+            msg << "Failed to open the point-major cache '" << filename << "', the file is truncated.";
+            throw NetCdfException(msg.str().c_str(), NC_ENOTNC);
+        }
+
+        std::vector<double>& values = m_coordinates[name];
+        values.resize((size_t)length);
+        m_file.read(reinterpret_cast<char*>(values.data()), sizeof(double) * values.size());
+    }
+
+    const uint32_t numberOfVariables = ReadValue<uint32_t>(m_file);
+    for (uint32_t variableIdx = 0; variableIdx < numberOfVariables && !m_file.fail(); ++variableIdx)
+    {
+        std::string name(ReadValue<uint32_t>(m_file), '\0');
+        m_file.read(&name[0], name.size());
+
+        VariableInformation variable;
+        variable.size.resize(ReadValue<uint32_t>(m_file));
+        for (size_t& length : variable.size)
+        {
+            length = (size_t)ReadValue<uint64_t>(m_file);
+        }
+        variable.dataOffset = ReadValue<uint64_t>(m_file);
+
+        if (m_file.fail() || variable.size.size() == 0 ||
+            variable.dataOffset + sizeof(float) * (uint64_t)ProductOfElements(variable.size) > fileSize)
+        {
+            Close();
+            std::stringstream msg;
+            msg << "Failed to open the point-major cache '" << filename << "', the file is truncated.";
+            throw NetCdfException(msg.str().c_str(), NC_ENOTNC);
+        }
+
+        m_variables[name] = variable;
+    }
+}
+
+void PointMajorCacheFile::Close()
+{
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+    m_file.clear();
+    m_variables.clear();
+    m_coordinates.clear();
+    m_sourceFingerprint = FileFingerprint();
+}
+
+bool PointMajorCacheFile::IsUpToDate(const std::string& sourceFilename) const
+{
+    return GetFileFingerprint(sourceFilename) == m_sourceFingerprint;
+}
+
+bool PointMajorCacheFile::ContainsCoordinate(const std::string& coordinateName) const
+{
+    return m_coordinates.find(coordinateName) != m_coordinates.end();
+}
+
+const std::vector<double>& PointMajorCacheFile::GetCoordinate(const std::string& coordinateName) const
+{
+    auto coordinate = m_coordinates.find(coordinateName);
+    if (coordinate == m_coordinates.end())
+    {
+        std::stringstream msg;
+        msg << "Failed to find the coordinate '" << coordinateName << "' in the point-major cache.";
+        throw NetCdfException(msg.str().c_str(), NC_ENOTVAR);
+    }
+    return coordinate->second;
+}
+
+bool PointMajorCacheFile::ContainsVariable(const std::string& variableName) const
+{
+    return m_variables.find(variableName) != m_variables.end();
+}
+
+std::vector<size_t> PointMajorCacheFile::GetSizeOfVariable(const std::string& variableName) const
+{
+    return FindVariable(variableName).size;
+}
+
+const PointMajorCacheFile::VariableInformation& PointMajorCacheFile::FindVariable(const std::string& variableName) const
+{
+    auto variable = m_variables.find(variableName);
+    if (variable == m_variables.end())
+    {
+        std::stringstream msg;
+        msg << "Failed to find variable '" << variableName << "' in the point-major cache.";
+        throw NetCdfException(msg.str().c_str(), NC_ENOTVAR);
+    }
+    return variable->second;
+}
+
+NetCdfTensor PointMajorCacheFile::ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, std::vector<double>& localIndices, bool longitudeWrapsAround)
+{
+    TimeRange timeRange;
+    timeRange.count = FindVariable(variableName).size[0];
+
+    return ReadNeighbourhood(variableName, spatialIndices, timeRange, localIndices, longitudeWrapsAround);
+}
+
+NetCdfTensor PointMajorCacheFile::ReadNeighbourhood(const std::string& variableName, const std::vector<double>& spatialIndices, const TimeRange& timeRange, std::vector<double>& localIndices, bool longitudeWrapsAround)
+{
+    const VariableInformation& variable = FindVariable(variableName);
+
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    GetNeighbourhoodSlab(variableName, variable.size, spatialIndices, timeRange, start, count, localIndices, longitudeWrapsAround);
+
+    NetCdfTensor result;
+    result.name = variableName;
+    result.size = count;
+    result.values.resize(ProductOfElements(count));
+
+    // Each corner of the cube is one sequential read of its time series.
+    const size_t numberOfTimeSteps = variable.size[0];
+    m_timeSeries.resize(timeRange.count);
+    bool allValid = true;
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        const size_t levelIdx = start[1] + ((cornerIdx >> 2) & 1);
+        const size_t latitudeIdx = start[2] + ((cornerIdx >> 1) & 1);
+        // The cube only extends past the last longitude if it wraps around, see NeighbourhoodWrapsAround.
+        const size_t longitudeIdx = (start[3] + (cornerIdx & 1)) % variable.size[3];
+        const size_t cellIdx = (levelIdx * variable.size[2] + latitudeIdx) * variable.size[3] + longitudeIdx;
+
+        const uint64_t offset = variable.dataOffset + sizeof(float) * ((uint64_t)cellIdx * numberOfTimeSteps + timeRange.first);
+        m_file.seekg((std::streamoff)offset);
+        m_file.read(reinterpret_cast<char*>(m_timeSeries.data()), sizeof(float) * m_timeSeries.size());
+        if (m_file.fail())
+        {
+            m_file.clear();
+            std::stringstream msg;
+            msg << "Failed to read variable '" << variableName << "' from the point-major cache '" << m_filename << "'";
+            throw NetCdfException(msg.str().c_str(), NC_EIO);
+        }
+
+        for (size_t timeIdx = 0; timeIdx < m_timeSeries.size(); ++timeIdx)
+        {
+            result.values[timeIdx * 8 + cornerIdx] = m_timeSeries[timeIdx];
+            allValid &= !std::isnan(m_timeSeries[timeIdx]);
+        }
+    }
+
+    // Missing values are stored as NaN in the cache.
+    if (!allValid)
+    {
+        result.validity.assign((result.values.size() + 7) / 8, 0);
+        for (size_t ii = 0; ii < result.values.size(); ++ii)
+        {
+            if (!std::isnan(result.values[ii]))
+            {
+                result.validity[ii >> 3] |= (uint8_t)(1 << (ii & 7));
+            }
+        }
+    }
+
+    return result;
+}
+
+void ConvertToPointMajorCache(const std::string& sourceFilename, const std::vector<std::string>& variableNames, const std::string& cacheFilename, size_t maximumBytesPerTile)
+{
+    // The fingerprint is taken before reading, such that a file which is modified while it is read is detected later.
+    const FileFingerprint sourceFingerprint = GetFileFingerprint(sourceFilename);
+
+    NetCdfFileReader reader;
+    reader.Open(sourceFilename);
+
+    std::map<std::string, std::vector<size_t>> variables;
+    std::map<std::string, std::vector<double>> coordinates;
+    for (const std::string& variableName : variableNames)
+    {
+        variables[variableName] = reader.GetSizeOfVariable(variableName);
+
+        for (const NetCdfDimension& dimension : reader.GetDimensionsOfVariable(variableName))
+        {
+            if (coordinates.find(dimension.name) == coordinates.end() && reader.ContainsVariable(dimension.name))
+            {
+                const TypedNetCdfTensor<double> coordinate = reader.ReadVariable<double>(dimension.name);
+                std::vector<double>& values = coordinates[dimension.name];
+                values.resize(coordinate.values.size());
+                for (size_t ii = 0; ii < values.size(); ++ii)
+                {
+                    values[ii] = coordinate[ii];
+                }
+            }
+        }
+    }
+
+    PointMajorCacheWriter writer;
+    writer.Create(cacheFilename, sourceFingerprint, variables, coordinates);
+
+    NetCdfTensor tile;
+    for (const std::string& variableName : variableNames)
+    {
+        const std::vector<size_t>& variableSize = variables[variableName];
+        const size_t numberOfCells = NumberOfCells(variableSize);
+        if (numberOfCells == 0 || variableSize[0] == 0)
+        {
+            continue;
+        }
+        reader.TuneChunkCache(variableName, NetCdfAccessPattern::TimeSeriesAtPoint);
+
+        if (variableSize.size() == 1)
+        {
+            // The variable is one single time series.
+            reader.ReadVariable(variableName, tile);
+            writer.WriteCells(variableName, 0, tile);
+            continue;
+        }
+
+        // Each tile is a range along one spatial dimension (splitDim), with the full extent in all the following dimensions
+        //  such that the cells of the tile are consecutive. The first dimension which allows a tile to fit is used.
+        const size_t bytesPerCell = sizeof(float) * variableSize[0];
+        size_t splitDim = 1;
+        size_t cellsPerStep = numberOfCells / variableSize[1];
+        while (splitDim + 1 < variableSize.size() && cellsPerStep * bytesPerCell > maximumBytesPerTile)
+        {
+            ++splitDim;
+            cellsPerStep /= variableSize[splitDim];
+        }
+        const size_t stepsPerTile = std::max((size_t)1, maximumBytesPerTile / (cellsPerStep * bytesPerCell));
+
+        std::vector<size_t> start(variableSize.size(), 0);
+        std::vector<size_t> count = variableSize;
+        for (size_t firstCell = 0; firstCell < numberOfCells; firstCell += ProductOfElements(count) / count[0])
+        {
+            // The index of the first cell along each of the spatial dimensions, up to the split dimension.
+            size_t remainingIndex = firstCell / cellsPerStep;
+            for (size_t dimIdx = splitDim; dimIdx >= 1; --dimIdx)
+            {
+                start[dimIdx] = remainingIndex % variableSize[dimIdx];
+                remainingIndex /= variableSize[dimIdx];
+                count[dimIdx] = 1;
+            }
+            count[splitDim] = std::min(stepsPerTile, variableSize[splitDim] - start[splitDim]);
+
+            reader.ReadSlab(variableName, start, count, tile);
+            writer.WriteCells(variableName, firstCell, tile);
+        }
+    }
+
+    writer.Close();
+}
@@ -0,0 +1,465 @@
+#include <ScalingKernels.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define NETCDF_USE_SSE2
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Functions using AVX2 instructions must be marked as such for gcc and clang,
+//  MSVC allows the intrinsics to be used without any special flags.
+#if defined(__GNUC__)
+#define NETCDF_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NETCDF_TARGET_AVX2
+#endif
+
+// Arrays with fewer values than this per thread are not split over several threads.
+static const size_t MinimumValuesPerThread = 1 << 20;
+
+static void DecodePackedValuesScalar(const short* source, size_t numberOfValues, const LinearScaling& scaling, float* destination)
+{
+    for (size_t ii = 0; ii < numberOfValues; ++ii)
+    {
+        destination[ii] = (float)(source[ii] * scaling.scaleFactor + scaling.offset);
+    }
+}
+
+static const float MissingValue = std::numeric_limits<float>::quiet_NaN();
+
+static inline void SetValidityBit(uint8_t* validity, size_t bit, bool isValid)
+{
+    if (isValid)
+    {
+        validity[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+    }
+    else
+    {
+        validity[bit >> 3] &= (uint8_t)~(1 << (bit & 7));
+    }
+}
+
+// Sets the validity bits of numberOfValues values, starting at bit firstBit.
+static void MarkAsValid(uint8_t* validity, size_t firstBit, size_t numberOfValues)
+{
+    size_t ii = 0;
+    for (; ii < numberOfValues && (firstBit + ii) % 8 != 0; ++ii)
+    {
+        SetValidityBit(validity, firstBit + ii, true);
+    }
+    for (; ii + 8 <= numberOfValues; ii += 8)
+    {
+        validity[(firstBit + ii) >> 3] = 0xFF;
+    }
+    for (; ii < numberOfValues; ++ii)
+    {
+        SetValidityBit(validity, firstBit + ii, true);
+    }
+}
+
+static void DecodePackedValuesScalar(const short* source, size_t numberOfValues, const LinearScaling& scaling, const MissingValues& missingValues, float* destination, uint8_t* validity, size_t firstBit)
+{
+    for (size_t ii = 0; ii < numberOfValues; ++ii)
+    {
+        const bool isValid = missingValues.IsValid(source[ii]);
+        destination[ii] = isValid ? (float)(source[ii] * scaling.scaleFactor + scaling.offset) : MissingValue;
+        SetValidityBit(validity, firstBit + ii, isValid);
+    }
+}
+
+// The missing values of a packed variable, expressed as 16-bit integers such that these can be
+//  compared to the packed values directly. Values which are equal to one of the invalidValues,
+//  or lie outside of [minimum, maximum] are missing.
+struct PackedMissingValues
+{
+    static const int MaximumNumberOfInvalidValues = 4;
+
+    short invalidValues[MaximumNumberOfInvalidValues];
+    int numberOfInvalidValues = 0;
+    short minimum = std::numeric_limits<short>::min();
+    short maximum = std::numeric_limits<short>::max();
+};
+
+// Converts the missing values to their packed form.
+//  @return false if this cannot be done, then the scalar version must be used.
+static bool GetPackedMissingValues(const MissingValues& missingValues, PackedMissingValues& result)
+{
+    const double shortMinimum = std::numeric_limits<short>::min();
+    const double shortMaximum = std::numeric_limits<short>::max();
+
+    if (std::isnan(missingValues.validMinimum) || std::isnan(missingValues.validMaximum) ||
+        missingValues.validMinimum > shortMaximum || missingValues.validMaximum < shortMinimum)
+    {
+        return false;
+    }
+    result.minimum = (short)std::max(std::ceil(missingValues.validMinimum), shortMinimum);
+    result.maximum = (short)std::min(std::floor(missingValues.validMaximum), shortMaximum);
+
+    result.numberOfInvalidValues = 0;
+    for (double invalidValue : missingValues.invalidValues)
+    {
+        // Values which are not integers in the range of short can never match a packed value.
+        if (invalidValue != std::floor(invalidValue) || invalidValue < shortMinimum || invalidValue > shortMaximum)
+        {
+            continue;
+        }
+        if (result.numberOfInvalidValues == PackedMissingValues::MaximumNumberOfInvalidValues)
+        {
+            return false;
+        }
+        result.invalidValues[result.numberOfInvalidValues++] = (short)invalidValue;
+    }
+
+    return true;
+}
+
+bool CpuSupportsAvx2()
+{
+#if !defined(NETCDF_USE_SSE2)
+    return false;
+#elif defined(_MSC_VER)
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 0);
+    if (cpuInfo[0] < 7)
+    {
+        return false;
+    }
+
+    // The operating system must also save the AVX registers
+    __cpuid(cpuInfo, 1);
+    const bool osUsesXsave = (cpuInfo[2] & (1 << 27)) != 0;
+    const bool cpuSupportsAvx = (cpuInfo[2] & (1 << 28)) != 0;
+    if (!osUsesXsave || !cpuSupportsAvx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    __cpuidex(cpuInfo, 7, 0);
+    return (cpuInfo[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+#ifdef NETCDF_USE_SSE2
+
+// Converts and scales eight values at a time. The calculations are made in double precision
+//  such that the result is identical to the scalar version.
+static void DecodePackedValuesSse2(const short* source, size_t numberOfValues, const LinearScaling& scaling, float* destination)
+{
+    const __m128d scaleFactor = _mm_set1_pd(scaling.scaleFactor);
+    const __m128d offset = _mm_set1_pd(scaling.offset);
+
+    size_t ii = 0;
+    for (; ii + 8 <= numberOfValues; ii += 8)
+    {
+        const __m128i packed = _mm_loadu_si128((const __m128i*)(source + ii));
+
+        // sign-extend the 16-bit values to 32 bits
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+
+        const __m128d d0 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(low), scaleFactor), offset);
+        const __m128d d1 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2))), scaleFactor), offset);
+        const __m128d d2 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(high), scaleFactor), offset);
+        const __m128d d3 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(high, _MM_SHUFFLE(1, 0, 3, 2))), scaleFactor), offset);
+
+        _mm_storeu_ps(destination + ii, _mm_movelh_ps(_mm_cvtpd_ps(d0), _mm_cvtpd_ps(d1)));
+        _mm_storeu_ps(destination + ii + 4, _mm_movelh_ps(_mm_cvtpd_ps(d2), _mm_cvtpd_ps(d3)));
+    }
+
+    DecodePackedValuesScalar(source + ii, numberOfValues - ii, scaling, destination + ii);
+}
+
+NETCDF_TARGET_AVX2
+static void DecodePackedValuesAvx2(const short* source, size_t numberOfValues, const LinearScaling& scaling, float* destination)
+{
+    const __m256d scaleFactor = _mm256_set1_pd(scaling.scaleFactor);
+    const __m256d offset = _mm256_set1_pd(scaling.offset);
+
+    size_t ii = 0;
+    for (; ii + 8 <= numberOfValues; ii += 8)
+    {
+        const __m256i values = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(source + ii)));
+
+        const __m256d d0 = _mm256_add_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(values)), scaleFactor), offset);
+        const __m256d d1 = _mm256_add_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(values, 1)), scaleFactor), offset);
+
+        _mm_storeu_ps(destination + ii, _mm256_cvtpd_ps(d0));
+        _mm_storeu_ps(destination + ii + 4, _mm256_cvtpd_ps(d1));
+    }
+
+    DecodePackedValuesScalar(source + ii, numberOfValues - ii, scaling, destination + ii);
+}
+
+// @return a mask where each 16-bit lane is set if the corresponding packed value is missing.
+static inline __m128i FindMissingPackedValues(__m128i packed, const PackedMissingValues& missingValues)
+{
+    __m128i missing = _mm_or_si128(
+        _mm_cmplt_epi16(packed, _mm_set1_epi16(missingValues.minimum)),
+        _mm_cmpgt_epi16(packed, _mm_set1_epi16(missingValues.maximum)));
+
+    for (int ii = 0; ii < missingValues.numberOfInvalidValues; ++ii)
+    {
+        missing = _mm_or_si128(missing, _mm_cmpeq_epi16(packed, _mm_set1_epi16(missingValues.invalidValues[ii])));
+    }
+
+    return missing;
+}
+
+// @return the validity bits of eight values, given the mask from FindMissingPackedValues.
+static inline uint8_t ValidityBits(__m128i missing)
+{
+    return (uint8_t)~_mm_movemask_epi8(_mm_packs_epi16(missing, _mm_setzero_si128()));
+}
+
+// Decodes and masks eight values at a time, the first value must start a new byte in the validity bitmap.
+static void DecodePackedValuesSse2(const short* source, size_t numberOfValues, const LinearScaling& scaling, const PackedMissingValues& missingValues, float* destination, uint8_t* validity)
+{
+    const __m128d scaleFactor = _mm_set1_pd(scaling.scaleFactor);
+    const __m128d offset = _mm_set1_pd(scaling.offset);
+    const __m128 missingValue = _mm_set1_ps(MissingValue);
+
+    size_t ii = 0;
+    for (; ii + 8 <= numberOfValues; ii += 8)
+    {
+        const __m128i packed = _mm_loadu_si128((const __m128i*)(source + ii));
+        const __m128i missing = FindMissingPackedValues(packed, missingValues);
+
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+
+        const __m128d d0 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(low), scaleFactor), offset);
+        const __m128d d1 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2))), scaleFactor), offset);
+        const __m128d d2 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(high), scaleFactor), offset);
+        const __m128d d3 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(high, _MM_SHUFFLE(1, 0, 3, 2))), scaleFactor), offset);
+
+        // widen the 16-bit masks to 32 bits and replace the missing values
+        const __m128 lowMissing = _mm_castsi128_ps(_mm_unpacklo_epi16(missing, missing));
+        const __m128 highMissing = _mm_castsi128_ps(_mm_unpackhi_epi16(missing, missing));
+        const __m128 lowValues = _mm_movelh_ps(_mm_cvtpd_ps(d0), _mm_cvtpd_ps(d1));
+        const __m128 highValues = _mm_movelh_ps(_mm_cvtpd_ps(d2), _mm_cvtpd_ps(d3));
+
+        _mm_storeu_ps(destination + ii, _mm_or_ps(_mm_andnot_ps(lowMissing, lowValues), _mm_and_ps(lowMissing, missingValue)));
+        _mm_storeu_ps(destination + ii + 4, _mm_or_ps(_mm_andnot_ps(highMissing, highValues), _mm_and_ps(highMissing, missingValue)));
+
+        validity[ii >> 3] = ValidityBits(missing);
+    }
+}
+
+NETCDF_TARGET_AVX2
+static void DecodePackedValuesAvx2(const short* source, size_t numberOfValues, const LinearScaling& scaling, const PackedMissingValues& missingValues, float* destination, uint8_t* validity)
+{
+    const __m256d scaleFactor = _mm256_set1_pd(scaling.scaleFactor);
+    const __m256d offset = _mm256_set1_pd(scaling.offset);
+    const __m256 missingValue = _mm256_set1_ps(MissingValue);
+
+    size_t ii = 0;
+    for (; ii + 8 <= numberOfValues; ii += 8)
+    {
+        const __m128i packed = _mm_loadu_si128((const __m128i*)(source + ii));
+        const __m128i missing = FindMissingPackedValues(packed, missingValues);
+        const __m256i values = _mm256_cvtepi16_epi32(packed);
+
+        const __m256d d0 = _mm256_add_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(values)), scaleFactor), offset);
+        const __m256d d1 = _mm256_add_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(values, 1)), scaleFactor), offset);
+        const __m256 decoded = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(d0)), _mm256_cvtpd_ps(d1), 1);
+
+        const __m256 isMissing = _mm256_castsi256_ps(_mm256_cvtepi16_epi32(missing));
+        _mm256_storeu_ps(destination + ii, _mm256_blendv_ps(decoded, missingValue, isMissing));
+
+        validity[ii >> 3] = ValidityBits(missing);
+    }
+}
+
+#endif // NETCDF_USE_SSE2
+
+static void DecodePackedValuesSingleThread(const short* source, size_t numberOfValues, const LinearScaling& scaling, float* destination)
+{
+#ifdef NETCDF_USE_SSE2
+    static const bool useAvx2 = CpuSupportsAvx2();
+    if (useAvx2)
+    {
+        DecodePackedValuesAvx2(source, numberOfValues, scaling, destination);
+    }
+    else
+    {
+        DecodePackedValuesSse2(source, numberOfValues, scaling, destination);
+    }
+#else
+    DecodePackedValuesScalar(source, numberOfValues, scaling, destination);
+#endif
+}
+
+static void DecodeAndMaskPackedValuesSingleThread(const short* source, size_t numberOfValues, const LinearScaling& scaling, const MissingValues& missingValues, float* destination, uint8_t* validity, size_t firstBit)
+{
+    // The values before the first full byte of the bitmap are decoded one at a time.
+    const size_t numberOfLeadingValues = std::min((8 - firstBit % 8) % 8, numberOfValues);
+    DecodePackedValuesScalar(source, numberOfLeadingValues, scaling, missingValues, destination, validity, firstBit);
+
+    source += numberOfLeadingValues;
+    destination += numberOfLeadingValues;
+    numberOfValues -= numberOfLeadingValues;
+    firstBit += numberOfLeadingValues;
+
+    size_t numberOfVectorizedValues = 0;
+#ifdef NETCDF_USE_SSE2
+    PackedMissingValues packedMissingValues;
+    if (GetPackedMissingValues(missingValues, packedMissingValues))
+    {
+        static const bool useAvx2 = CpuSupportsAvx2();
+        numberOfVectorizedValues = numberOfValues - numberOfValues % 8;
+        if (useAvx2)
+        {
+            DecodePackedValuesAvx2(source, numberOfVectorizedValues, scaling, packedMissingValues, destination, validity + firstBit / 8);
+        }
+        else
+        {
+            DecodePackedValuesSse2(source, numberOfVectorizedValues, scaling, packedMissingValues, destination, validity + firstBit / 8);
+        }
+    }
+#endif
+
+    DecodePackedValuesScalar(
+        source + numberOfVectorizedValues,
+        numberOfValues - numberOfVectorizedValues,
+        scaling,
+        missingValues,
+        destination + numberOfVectorizedValues,
+        validity,
+        firstBit + numberOfVectorizedValues);
+}
+
+void DecodePackedValues(const short* source, size_t numberOfValues, const LinearScaling& scaling, float* destination)
+{
+    const size_t maximumNumberOfThreads = std::max((size_t)std::thread::hardware_concurrency(), (size_t)1);
+    const size_t numberOfThreads = std::min(maximumNumberOfThreads, numberOfValues / MinimumValuesPerThread);
+
+    if (numberOfThreads <= 1)
+    {
+        DecodePackedValuesSingleThread(source, numberOfValues, scaling, destination);
+        return;
+    }
+
+    // Split the values into one contiguous range per thread, this thread takes the last range.
+    const size_t valuesPerThread = numberOfValues / numberOfThreads;
+    std::vector<std::thread> threads;
+    for (size_t threadIdx = 0; threadIdx + 1 < numberOfThreads; ++threadIdx)
+    {
+        const size_t first = threadIdx * valuesPerThread;
+        threads.push_back(std::thread(DecodePackedValuesSingleThread, source + first, valuesPerThread, std::cref(scaling), destination + first));
+    }
+
+    const size_t first = (numberOfThreads - 1) * valuesPerThread;
+    DecodePackedValuesSingleThread(source + first, numberOfValues - first, scaling, destination + first);
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void DecodePackedValues(const short* source, size_t numberOfValues, const LinearScaling& scaling, const MissingValues& missingValues, float* destination, uint8_t* validity, size_t firstBit)
+{
+    if (missingValues.IsEmpty())
+    {
+        DecodePackedValues(source, numberOfValues, scaling, destination);
+        MarkAsValid(validity, firstBit, numberOfValues);
+        return;
+    }
+
+    const size_t maximumNumberOfThreads = std::max((size_t)std::thread::hardware_concurrency(), (size_t)1);
+    const size_t numberOfThreads = std::min(maximumNumberOfThreads, numberOfValues / MinimumValuesPerThread);
+
+    if (numberOfThreads <= 1)
+    {
+        DecodeAndMaskPackedValuesSingleThread(source, numberOfValues, scaling, missingValues, destination, validity, firstBit);
+        return;
+    }
+
+    // The ranges of the threads must start at a new byte in the validity bitmap,
+    //  such that no two threads write to the same byte.
+    const size_t firstAlignedValue = (8 - firstBit % 8) % 8;
+    const size_t valuesPerThread = ((numberOfValues - firstAlignedValue) / numberOfThreads) & ~(size_t)7;
+
+    std::vector<std::thread> threads;
+    size_t first = 0;
+    for (size_t threadIdx = 0; threadIdx + 1 < numberOfThreads; ++threadIdx)
+    {
+        const size_t next = firstAlignedValue + (threadIdx + 1) * valuesPerThread;
+        threads.push_back(std::thread(DecodeAndMaskPackedValuesSingleThread, source + first, next - first, std::cref(scaling), std::cref(missingValues), destination + first, validity, firstBit + first));
+        first = next;
+    }
+
+    DecodeAndMaskPackedValuesSingleThread(source + first, numberOfValues - first, scaling, missingValues, destination + first, validity, firstBit + first);
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void ApplyLinearScaling(std::vector<float>& values, const LinearScaling& scaling)
+{
+    ApplyLinearScaling(values.data(), values.size(), scaling);
+}
+
+void ApplyLinearScaling(float* values, size_t numberOfValues, const LinearScaling& scaling)
+{
+    for (size_t ii = 0; ii < numberOfValues; ++ii)
+    {
+        values[ii] = (float)(values[ii] * scaling.scaleFactor + scaling.offset);
+    }
+}
+
+void ApplyLinearScaling(std::vector<float>& values, const LinearScaling& scaling, const MissingValues& missingValues, uint8_t* validity)
+{
+    ApplyLinearScaling(values.data(), values.size(), scaling, missingValues, validity);
+}
+
+void ApplyLinearScaling(float* values, size_t numberOfValues, const LinearScaling& scaling, const MissingValues& missingValues, uint8_t* validity)
+{
+    for (size_t ii = 0; ii < numberOfValues; ++ii)
+    {
+        const bool isValid = missingValues.IsValid(values[ii]);
+        values[ii] = isValid ? (float)(values[ii] * scaling.scaleFactor + scaling.offset) : MissingValue;
+        SetValidityBit(validity, ii, isValid);
+    }
+}
+
+void ApplyLinearScaling(const double* source, size_t numberOfValues, const LinearScaling& scaling, const MissingValues& missingValues, float* destination, uint8_t* validity)
+{
+    for (size_t ii = 0; ii < numberOfValues; ++ii)
+    {
+        const bool isValid = missingValues.IsValid(source[ii]);
+        destination[ii] = isValid ? (float)(source[ii] * scaling.scaleFactor + scaling.offset) : MissingValue;
+        SetValidityBit(validity, ii, isValid);
+    }
+}
+
+void CopyValidityBits(const uint8_t* source, size_t numberOfValues, uint8_t* destination, size_t firstDestinationBit)
+{
+    if (firstDestinationBit % 8 == 0)
+    {
+        // Whole bytes can be copied directly, only the last byte needs to be merged.
+        const size_t numberOfFullBytes = numberOfValues / 8;
+        std::copy(source, source + numberOfFullBytes, destination + firstDestinationBit / 8);
+        firstDestinationBit += numberOfFullBytes * 8;
+        source += numberOfFullBytes;
+        numberOfValues -= numberOfFullBytes * 8;
+    }
+
+    for (size_t ii = 0; ii < numberOfValues; ++ii)
+    {
+        SetValidityBit(destination, firstDestinationBit + ii, ((source[ii >> 3] >> (ii & 7)) & 1) != 0);
+    }
+}
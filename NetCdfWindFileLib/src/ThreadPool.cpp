@@ -0,0 +1,52 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t numberOfThreads)
+{
+    if (numberOfThreads == 0)
+    {
+        numberOfThreads = std::max((size_t)std::thread::hardware_concurrency(), (size_t)1);
+    }
+
+    for (size_t threadIdx = 0; threadIdx < numberOfThreads; ++threadIdx)
+    {
+        m_threads.push_back(std::thread(&ThreadPool::RunTasks, this));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_taskAdded.notify_all();
+
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::RunTasks()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskAdded.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+
+            // The remaining tasks are completed before the threads stop.
+            if (m_tasks.empty())
+            {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        task();
+    }
+}
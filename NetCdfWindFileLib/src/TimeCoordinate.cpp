@@ -0,0 +1,210 @@
+#include "TimeCoordinate.h"
+#include <netcdf.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+// @return the number of days from 1970-01-01 to the provided date in the proleptic Gregorian calendar.
+static long long DaysSinceEpoch(long long year, long long month, long long day)
+{
+    // Count the years from March, such that the leap day comes last in the year.
+    year -= (month <= 2) ? 1 : 0;
+    const long long era = (year >= 0 ? year : year - 399) / 400;
+    const long long yearOfEra = year - era * 400;
+    const long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static void ThrowParseError(const std::string& text, const char* what)
+{
+    std::stringstream msg;
+    msg << "Failed to parse the time '" << text << "'. " << what;
+    throw NetCdfException(msg.str().c_str(), NC_EINVAL);
+}
+
+static void SkipWhitespace(const char*& position)
+{
+    while (*position == ' ' || *position == '\t')
+    {
+        ++position;
+    }
+}
+
+// Reads an unsigned integer at the current position, @return false if there are no digits.
+static bool ReadInteger(const char*& position, long long& value)
+{
+    if (!std::isdigit((unsigned char)*position))
+    {
+        return false;
+    }
+
+    char* end = nullptr;
+    value = std::strtoll(position, &end, 10);
+    position = end;
+    return true;
+}
+
+double ParseDateTime(const std::string& dateTime)
+{
+    const char* position = dateTime.c_str();
+    SkipWhitespace(position);
+
+    long long year = 0, month = 0, day = 0;
+    if (!ReadInteger(position, year) || *position++ != '-' ||
+        !ReadInteger(position, month) || *position++ != '-' ||
+        !ReadInteger(position, day))
+    {
+        ThrowParseError(dateTime, "The date must be given as yyyy-mm-dd.");
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31)
+    {
+        ThrowParseError(dateTime, "The date is not valid.");
+    }
+
+    double secondsOfDay = 0.0;
+    if (*position == 'T')
+    {
+        ++position;
+    }
+    SkipWhitespace(position);
+
+    long long hour = 0, minute = 0;
+    if (ReadInteger(position, hour))
+    {
+        if (*position++ != ':' || !ReadInteger(position, minute))
+        {
+            ThrowParseError(dateTime, "The time must be given as hh:mm or hh:mm:ss.");
+        }
+
+        double second = 0.0;
+        if (*position == ':')
+        {
+            ++position;
+            char* end = nullptr;
+            second = std::strtod(position, &end);
+            if (end == position)
+            {
+                ThrowParseError(dateTime, "The time must be given as hh:mm or hh:mm:ss.");
+            }
+            position = end;
+        }
+        if (hour > 24 || minute > 59 || second < 0.0 || second >= 61.0)
+        {
+            ThrowParseError(dateTime, "The time is not valid.");
+        }
+
+        secondsOfDay = hour * 3600.0 + minute * 60.0 + second;
+    }
+
+    // The time zone
+    SkipWhitespace(position);
+    double timeZoneOffset = 0.0;
+    if (*position == 'Z')
+    {
+        ++position;
+    }
+    else if (std::strncmp(position, "UTC", 3) == 0 || std::strncmp(position, "GMT", 3) == 0)
+    {
+        position += 3;
+    }
+    else if (*position == '+' || *position == '-')
+    {
+        const double sign = (*position++ == '-') ? -1.0 : 1.0;
+        long long offsetHours = 0, offsetMinutes = 0;
+        if (!ReadInteger(position, offsetHours))
+        {
+            ThrowParseError(dateTime, "The time zone is not valid.");
+        }
+        if (*position == ':')
+        {
+            ++position;
+            if (!ReadInteger(position, offsetMinutes))
+            {
+                ThrowParseError(dateTime, "The time zone is not valid.");
+            }
+        }
+        timeZoneOffset = sign * (offsetHours * 3600.0 + offsetMinutes * 60.0);
+    }
+
+    SkipWhitespace(position);
+    if (*position != '\0')
+    {
+        ThrowParseError(dateTime, "Unexpected characters after the time.");
+    }
+
+    return (double)DaysSinceEpoch(year, month, day) * 86400.0 + secondsOfDay - timeZoneOffset;
+}
+
+TimeUnits ParseTimeUnits(const std::string& units)
+{
+    std::istringstream stream(units);
+    std::string unit, since;
+    stream >> unit >> since;
+
+    std::transform(unit.begin(), unit.end(), unit.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+    std::transform(since.begin(), since.end(), since.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+
+    TimeUnits result;
+    if (unit == "seconds" || unit == "second" || unit == "secs" || unit == "sec" || unit == "s")
+    {
+        result.secondsPerUnit = 1.0;
+    }
+    else if (unit == "minutes" || unit == "minute" || unit == "mins" || unit == "min")
+    {
+        result.secondsPerUnit = 60.0;
+    }
+    else if (unit == "hours" || unit == "hour" || unit == "hrs" || unit == "hr" || unit == "h")
+    {
+        result.secondsPerUnit = 3600.0;
+    }
+    else if (unit == "days" || unit == "day" || unit == "d")
+    {
+        result.secondsPerUnit = 86400.0;
+    }
+    else
+    {
+        std::stringstream msg;
+        msg << "Failed to parse the time units '" << units << "'. The unit '" << unit << "' is not supported.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVAL);
+    }
+
+    if (since != "since")
+    {
+        std::stringstream msg;
+        msg << "Failed to parse the time units '" << units << "'. The units must be on the form '<unit> since <date>'.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVAL);
+    }
+
+    std::string referenceTime;
+    std::getline(stream, referenceTime);
+    result.referenceTime = ParseDateTime(referenceTime);
+
+    return result;
+}
+
+TimeCoordinate::TimeCoordinate(std::vector<double> values, const TimeUnits& units)
+    : m_values(std::move(values)), m_units(units)
+{
+    if (!std::is_sorted(m_values.begin(), m_values.end()))
+    {
+        throw NetCdfException("The values of the time coordinate are not sorted in increasing order.", NC_EINVAL);
+    }
+}
+
+TimeRange TimeCoordinate::FindRange(double firstTime, double lastTime) const
+{
+    // Convert the window into the units of the file, such that the values can be searched directly.
+    const double first = (firstTime - m_units.referenceTime) / m_units.secondsPerUnit;
+    const double last = (lastTime - m_units.referenceTime) / m_units.secondsPerUnit;
+
+    TimeRange range;
+    const auto begin = std::lower_bound(m_values.begin(), m_values.end(), first);
+    const auto end = std::upper_bound(begin, m_values.end(), last);
+
+    range.first = (size_t)(begin - m_values.begin());
+    range.count = (size_t)(end - begin);
+    return range;
+}
@@ -1,44 +1,304 @@
 #include <WindFieldInterpolation.h>
+#include <MappedNetCdfFile.h>
+#include <LazyNetCdfTensor.h>
+#include <ThreadPool.h>
 #include <assert.h>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <sstream>
+
+// Copies the eight values of a 2x2x2 cube into a fixed size array.
+template<class T>
+static std::array<T, 8> ToCubeArray(const std::vector<T>& values)
+{
+    assert(values.size() == 8);
+
+    std::array<T, 8> cube;
+    std::copy(values.begin(), values.begin() + 8, cube.begin());
+    return cube;
+}
 
 EstimatedValue TriLinearInterpolation(const std::vector<double>& inputCube, double idxX, double idxY, double idxZ)
 {
-    double c00 = inputCube[0] * (1.0 - idxZ) + inputCube[1] * idxZ;
-    double c01 = inputCube[2] * (1.0 - idxZ) + inputCube[3] * idxZ;
-    double c10 = inputCube[4] * (1.0 - idxZ) + inputCube[5] * idxZ;
-    double c11 = inputCube[6] * (1.0 - idxZ) + inputCube[7] * idxZ;
+    return MultiLinearInterpolation<3>(ToCubeArray(inputCube), { idxX, idxY, idxZ });
+}
+
+EstimatedValue TriLinearInterpolation(const std::vector<double>& inputCube, const std::vector<bool>& validCorners, double idxX, double idxY, double idxZ)
+{
+    CornerValidity<3> valid;
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        valid[cornerIdx] = validCorners[cornerIdx];
+    }
+    return MultiLinearInterpolation<3>(ToCubeArray(inputCube), valid, { idxX, idxY, idxZ });
+}
+
+// Plain vectors, and views into memory mapped files, do not carry any information on missing values.
+template<class TensorType>
+inline bool IsValidValue(const TensorType&, size_t)
+{
+    return true;
+}
 
-    double c0 = c00 * (1.0 - idxY) + c01 * idxY;
-    double c1 = c10 * (1.0 - idxY) + c11 * idxY;
+inline bool IsValidValue(const NetCdfTensor& tensor, size_t index)
+{
+    return tensor.IsValid(index);
+}
 
-    EstimatedValue result;
-    result.value = c0 * (1.0 - idxX) + c1 * idxX;
-    result.uncertainty = c1 - c0;
-    return result;
+inline bool IsValidValue(const PackedNetCdfTensor& tensor, size_t index)
+{
+    return tensor.IsValid(index);
 }
 
-void SelectCubeValues(const std::vector<float>& tensor, const std::vector<size_t>& tensorDimensions, const std::vector<size_t>& floorIdx, std::vector<double>& corners)
+inline bool IsValidValue(const LazyNetCdfTensor& tensor, size_t index)
 {
-    assert(corners.size() == 8);
+    return tensor.IsValid(index);
+}
 
-    const size_t timeDim = 0;
-    const size_t lvlDim = 1;
+// Calculates the offsets of the 2x2x2 values surrounding the point from the start of one time step in the tensor.
+//  The offsets are ordered as CornerValues<3>, the values of time step t are then found at t * timeStride + offset.
+//  The cube never wraps around the longitude, a neighbourhood on a periodic grid is instead read
+//  as one contiguous cube by NetCdfFileReader::ReadNeighbourhood.
+static std::array<size_t, 8> GetCornerOffsets(const std::vector<size_t>& tensorDimensions, const std::array<size_t, 3>& floorIdx)
+{
     const size_t latDim = 2;
     const size_t lonDim = 3;
 
-    // ----------- Pick out the neighoring u- and v- values at this point in time -----------
-    // -----------      this is a small cube with 2x2x2 values     -----------
-    for (size_t lvlIdx = floorIdx[lvlDim]; lvlIdx <= floorIdx[lvlDim] + 1; ++lvlIdx)
+    std::array<size_t, 8> offsets;
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
     {
-        for (size_t latIdx = floorIdx[latDim]; latIdx <= floorIdx[latDim] + 1; ++latIdx)
+        const size_t lvlIdx = floorIdx[0] + ((cornerIdx >> 2) & 1);
+        const size_t latIdx = floorIdx[1] + ((cornerIdx >> 1) & 1);
+        const size_t lonIdx = floorIdx[2] + (cornerIdx & 1);
+
+        offsets[cornerIdx] = (lvlIdx * tensorDimensions[latDim] + latIdx) * tensorDimensions[lonDim] + lonIdx;
+    }
+
+    return offsets;
+}
+
+// Calculates the indices of the first corner of the 2x2x2 cube surrounding the point.
+//  A point exactly on the last grid line uses the cube ending at that line.
+//  @throws invalid_argument if the point lies outside of the tensor.
+static std::array<size_t, 3> GetFloorIndices(const std::vector<size_t>& tensorDimensions, const std::vector<double>& spatialIndices, const char* functionName)
+{
+    std::array<size_t, 3> floorIdx;
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+        const size_t dimensionLength = tensorDimensions[ii + 1];
+        if (dimensionLength < 2 || !(spatialIndices[ii] >= 0.0) || spatialIndices[ii] > (double)(dimensionLength - 1))
         {
-            for (size_t lonIdx = floorIdx[lonDim]; lonIdx <= floorIdx[lonDim] + 1; ++lonIdx)
+            std::stringstream msg;
+            msg << "Invalid data to " << functionName << ", the index " << spatialIndices[ii] << " lies outside of spatial dimension " << ii << ".";
+            throw new std::invalid_argument(msg.str());
+        }
+        floorIdx[ii] = std::min((size_t)std::floor(spatialIndices[ii]), dimensionLength - 2);
+    }
+    return floorIdx;
+}
+
+// Picks out the 2x2x2 values surrounding the point at one time step from the tensor
+//  and stores them at index batchIdx of the batch of corners.
+//  TensorType can be any type where the (flattened) values can be accessed using operator[].
+//  @param timeOffset The index of the first value of the time step in the tensor.
+//  @return true if all the corners are valid.
+template<class TensorType>
+bool SelectCubeValues(const TensorType& tensor, size_t timeOffset, const std::array<size_t, 8>& cornerOffsets, CornerBatch<3>& corners, size_t batchIdx)
+{
+    bool allCornersAreValid = true;
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        const size_t index = timeOffset + cornerOffsets[cornerIdx];
+        corners[cornerIdx][batchIdx] = tensor[index];
+        allCornersAreValid = allCornersAreValid && IsValidValue(tensor, index);
+    }
+    return allCornersAreValid;
+}
+
+// @return the validity of each of the 2x2x2 values surrounding the point at one time step, see SelectCubeValues.
+template<class TensorType>
+CornerValidity<3> GetCornerValidity(const TensorType& tensor, size_t timeOffset, const std::array<size_t, 8>& cornerOffsets)
+{
+    CornerValidity<3> validCorners;
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        validCorners[cornerIdx] = IsValidValue(tensor, timeOffset + cornerOffsets[cornerIdx]);
+    }
+    return validCorners;
+}
+
+// @return the corners of the cube at index batchIdx of the batch.
+static CornerValues<3> GetCube(const CornerBatch<3>& corners, size_t batchIdx)
+{
+    CornerValues<3> cube;
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        cube[cornerIdx] = corners[cornerIdx][batchIdx];
+    }
+    return cube;
+}
+
+// The time steps are processed in batches of InterpolationBatchSize consecutive time steps.
+//  The corners of all the time steps of a batch are first picked out of the tensors, then the
+//  wind speeds and the interpolation are calculated for the whole batch at once (see InterpolationKernels.h).
+//  The few time steps where any corner is missing are then interpolated again, one at a time.
+//  Only the time steps [firstTimeStep, firstTimeStep + numberOfTimeSteps) of u and v are interpolated,
+//  these are written to the same indices in the result, offset by firstTimeIndex.
+//  The result is only resized if it is too short, such that ranges which have room in the result
+//  can be interpolated in parallel.
+template<class TensorType>
+void InterpolateWindAtTimeSteps(
+    const TensorType& u,
+    const TensorType& v,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    size_t firstTimeStep,
+    size_t numberOfTimeSteps,
+    size_t firstTimeIndex,
+    InterpolatedWind& result)
+{
+    if (sizes.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateWind, the data must be four-dimensional.");
+    if (spatialIndices.size() != 3) throw new std::invalid_argument("Invalid data to InterpolateWind, there must be three spatial dimensions.");
+
+    const std::array<size_t, 3> floorIdx = GetFloorIndices(sizes, spatialIndices, "InterpolateWind");
+
+    const std::array<size_t, 8> cornerOffsets = GetCornerOffsets(sizes, floorIdx);
+    const size_t timeStride = sizes[1] * sizes[2] * sizes[3];
+    const CubePosition<3> position = { { spatialIndices[0] - floorIdx[0], spatialIndices[1] - floorIdx[1], spatialIndices[2] - floorIdx[2] } };
+
+    // make sure that there is room for the time steps of this block in the result
+    const size_t endOfTimeRange = firstTimeStep + numberOfTimeSteps;
+    const size_t requiredLength = firstTimeIndex + endOfTimeRange;
+    if (result.speed.size() < requiredLength) result.speed.resize(requiredLength);
+    if (result.speedError.size() < requiredLength) result.speedError.resize(requiredLength);
+    if (result.direction.size() < requiredLength) result.direction.resize(requiredLength);
+    if (result.directionError.size() < requiredLength) result.directionError.resize(requiredLength);
+
+    // temporary variables in the loop below, these live on the stack.
+    CornerBatch<3> uValues;
+    CornerBatch<3> vValues;
+    CornerBatch<3> windSpeedTemp;
+    CornerBatch<3> windDirTemp;
+    std::array<bool, InterpolationBatchSize> allCornersAreValid;
+
+    // Dimensions are [time, level, latitude, longitude]
+    for (size_t batchStart = firstTimeStep; batchStart < endOfTimeRange; batchStart += InterpolationBatchSize)
+    {
+        const size_t batchLength = std::min(InterpolationBatchSize, endOfTimeRange - batchStart);
+
+        // ----------- Pick out the neighoring u- and v- values at each point in time of the batch -----------
+        // -----------      this is a small cube with 2x2x2 values per time step     -----------
+        bool batchIsValid = true;
+        for (size_t ii = 0; ii < batchLength; ++ii)
+        {
+            const size_t timeOffset = (batchStart + ii) * timeStride;
+            const bool uIsValid = SelectCubeValues(u, timeOffset, cornerOffsets, uValues, ii);
+            const bool vIsValid = SelectCubeValues(v, timeOffset, cornerOffsets, vValues, ii);
+            allCornersAreValid[ii] = uIsValid && vIsValid;
+            batchIsValid = batchIsValid && allCornersAreValid[ii];
+        }
+
+        // Calculate the wind-speed and wind-direction at each corner in the cubes
+        CalculateWindSpeedAndDirection(uValues, vValues, batchLength, windSpeedTemp, windDirTemp);
+
+        // Now perform a tri-linear interpolation inside the cubes with wind-speed values to calculate
+        //  the inerpolated wind-speed.
+        const size_t resultIdx = firstTimeIndex + batchStart;
+        TriLinearInterpolation(windSpeedTemp, batchLength, position, result.speed.data() + resultIdx, result.speedError.data() + resultIdx);
+        TriLinearInterpolation(windDirTemp, batchLength, position, result.direction.data() + resultIdx, result.directionError.data() + resultIdx);
+
+        if (batchIsValid)
+        {
+            continue;
+        }
+
+        // Corners where either u or v is missing are left out.
+        for (size_t ii = 0; ii < batchLength; ++ii)
+        {
+            if (allCornersAreValid[ii])
             {
-                size_t index = ((floorIdx[timeDim] * tensorDimensions[lvlDim] + lvlIdx) * tensorDimensions[latDim] + latIdx) * tensorDimensions[lonDim] + lonIdx;
+                continue;
+            }
+
+            const size_t timeOffset = (batchStart + ii) * timeStride;
+            CornerValidity<3> validCorners = GetCornerValidity(u, timeOffset, cornerOffsets);
+            const CornerValidity<3> vValid = GetCornerValidity(v, timeOffset, cornerOffsets);
+            for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+            {
+                validCorners[cornerIdx] = validCorners[cornerIdx] && vValid[cornerIdx];
+            }
 
-                size_t minorIndex = ((lvlIdx - floorIdx[lvlDim]) * 2 + (latIdx - floorIdx[latDim])) * 2 + (lonIdx - floorIdx[lonDim]);
+            const EstimatedValue interpSpeed = MultiLinearInterpolation<3>(GetCube(windSpeedTemp, ii), validCorners, position);
+            const EstimatedValue interpDirection = MultiLinearInterpolation<3>(GetCube(windDirTemp, ii), validCorners, position);
 
-                corners[minorIndex] = tensor[index];
+            result.speed[resultIdx + ii] = interpSpeed.value;
+            result.speedError[resultIdx + ii] = interpSpeed.uncertainty;
+            result.direction[resultIdx + ii] = interpDirection.value;
+            result.directionError[resultIdx + ii] = interpDirection.uncertainty;
+        }
+    }
+}
+
+// Interpolates the values in batches of time steps, in the same way as InterpolateWindAtTimeSteps.
+template<class TensorType>
+void InterpolateValueAtTimeSteps(
+    const TensorType& values,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    size_t firstTimeStep,
+    size_t numberOfTimeSteps,
+    size_t firstTimeIndex,
+    std::vector<double>& result)
+{
+    if (sizes.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateValue, the data must be four-dimensional.");
+    if (spatialIndices.size() != 3) throw new std::invalid_argument("Invalid data to InterpolateValue, there must be three spatial dimensions.");
+
+    const std::array<size_t, 3> floorIdx = GetFloorIndices(sizes, spatialIndices, "InterpolateValue");
+
+    const std::array<size_t, 8> cornerOffsets = GetCornerOffsets(sizes, floorIdx);
+    const size_t timeStride = sizes[1] * sizes[2] * sizes[3];
+    const CubePosition<3> position = { { spatialIndices[0] - floorIdx[0], spatialIndices[1] - floorIdx[1], spatialIndices[2] - floorIdx[2] } };
+
+    // make sure that there is room for the time steps of this block in the result
+    const size_t endOfTimeRange = firstTimeStep + numberOfTimeSteps;
+    if (result.size() < firstTimeIndex + endOfTimeRange)
+    {
+        result.resize(firstTimeIndex + endOfTimeRange);
+    }
+
+    // temporary variables in the loop below, these live on the stack.
+    CornerBatch<3> unitCubeValues;
+    std::array<bool, InterpolationBatchSize> allCornersAreValid;
+
+    // Dimensions are [time, level, latitude, longitude]
+    for (size_t batchStart = firstTimeStep; batchStart < endOfTimeRange; batchStart += InterpolationBatchSize)
+    {
+        const size_t batchLength = std::min(InterpolationBatchSize, endOfTimeRange - batchStart);
+
+        // ----------- Pick out the neighoring values at each point in time of the batch -----------
+        bool batchIsValid = true;
+        for (size_t ii = 0; ii < batchLength; ++ii)
+        {
+            allCornersAreValid[ii] = SelectCubeValues(values, (batchStart + ii) * timeStride, cornerOffsets, unitCubeValues, ii);
+            batchIsValid = batchIsValid && allCornersAreValid[ii];
+        }
+
+        // Now perform a tri-linear interpolation inside the cubes to calculate the interpolated values
+        const size_t resultIdx = firstTimeIndex + batchStart;
+        TriLinearInterpolation(unitCubeValues, batchLength, position, result.data() + resultIdx, nullptr);
+
+        if (batchIsValid)
+        {
+            continue;
+        }
+
+        for (size_t ii = 0; ii < batchLength; ++ii)
+        {
+            if (!allCornersAreValid[ii])
+            {
+                const CornerValidity<3> validCorners = GetCornerValidity(values, (batchStart + ii) * timeStride, cornerOffsets);
+                result[resultIdx + ii] = MultiLinearInterpolation<3>(GetCube(unitCubeValues, ii), validCorners, position).value;
             }
         }
     }
@@ -52,103 +312,340 @@ void InterpolateWind(
     InterpolatedWind& result)
 {
     if (sizes.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateWind, the data must be four-dimensional.");
-    if (spatialIndices.size() != 3) throw new std::invalid_argument("Invalid data to InterpolateWind, there must be three spatial dimensions.");
 
-    // defining the dimensions
-    const size_t timeDim = 0;
-    const size_t lvlDim = 1;
-    const size_t latDim = 2;
-    const size_t lonDim = 3;
+    result.speed.resize(sizes[0]);
+    result.speedError.resize(sizes[0]);
+    result.direction.resize(sizes[0]);
+    result.directionError.resize(sizes[0]);
+
+    InterpolateWindAtTimeSteps(u, v, sizes, spatialIndices, 0, sizes[0], 0, result);
+}
 
-    const size_t lvlFloor = (size_t)std::floor(spatialIndices[0]);
-    const size_t latFloor = (size_t)std::floor(spatialIndices[1]);
-    const size_t lonFloor = (size_t)std::floor(spatialIndices[2]);
+void InterpolateWind(
+    const std::vector<float>& u,
+    const std::vector<float>& v,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    size_t firstTimeIndex,
+    InterpolatedWind& result)
+{
+    if (sizes.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateWind, the data must be four-dimensional.");
 
-    std::vector<size_t> floorIdx = { 0, lvlFloor, latFloor, lonFloor };
+    InterpolateWindAtTimeSteps(u, v, sizes, spatialIndices, 0, sizes[0], firstTimeIndex, result);
+}
 
-    std::vector<double> finalWindSpeeds(sizes[timeDim]);
-    std::vector<double> finalWindSpeedErrors(sizes[timeDim]);
-    std::vector<double> finalWindDirections(sizes[timeDim]);
-    std::vector<double> finalWindDirectionErrors(sizes[timeDim]);
+// Performs the interpolation for all time steps of u and v, which must be of the same size.
+template<class TensorType>
+void InterpolateWindAtAllTimeSteps(
+    const TensorType& u,
+    const TensorType& v,
+    const std::vector<double>& spatialIndices,
+    InterpolatedWind& result)
+{
+    if (u.size != v.size) throw new std::invalid_argument("Invalid data to InterpolateWind, u and v must have the same size.");
+    if (u.size.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateWind, the data must be four-dimensional.");
 
-    // temporary variables in the loop below.
-    std::vector<double> uValues(8);
-    std::vector<double> vValues(8);
-    std::vector<double> windSpeedTemp(8);
-    std::vector<double> windDirTemp(8);
+    result.speed.resize(u.size[0]);
+    result.speedError.resize(u.size[0]);
+    result.direction.resize(u.size[0]);
+    result.directionError.resize(u.size[0]);
 
-    // Dimensions are [time, level, latitude, longitude]
-    for (size_t timeIdx = 0; timeIdx < sizes[timeDim]; ++timeIdx)
-    {
-        floorIdx[timeDim] = timeIdx;
+    InterpolateWindAtTimeSteps(u, v, u.size, spatialIndices, 0, u.size[0], 0, result);
+}
 
-        // ----------- Pick out the neighoring u- and v- values at this point in time -----------
-        // -----------      this is a small cube with 2x2x2 values     -----------
-        SelectCubeValues(u, sizes, floorIdx, uValues);
-        SelectCubeValues(v, sizes, floorIdx, vValues);
+void InterpolateWind(
+    const NetCdfTensor& u,
+    const NetCdfTensor& v,
+    const std::vector<double>& spatialIndices,
+    InterpolatedWind& result)
+{
+    InterpolateWindAtAllTimeSteps(u, v, spatialIndices, result);
+}
 
-        // Calculate the wind-speed and wind-direction at each corner in the cube
-        for (size_t ii = 0; ii < 8; ++ii)
-        {
-            windSpeedTemp[ii] = std::sqrt(uValues[ii] * uValues[ii] + vValues[ii] * vValues[ii]);
-            windDirTemp[ii] = 180.0 * std::atan2(-uValues[ii], -vValues[ii]) / 3.14159265358979323846;
-        }
+void InterpolateWind(
+    const PackedNetCdfTensor& u,
+    const PackedNetCdfTensor& v,
+    const std::vector<double>& spatialIndices,
+    InterpolatedWind& result)
+{
+    InterpolateWindAtAllTimeSteps(u, v, spatialIndices, result);
+}
 
-        // Now perform a tri-linear interpolation inside this cube with wind-speed values to calculate
-        //  the inerpolated wind-speed
-        auto interpSpeed = TriLinearInterpolation(windSpeedTemp, spatialIndices[0] - lvlFloor, spatialIndices[1] - latFloor, spatialIndices[2] - lonFloor);
-        auto interpDirection = TriLinearInterpolation(windDirTemp, spatialIndices[0] - lvlFloor, spatialIndices[1] - latFloor, spatialIndices[2] - lonFloor);
+void InterpolateWind(
+    const MappedNetCdfVariable& u,
+    const MappedNetCdfVariable& v,
+    const std::vector<double>& spatialIndices,
+    InterpolatedWind& result)
+{
+    InterpolateWindAtAllTimeSteps(u, v, spatialIndices, result);
+}
 
-        finalWindSpeeds[timeIdx] = interpSpeed.value;
-        finalWindSpeedErrors[timeIdx] = interpSpeed.uncertainty;
-        finalWindDirections[timeIdx] = interpDirection.value;
-        finalWindDirectionErrors[timeIdx] = interpDirection.uncertainty;
-    }
+void InterpolateWind(
+    const LazyNetCdfTensor& u,
+    const LazyNetCdfTensor& v,
+    const std::vector<double>& spatialIndices,
+    InterpolatedWind& result)
+{
+    InterpolateWindAtAllTimeSteps(u, v, spatialIndices, result);
+}
+
+void InterpolateValue(
+    const std::vector<float>& values,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    std::vector<double>& result)
+{
+    if (sizes.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateValue, the data must be four-dimensional.");
+
+    result.resize(sizes[0]);
 
-    result.speed = finalWindSpeeds;
-    result.speedError = finalWindSpeedErrors;
-    result.direction = finalWindDirections;
-    result.directionError = finalWindDirectionErrors;
+    InterpolateValueAtTimeSteps(values, sizes, spatialIndices, 0, sizes[0], 0, result);
 }
 
 void InterpolateValue(
     const std::vector<float>& values,
     const std::vector<size_t>& sizes,
     const std::vector<double>& spatialIndices,
+    size_t firstTimeIndex,
     std::vector<double>& result)
 {
     if (sizes.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateValue, the data must be four-dimensional.");
-    if (spatialIndices.size() != 3) throw new std::invalid_argument("Invalid data to InterpolateValue, there must be three spatial dimensions.");
 
-    // defining the dimensions
-    const size_t timeDim = 0;
-    const size_t lvlDim = 1;
-    const size_t latDim = 2;
-    const size_t lonDim = 3;
+    InterpolateValueAtTimeSteps(values, sizes, spatialIndices, 0, sizes[0], firstTimeIndex, result);
+}
+
+// Performs the interpolation for all time steps of the values.
+template<class TensorType>
+void InterpolateValueAtAllTimeSteps(
+    const TensorType& values,
+    const std::vector<double>& spatialIndices,
+    std::vector<double>& result)
+{
+    if (values.size.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateValue, the data must be four-dimensional.");
 
-    const size_t lvlFloor = (size_t)std::floor(spatialIndices[0]);
-    const size_t latFloor = (size_t)std::floor(spatialIndices[1]);
-    const size_t lonFloor = (size_t)std::floor(spatialIndices[2]);
+    result.resize(values.size[0]);
 
-    std::vector<size_t> floorIdx = { 0, lvlFloor, latFloor, lonFloor };
+    InterpolateValueAtTimeSteps(values, values.size, spatialIndices, 0, values.size[0], 0, result);
+}
 
-    result.resize(sizes[timeDim]);
+void InterpolateValue(
+    const NetCdfTensor& values,
+    const std::vector<double>& spatialIndices,
+    std::vector<double>& result)
+{
+    InterpolateValueAtAllTimeSteps(values, spatialIndices, result);
+}
 
-    // temporary variable in the loop below.
-    std::vector<double> unitCubeValues(8);
+void InterpolateValue(
+    const PackedNetCdfTensor& values,
+    const std::vector<double>& spatialIndices,
+    std::vector<double>& result)
+{
+    InterpolateValueAtAllTimeSteps(values, spatialIndices, result);
+}
 
-    // Dimensions are [time, level, latitude, longitude]
-    for (size_t timeIdx = 0; timeIdx < sizes[timeDim]; ++timeIdx)
+void InterpolateValue(
+    const MappedNetCdfVariable& values,
+    const std::vector<double>& spatialIndices,
+    std::vector<double>& result)
+{
+    InterpolateValueAtAllTimeSteps(values, spatialIndices, result);
+}
+
+void InterpolateValue(
+    const LazyNetCdfTensor& values,
+    const std::vector<double>& spatialIndices,
+    std::vector<double>& result)
+{
+    InterpolateValueAtAllTimeSteps(values, spatialIndices, result);
+}
+
+// The smallest number of time steps which is interpolated by one task of the thread pool,
+//  shorter series are not worth splitting over several threads.
+static const size_t MinimumTimeStepsPerTask = 16 * InterpolationBatchSize;
+
+// Splits the time steps [0, numberOfTimeSteps) into one range per thread of the pool, each a whole number of batches,
+//  and calls interpolateRange(firstTimeStep, numberOfTimeSteps) for each range on the threads of the pool.
+//  Returns when all the ranges are done.
+template<class Function>
+static void ForEachTimeRange(ThreadPool& threadPool, size_t numberOfTimeSteps, const Function& interpolateRange)
+{
+    const size_t numberOfTasks = std::min(threadPool.NumberOfThreads(), numberOfTimeSteps / MinimumTimeStepsPerTask);
+    if (numberOfTasks <= 1)
     {
-        floorIdx[timeDim] = timeIdx;
+        interpolateRange(0, numberOfTimeSteps);
+        return;
+    }
 
-        // ----------- Pick out the neighoring u- and v- values at this point in time -----------
-        // -----------      this is a small cube with 2x2x2 values     -----------
-        SelectCubeValues(values, sizes, floorIdx, unitCubeValues);
+    const size_t batchesPerTask = ((numberOfTimeSteps + InterpolationBatchSize - 1) / InterpolationBatchSize + numberOfTasks - 1) / numberOfTasks;
+    const size_t timeStepsPerTask = batchesPerTask * InterpolationBatchSize;
 
-        // Now perform a tri-linear interpolation inside this cube to calculate the interpolated value
-        auto interpValue = TriLinearInterpolation(unitCubeValues, spatialIndices[0] - lvlFloor, spatialIndices[1] - latFloor, spatialIndices[2] - lonFloor);
+    std::vector<std::future<void>> tasks;
+    for (size_t firstTimeStep = 0; firstTimeStep < numberOfTimeSteps; firstTimeStep += timeStepsPerTask)
+    {
+        const size_t count = std::min(timeStepsPerTask, numberOfTimeSteps - firstTimeStep);
+        tasks.push_back(threadPool.Submit([&interpolateRange, firstTimeStep, count]()
+        {
+            interpolateRange(firstTimeStep, count);
+        }));
+    }
 
-        result[timeIdx] = interpValue.value;
+    // All the tasks write into the result, these must all be done before any exception is passed on.
+    for (std::future<void>& task : tasks)
+    {
+        task.wait();
     }
+    for (std::future<void>& task : tasks)
+    {
+        task.get();
+    }
+}
+
+template<class TensorType>
+void InterpolateWindInParallel(
+    const TensorType& u,
+    const TensorType& v,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    InterpolatedWind& result)
+{
+    if (spatialIndices.size() != 3) throw new std::invalid_argument("Invalid data to InterpolateWind, there must be three spatial dimensions.");
+
+    // The result is allocated before the threads start, such that these only write to their own time steps.
+    result.speed.resize(sizes[0]);
+    result.speedError.resize(sizes[0]);
+    result.direction.resize(sizes[0]);
+    result.directionError.resize(sizes[0]);
+
+    ForEachTimeRange(threadPool, sizes[0], [&](size_t firstTimeStep, size_t numberOfTimeSteps)
+    {
+        InterpolateWindAtTimeSteps(u, v, sizes, spatialIndices, firstTimeStep, numberOfTimeSteps, 0, result);
+    });
+}
+
+template<class TensorType>
+void InterpolateValueInParallel(
+    const TensorType& values,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    std::vector<double>& result)
+{
+    if (spatialIndices.size() != 3) throw new std::invalid_argument("Invalid data to InterpolateValue, there must be three spatial dimensions.");
+
+    result.resize(sizes[0]);
+
+    ForEachTimeRange(threadPool, sizes[0], [&](size_t firstTimeStep, size_t numberOfTimeSteps)
+    {
+        InterpolateValueAtTimeSteps(values, sizes, spatialIndices, firstTimeStep, numberOfTimeSteps, 0, result);
+    });
+}
+
+void InterpolateWind(
+    const std::vector<float>& u,
+    const std::vector<float>& v,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    InterpolatedWind& result)
+{
+    if (sizes.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateWind, the data must be four-dimensional.");
+
+    InterpolateWindInParallel(u, v, sizes, spatialIndices, threadPool, result);
+}
+
+template<class TensorType>
+void InterpolateWindAtAllTimeStepsInParallel(
+    const TensorType& u,
+    const TensorType& v,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    InterpolatedWind& result)
+{
+    if (u.size != v.size) throw new std::invalid_argument("Invalid data to InterpolateWind, u and v must have the same size.");
+    if (u.size.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateWind, the data must be four-dimensional.");
+
+    InterpolateWindInParallel(u, v, u.size, spatialIndices, threadPool, result);
+}
+
+void InterpolateWind(
+    const NetCdfTensor& u,
+    const NetCdfTensor& v,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    InterpolatedWind& result)
+{
+    InterpolateWindAtAllTimeStepsInParallel(u, v, spatialIndices, threadPool, result);
+}
+
+void InterpolateWind(
+    const PackedNetCdfTensor& u,
+    const PackedNetCdfTensor& v,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    InterpolatedWind& result)
+{
+    InterpolateWindAtAllTimeStepsInParallel(u, v, spatialIndices, threadPool, result);
+}
+
+void InterpolateWind(
+    const MappedNetCdfVariable& u,
+    const MappedNetCdfVariable& v,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    InterpolatedWind& result)
+{
+    InterpolateWindAtAllTimeStepsInParallel(u, v, spatialIndices, threadPool, result);
+}
+
+void InterpolateValue(
+    const std::vector<float>& values,
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    std::vector<double>& result)
+{
+    if (sizes.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateValue, the data must be four-dimensional.");
+
+    InterpolateValueInParallel(values, sizes, spatialIndices, threadPool, result);
+}
+
+template<class TensorType>
+void InterpolateValueAtAllTimeStepsInParallel(
+    const TensorType& values,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    std::vector<double>& result)
+{
+    if (values.size.size() != 4) throw new std::invalid_argument("Invalid data to InterpolateValue, the data must be four-dimensional.");
+
+    InterpolateValueInParallel(values, values.size, spatialIndices, threadPool, result);
+}
+
+void InterpolateValue(
+    const NetCdfTensor& values,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    std::vector<double>& result)
+{
+    InterpolateValueAtAllTimeStepsInParallel(values, spatialIndices, threadPool, result);
+}
+
+void InterpolateValue(
+    const PackedNetCdfTensor& values,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    std::vector<double>& result)
+{
+    InterpolateValueAtAllTimeStepsInParallel(values, spatialIndices, threadPool, result);
+}
+
+void InterpolateValue(
+    const MappedNetCdfVariable& values,
+    const std::vector<double>& spatialIndices,
+    ThreadPool& threadPool,
+    std::vector<double>& result)
+{
+    InterpolateValueAtAllTimeStepsInParallel(values, spatialIndices, threadPool, result);
 }
@@ -0,0 +1,166 @@
+#include "WindFieldValidation.h"
+#include "NetCdfFileReader.h"
+#include "CoordinateAxis.h"
+#include <netcdf.h>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+// Verifies that the coordinate variable with the provided name exists and is one-dimensional.
+//  @return true if so, in which case 'dimensionName' and 'length' are set to its dimension.
+static bool FindCoordinateDimension(
+    const std::map<std::string, VariableShape>& variables,
+    const std::string& coordinateName,
+    size_t minimumLength,
+    std::string& dimensionName,
+    size_t& length,
+    std::vector<std::string>& problems)
+{
+    auto coordinate = variables.find(coordinateName);
+    if (coordinate == variables.end())
+    {
+        problems.push_back("The coordinate variable '" + coordinateName + "' is missing.");
+        return false;
+    }
+    if (coordinate->second.dimensionNames.size() != 1 || coordinate->second.size.size() != 1)
+    {
+        std::stringstream msg;
+        msg << "The coordinate variable '" << coordinateName << "' must be one-dimensional but has " << coordinate->second.size.size() << " dimensions.";
+        problems.push_back(msg.str());
+        return false;
+    }
+
+    dimensionName = coordinate->second.dimensionNames[0];
+    length = coordinate->second.size[0];
+
+    if (length < minimumLength)
+    {
+        std::stringstream msg;
+        msg << "The coordinate variable '" << coordinateName << "' has " << length << " values, at least " << minimumLength << " are required.";
+        problems.push_back(msg.str());
+    }
+    return true;
+}
+
+std::vector<std::string> FindWindFieldInconsistencies(const std::map<std::string, VariableShape>& variables, const WindFieldVariableNames& names)
+{
+    std::vector<std::string> problems;
+
+    // The expected dimensions of the fields, the spatial dimensions need two values to interpolate between.
+    const std::vector<std::string> coordinateNames = { names.time, names.level, names.latitude, names.longitude };
+    const std::vector<size_t> minimumLengths = { 1, 2, 2, 2 };
+    std::vector<std::string> expectedDimensionNames(4);
+    std::vector<size_t> expectedSize(4);
+    bool allCoordinatesFound = true;
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        allCoordinatesFound &= FindCoordinateDimension(variables, coordinateNames[ii], minimumLengths[ii], expectedDimensionNames[ii], expectedSize[ii], problems);
+    }
+
+    std::vector<std::string> fieldNames = names.requiredFields;
+    for (const std::string& fieldName : names.requiredFields)
+    {
+        if (variables.find(fieldName) == variables.end())
+        {
+            problems.push_back("The variable '" + fieldName + "' is missing.");
+        }
+    }
+    fieldNames.insert(fieldNames.end(), names.optionalFields.begin(), names.optionalFields.end());
+
+    for (const std::string& fieldName : fieldNames)
+    {
+        auto field = variables.find(fieldName);
+        if (field == variables.end())
+        {
+            continue;
+        }
+
+        const VariableShape& shape = field->second;
+        if (shape.dimensionNames.size() != 4 || shape.size.size() != 4)
+        {
+            std::stringstream msg;
+            msg << "The variable '" << fieldName << "' must have the four dimensions [time, level, latitude, longitude] but has " << shape.size.size() << " dimensions.";
+            problems.push_back(msg.str());
+            continue;
+        }
+        if (!allCoordinatesFound)
+        {
+            continue;
+        }
+
+        for (size_t ii = 0; ii < 4; ++ii)
+        {
+            if (shape.dimensionNames[ii] != expectedDimensionNames[ii])
+            {
+                std::stringstream msg;
+                msg << "Dimension " << ii << " of the variable '" << fieldName << "' is '" << shape.dimensionNames[ii] << "' but should be '" << expectedDimensionNames[ii] << "'.";
+                problems.push_back(msg.str());
+            }
+            else if (shape.size[ii] != expectedSize[ii])
+            {
+                std::stringstream msg;
+                msg << "Dimension " << ii << " of the variable '" << fieldName << "' has the length " << shape.size[ii] << " but '" << coordinateNames[ii] << "' has " << expectedSize[ii] << " values.";
+                problems.push_back(msg.str());
+            }
+        }
+    }
+
+    return problems;
+}
+
+void ValidateWindField(NetCdfFileReader& reader, const WindFieldVariableNames& names)
+{
+    std::vector<std::string> variableNames = { names.time, names.level, names.latitude, names.longitude };
+    variableNames.insert(variableNames.end(), names.requiredFields.begin(), names.requiredFields.end());
+    variableNames.insert(variableNames.end(), names.optionalFields.begin(), names.optionalFields.end());
+
+    std::map<std::string, VariableShape> variables;
+    for (const std::string& variableName : variableNames)
+    {
+        if (!reader.ContainsVariable(variableName))
+        {
+            continue;
+        }
+
+        VariableShape& shape = variables[variableName];
+        shape.size = reader.GetSizeOfVariable(variableName);
+        for (const NetCdfDimension& dimension : reader.GetDimensionsOfVariable(variableName))
+        {
+            shape.dimensionNames.push_back(dimension.name);
+        }
+    }
+
+    const std::vector<std::string> problems = FindWindFieldInconsistencies(variables, names);
+    if (problems.size() > 0)
+    {
+        std::stringstream msg;
+        msg << "The wind field in the file is not consistent:";
+        for (const std::string& problem : problems)
+        {
+            msg << std::endl << "  " << problem;
+        }
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+    }
+}
+
+void ValidateSiteIsInsideOfGrid(const std::vector<float>& latitude, const std::vector<float>& longitude, double siteLatitude, double siteLongitude)
+{
+    ValidateSiteIsInsideOfGrid(CoordinateAxis(latitude), CoordinateAxis(longitude, 360.0), siteLatitude, siteLongitude);
+}
+
+void ValidateSiteIsInsideOfGrid(const CoordinateAxis& latitudeAxis, const CoordinateAxis& longitudeAxis, double siteLatitude, double siteLongitude)
+{
+    if (std::isnan(latitudeAxis.GetFractionalIndices({ siteLatitude })[0]))
+    {
+        std::stringstream msg;
+        msg << "The latitude " << siteLatitude << " of the site lies outside of the grid.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+    }
+
+    if (std::isnan(longitudeAxis.GetFractionalIndices({ siteLongitude })[0]))
+    {
+        std::stringstream msg;
+        msg << "The longitude " << siteLongitude << " of the site lies outside of the grid.";
+        throw NetCdfException(msg.str().c_str(), NC_EINVALCOORDS);
+    }
+}
@@ -0,0 +1,225 @@
+#include "WindSeriesCache.h"
+#include <netcdf.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// The first bytes of every cache entry, followed by the version of the format.
+static const char WindSeriesCacheSignature[8] = { 'N', 'C', 'W', 'S', 'C', 'A', 'C', 'H' };
+static const uint32_t WindSeriesCacheVersion = 2;
+
+void AppendTimeSteps(InterpolatedWind& series, const InterpolatedWind& additionalTimeSteps)
+{
+    auto append = [](std::vector<double>& destination, const std::vector<double>& source)
+    {
+        destination.insert(destination.end(), source.begin(), source.end());
+    };
+
+    append(series.speed, additionalTimeSteps.speed);
+    append(series.speedError, additionalTimeSteps.speedError);
+    append(series.direction, additionalTimeSteps.direction);
+    append(series.directionError, additionalTimeSteps.directionError);
+    append(series.cloudCoverage, additionalTimeSteps.cloudCoverage);
+    append(series.relativeHumidity, additionalTimeSteps.relativeHumidity);
+}
+
+template<class T>
+static void WriteValue(std::ofstream& file, T value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<class T>
+static T ReadValue(std::ifstream& file)
+{
+    T value = 0;
+    file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+static void WriteSeries(std::ofstream& file, const std::vector<double>& values)
+{
+    WriteValue<uint64_t>(file, values.size());
+    file.write(reinterpret_cast<const char*>(values.data()), sizeof(double) * values.size());
+}
+
+// Reads one series written by WriteSeries, @return false if the series is not valid.
+static bool ReadSeries(std::ifstream& file, size_t maximumLength, std::vector<double>& values)
+{
+    const uint64_t length = ReadValue<uint64_t>(file);
+    if (file.fail() || length > maximumLength)
+    {
+        return false;
+    }
+
+    values.resize((size_t)length);
+    file.read(reinterpret_cast<char*>(values.data()), sizeof(double) * values.size());
+    return !file.fail();
+}
+
+// @return true if the optional series (cloud coverage or relative humidity) is either missing or has the provided length.
+static bool IsOptionalSeriesOfLength(const std::vector<double>& values, size_t length)
+{
+    return values.size() == 0 || values.size() == length;
+}
+
+WindSeriesCache::WindSeriesCache(const std::string& cacheDirectory)
+    : m_cacheDirectory(cacheDirectory)
+{
+    if (m_cacheDirectory.size() > 0 && m_cacheDirectory.back() != '/' && m_cacheDirectory.back() != '\\')
+    {
+        m_cacheDirectory += '/';
+    }
+}
+
+std::string WindSeriesCache::GetEntryFilename(const std::string& inputFilename, const SiteLocation& site) const
+{
+    uint64_t hash = HashBytes(inputFilename.data(), inputFilename.size());
+    hash = HashBytes(reinterpret_cast<const char*>(&site.latitude), sizeof(double), hash);
+    hash = HashBytes(reinterpret_cast<const char*>(&site.longitude), sizeof(double), hash);
+    hash = HashBytes(reinterpret_cast<const char*>(&site.altitude), sizeof(double), hash);
+
+    std::stringstream name;
+    name << m_cacheDirectory << std::hex << std::setw(16) << std::setfill('0') << hash << ".wsc";
+    return name.str();
+}
+
+size_t WindSeriesCache::Lookup(const std::string& inputFilename, const FileFingerprint& fingerprint, const SiteLocation& site, const std::vector<double>& times, InterpolatedWind& series) const
+{
+    series = InterpolatedWind();
+
+    std::ifstream file(GetEntryFilename(inputFilename, site), std::ios::binary);
+    if (!file.is_open())
+    {
+        return 0;
+    }
+
+    char signature[sizeof(WindSeriesCacheSignature)] = {};
+    file.read(signature, sizeof(signature));
+    if (file.fail() || std::memcmp(signature, WindSeriesCacheSignature, sizeof(signature)) != 0 || ReadValue<uint32_t>(file) != WindSeriesCacheVersion)
+    {
+        return 0;
+    }
+
+    // Verify that the entry belongs to this file and site, and not to another with the same hash.
+    std::string storedFilename(ReadValue<uint32_t>(file), '\0');
+    file.read(&storedFilename[0], storedFilename.size());
+
+    SiteLocation storedSite;
+    storedSite.latitude = ReadValue<double>(file);
+    storedSite.longitude = ReadValue<double>(file);
+    storedSite.altitude = ReadValue<double>(file);
+
+    FileFingerprint storedFingerprint;
+    storedFingerprint.fileSize = ReadValue<uint64_t>(file);
+    storedFingerprint.modificationTime = ReadValue<int64_t>(file);
+    storedFingerprint.headerHash = ReadValue<uint64_t>(file);
+
+    if (file.fail() || storedFilename != inputFilename ||
+        storedSite.latitude != site.latitude || storedSite.longitude != site.longitude || storedSite.altitude != site.altitude)
+    {
+        return 0;
+    }
+
+    // A changed file can only be partially reused if it has grown, anything else may have rewritten the stored time steps.
+    if (storedFingerprint != fingerprint && fingerprint.fileSize <= storedFingerprint.fileSize)
+    {
+        return 0;
+    }
+
+    // The stored time steps must still be the first time steps of the file.
+    const uint64_t storedNumberOfTimeSteps = ReadValue<uint64_t>(file);
+    const uint64_t storedTimesHash = ReadValue<uint64_t>(file);
+    if (file.fail() || storedNumberOfTimeSteps > times.size() ||
+        HashBytes(reinterpret_cast<const char*>(times.data()), sizeof(double) * (size_t)storedNumberOfTimeSteps) != storedTimesHash)
+    {
+        return 0;
+    }
+
+    const size_t length = (size_t)storedNumberOfTimeSteps;
+    if (!ReadSeries(file, length, series.speed) ||
+        !ReadSeries(file, length, series.speedError) ||
+        !ReadSeries(file, length, series.direction) ||
+        !ReadSeries(file, length, series.directionError) ||
+        !ReadSeries(file, length, series.cloudCoverage) ||
+        !ReadSeries(file, length, series.relativeHumidity) ||
+        series.speed.size() != length || series.speedError.size() != length ||
+        series.direction.size() != length || series.directionError.size() != length ||
+        !IsOptionalSeriesOfLength(series.cloudCoverage, length) || !IsOptionalSeriesOfLength(series.relativeHumidity, length))
+    {
+        series = InterpolatedWind();
+        return 0;
+    }
+
+    return length;
+}
+
+void WindSeriesCache::Store(const std::string& inputFilename, const FileFingerprint& fingerprint, const SiteLocation& site, const std::vector<double>& times, const InterpolatedWind& series)
+{
+    const size_t length = times.size();
+    if (series.speed.size() != length || series.speedError.size() != length ||
+        series.direction.size() != length || series.directionError.size() != length)
+    {
+        throw NetCdfException("Failed to store the wind series in the cache, the series must have one value for each time.", NC_EINVAL);
+    }
+    if (!IsOptionalSeriesOfLength(series.cloudCoverage, length) || !IsOptionalSeriesOfLength(series.relativeHumidity, length))
+    {
+        throw NetCdfException("Failed to store the wind series in the cache, the cloud coverage and relative humidity must either be empty or have one value for each time.", NC_EINVAL);
+    }
+
+    const std::string entryFilename = GetEntryFilename(inputFilename, site);
+
+    // Write to a temporary file first, such that a reader never sees a half-written entry.
+    const std::string temporaryFilename = entryFilename + ".tmp";
+    {
+        std::ofstream file(temporaryFilename, std::ios::binary | std::ios::out | std::ios::trunc);
+
+        file.write(WindSeriesCacheSignature, sizeof(WindSeriesCacheSignature));
+        WriteValue<uint32_t>(file, WindSeriesCacheVersion);
+
+        WriteValue<uint32_t>(file, (uint32_t)inputFilename.size());
+        file.write(inputFilename.data(), inputFilename.size());
+        WriteValue<double>(file, site.latitude);
+        WriteValue<double>(file, site.longitude);
+        WriteValue<double>(file, site.altitude);
+
+        WriteValue<uint64_t>(file, fingerprint.fileSize);
+        WriteValue<int64_t>(file, fingerprint.modificationTime);
+        WriteValue<uint64_t>(file, fingerprint.headerHash);
+
+        WriteValue<uint64_t>(file, times.size());
+        WriteValue<uint64_t>(file, HashBytes(reinterpret_cast<const char*>(times.data()), sizeof(double) * times.size()));
+
+        WriteSeries(file, series.speed);
+        WriteSeries(file, series.speedError);
+        WriteSeries(file, series.direction);
+        WriteSeries(file, series.directionError);
+        WriteSeries(file, series.cloudCoverage);
+        WriteSeries(file, series.relativeHumidity);
+
+        file.close();
+        if (file.fail())
+        {
+            std::remove(temporaryFilename.c_str());
+            std::stringstream msg;
+            msg << "Failed to write the wind series cache entry: '" << entryFilename << "'";
+            throw NetCdfException(msg.str().c_str(), NC_EIO);
+        }
+    }
+
+    std::remove(entryFilename.c_str());
+    if (std::rename(temporaryFilename.c_str(), entryFilename.c_str()) != 0)
+    {
+        std::remove(temporaryFilename.c_str());
+        std::stringstream msg;
+        msg << "Failed to write the wind series cache entry: '" << entryFilename << "'";
+        throw NetCdfException(msg.str().c_str(), NC_EIO);
+    }
+}
+
+void WindSeriesCache::Remove(const std::string& inputFilename, const SiteLocation& site)
+{
+    std::remove(GetEntryFilename(inputFilename, site).c_str());
+}
@@ -0,0 +1,39 @@
+#include "catch.hpp"
+#include <NetCdfFileReader.h>
+
+TEST_CASE("CalculateChunkCacheSettings, time series at point keeps all chunks along time", "[CalculateChunkCacheSettings]")
+{
+    // [time, level, latitude, longitude] stored in chunks of 24 time steps covering 10x10 grid points.
+    const std::vector<size_t> variableSize = { 8760, 22, 100, 100 };
+    const std::vector<size_t> chunkSize = { 24, 1, 10, 10 };
+
+    ChunkCacheSettings settings = CalculateChunkCacheSettings(variableSize, chunkSize, 2, NetCdfAccessPattern::TimeSeriesAtPoint, (size_t)1 << 30);
+
+    const size_t bytesPerChunk = 24 * 10 * 10 * 2;
+    REQUIRE(settings.sizeInBytes == 365 * 8 * bytesPerChunk);
+    REQUIRE(settings.preemption == 0.0F);
+    REQUIRE(settings.numberOfSlots >= 100 * 365 * 8);
+}
+
+TEST_CASE("CalculateChunkCacheSettings, whole field keeps one row of chunks along time", "[CalculateChunkCacheSettings]")
+{
+    const std::vector<size_t> variableSize = { 8760, 22, 100, 100 };
+    const std::vector<size_t> chunkSize = { 24, 1, 10, 10 };
+
+    ChunkCacheSettings settings = CalculateChunkCacheSettings(variableSize, chunkSize, 2, NetCdfAccessPattern::WholeField, (size_t)1 << 30);
+    REQUIRE(settings.sizeInBytes == 22 * 10 * 10 * (24 * 10 * 10 * 2));
+
+    ChunkCacheSettings slabSettings = CalculateChunkCacheSettings(variableSize, chunkSize, 2, NetCdfAccessPattern::TimeSlab, (size_t)1 << 30);
+    REQUIRE(slabSettings.sizeInBytes == 2 * settings.sizeInBytes);
+}
+
+TEST_CASE("CalculateChunkCacheSettings, cache is limited to the maximum size", "[CalculateChunkCacheSettings]")
+{
+    const std::vector<size_t> variableSize = { 8760, 22, 100, 100 };
+    const std::vector<size_t> chunkSize = { 24, 1, 10, 10 };
+
+    ChunkCacheSettings settings = CalculateChunkCacheSettings(variableSize, chunkSize, 4, NetCdfAccessPattern::WholeField, 1000000);
+
+    REQUIRE(settings.sizeInBytes == 1000000);
+    REQUIRE(settings.numberOfSlots >= 100 * (1000000 / (24 * 10 * 10 * 4)));
+}
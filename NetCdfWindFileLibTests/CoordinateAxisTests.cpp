@@ -0,0 +1,153 @@
+#include "catch.hpp"
+#include <CoordinateAxis.h>
+#include <WindFieldInterpolation.h>
+#include <cmath>
+
+// Creates an evenly spaced axis with the provided number of values.
+static std::vector<float> CreateUniformAxis(float first, float step, size_t length)
+{
+    std::vector<float> values(length);
+    for (size_t ii = 0; ii < length; ++ii)
+    {
+        values[ii] = first + step * (float)ii;
+    }
+    return values;
+}
+
+// Verifies that the axis finds the same index as GetFractionalIndex for a range of values.
+static void RequireSameIndicesAsLinearSearch(const std::vector<float>& values)
+{
+    const CoordinateAxis axis(values);
+    const float low = std::min(values.front(), values.back());
+    const float high = std::max(values.front(), values.back());
+
+    for (int ii = 0; ii <= 1000; ++ii)
+    {
+        const float value = low + (high - low) * (float)ii / 1000.0F;
+        REQUIRE(axis.GetFractionalIndex(value) == Approx(GetFractionalIndex(values, value)));
+    }
+    for (float value : values)
+    {
+        REQUIRE(axis.GetFractionalIndex(value) == Approx(GetFractionalIndex(values, value)));
+    }
+}
+
+TEST_CASE("CoordinateAxis, uniform ascending axis", "[CoordinateAxis]")
+{
+    // An ERA5 longitude axis
+    const std::vector<float> values = CreateUniformAxis(0.0F, 0.25F, 1440);
+    const CoordinateAxis axis(values);
+
+    REQUIRE(axis.IsMonotonic());
+    REQUIRE(axis.IsAscending());
+    REQUIRE(axis.IsUniform());
+    REQUIRE(axis.GetFractionalIndex(288.07) == Approx(1152.28));
+    REQUIRE(axis.GetFractionalIndex(359.75) == Approx(1439.0));
+    REQUIRE(axis.GetFractionalIndex(0.0) == 0.0);
+
+    RequireSameIndicesAsLinearSearch(values);
+}
+
+TEST_CASE("CoordinateAxis, uniform descending axis", "[CoordinateAxis]")
+{
+    // An ERA5 latitude axis
+    const std::vector<float> values = CreateUniformAxis(90.0F, -0.25F, 721);
+    const CoordinateAxis axis(values);
+
+    REQUIRE(axis.IsMonotonic());
+    REQUIRE_FALSE(axis.IsAscending());
+    REQUIRE(axis.IsUniform());
+    REQUIRE(axis.GetFractionalIndex(-39.42) == Approx(517.68));
+
+    RequireSameIndicesAsLinearSearch(values);
+}
+
+TEST_CASE("CoordinateAxis, non-uniform axes use binary search", "[CoordinateAxis]")
+{
+    const std::vector<float> altitudes_km
+    {
+        10.42F,9.59F, 8.81F, 7.38F, 6.71F, 5.50F,
+        4.94F, 4.42F, 3.48F, 3.06F, 2.67F, 2.31F,
+        1.98F, 1.68F, 1.41F, 1.17F, 0.95F, 0.76F,
+        0.60F, 0.46F, 0.24F, 0.10F
+    };
+    const CoordinateAxis descendingAxis(altitudes_km);
+    REQUIRE(descendingAxis.IsMonotonic());
+    REQUIRE_FALSE(descendingAxis.IsUniform());
+    RequireSameIndicesAsLinearSearch(altitudes_km);
+
+    std::vector<float> ascending(altitudes_km.rbegin(), altitudes_km.rend());
+    const CoordinateAxis ascendingAxis(ascending);
+    REQUIRE(ascendingAxis.IsAscending());
+    REQUIRE_FALSE(ascendingAxis.IsUniform());
+    RequireSameIndicesAsLinearSearch(ascending);
+}
+
+TEST_CASE("CoordinateAxis, unsorted axis falls back to linear search", "[CoordinateAxis]")
+{
+    const std::vector<float> values = { 0.0F, 2.0F, 1.0F, 3.0F };
+    const CoordinateAxis axis(values);
+
+    REQUIRE_FALSE(axis.IsMonotonic());
+    REQUIRE(axis.GetFractionalIndex(1.5) == GetFractionalIndex(values, 1.5F));
+    REQUIRE(axis.GetFractionalIndex(2.5) == GetFractionalIndex(values, 2.5F));
+}
+
+TEST_CASE("CoordinateAxis, values outside of the axis", "[CoordinateAxis]")
+{
+    const CoordinateAxis axis(CreateUniformAxis(-10.0F, 0.5F, 41));
+
+    REQUIRE_THROWS_AS(axis.GetFractionalIndex(-10.5), std::invalid_argument);
+    REQUIRE_THROWS_AS(axis.GetFractionalIndex(10.5), std::invalid_argument);
+    REQUIRE_THROWS_AS(CoordinateAxis().GetFractionalIndex(0.0), std::invalid_argument);
+    REQUIRE_THROWS_AS(CoordinateAxis({ 1.0F }).GetFractionalIndex(1.0), std::invalid_argument);
+}
+
+TEST_CASE("CoordinateAxis, batch lookup", "[CoordinateAxis]")
+{
+    const CoordinateAxis axis(CreateUniformAxis(-10.0F, 0.5F, 41));
+
+    const std::vector<double> indices = axis.GetFractionalIndices({ -10.0, 0.25, 11.0, 10.0 });
+    REQUIRE(indices.size() == 4);
+    REQUIRE(indices[0] == 0.0);
+    REQUIRE(indices[1] == Approx(20.5));
+    REQUIRE(std::isnan(indices[2]));
+    REQUIRE(indices[3] == Approx(40.0));
+}
+
+TEST_CASE("CoordinateAxis, periodic global axis wraps around", "[CoordinateAxis]")
+{
+    const CoordinateAxis axis(CreateUniformAxis(0.0F, 0.25F, 1440), 360.0);
+
+    REQUIRE(axis.IsPeriodic());
+    REQUIRE(axis.WrapsAround());
+    REQUIRE(axis.GetFractionalIndex(10.0) == Approx(40.0));
+    REQUIRE(axis.GetFractionalIndex(-71.93) == Approx((360.0 - 71.93) * 4.0));
+    REQUIRE(axis.GetFractionalIndex(359.9) == Approx(1439.6));
+    REQUIRE(axis.GetFractionalIndex(-0.1) == Approx(1439.6));
+    REQUIRE(axis.GetFractionalIndex(720.5) == Approx(2.0));
+}
+
+TEST_CASE("CoordinateAxis, periodic global descending axis wraps around", "[CoordinateAxis]")
+{
+    const CoordinateAxis axis(CreateUniformAxis(179.0F, -2.0F, 180), 360.0);
+
+    REQUIRE(axis.WrapsAround());
+    REQUIRE(axis.GetFractionalIndex(178.0) == Approx(0.5));
+    REQUIRE(axis.GetFractionalIndex(-180.0) == Approx(179.5));
+    REQUIRE(axis.GetFractionalIndex(180.0) == Approx(179.5));
+    REQUIRE(axis.GetFractionalIndex(-179.5) == Approx(179.25));
+}
+
+TEST_CASE("CoordinateAxis, periodic regional axis does not wrap around", "[CoordinateAxis]")
+{
+    const std::vector<float> values = CreateUniformAxis(280.0F, 0.25F, 61);
+    const CoordinateAxis axis(values, 360.0);
+
+    REQUIRE(axis.IsPeriodic());
+    REQUIRE_FALSE(axis.WrapsAround());
+    REQUIRE(axis.GetFractionalIndex(-71.93) == Approx(axis.GetFractionalIndex(288.07)));
+    REQUIRE(axis.GetFractionalIndex(288.07) == Approx(GetFractionalIndex(values, 288.07F)));
+    REQUIRE_THROWS_AS(axis.GetFractionalIndex(0.0), std::invalid_argument);
+    REQUIRE(std::isnan(axis.GetFractionalIndices({ 296.0 })[0]));
+}
@@ -0,0 +1,190 @@
+#include "catch.hpp"
+#include <InterpolationKernels.h>
+#include <WindFieldInterpolation.h>
+#include <cmath>
+
+// The tri-linear interpolation as it was calculated before the kernels in InterpolationKernels.h were introduced.
+static EstimatedValue ReferenceTriLinearInterpolation(const std::vector<double>& inputCube, double idxX, double idxY, double idxZ)
+{
+    double c00 = inputCube[0] * (1.0 - idxZ) + inputCube[1] * idxZ;
+    double c01 = inputCube[2] * (1.0 - idxZ) + inputCube[3] * idxZ;
+    double c10 = inputCube[4] * (1.0 - idxZ) + inputCube[5] * idxZ;
+    double c11 = inputCube[6] * (1.0 - idxZ) + inputCube[7] * idxZ;
+
+    double c0 = c00 * (1.0 - idxY) + c01 * idxY;
+    double c1 = c10 * (1.0 - idxY) + c11 * idxY;
+
+    EstimatedValue result;
+    result.value = c0 * (1.0 - idxX) + c1 * idxX;
+    result.uncertainty = c1 - c0;
+    return result;
+}
+
+TEST_CASE("MultiLinearInterpolation, tri-linear kernel equals the original tri-linear interpolation", "[InterpolationKernels]")
+{
+    const std::vector<double> cube = { 1.0, -2.0, 3.5, 4.0, 0.25, 6.0, -7.0, 8.0 };
+    CornerValues<3> corners;
+    std::copy(cube.begin(), cube.end(), corners.begin());
+
+    // the corners and the center of the cube
+    REQUIRE(TriLinearInterpolation(corners, 0.0, 0.0, 0.0).value == 1.0);
+    REQUIRE(TriLinearInterpolation(corners, 0.0, 0.0, 1.0).value == -2.0);
+    REQUIRE(TriLinearInterpolation(corners, 1.0, 1.0, 0.0).value == -7.0);
+    REQUIRE(TriLinearInterpolation(corners, 0.5, 0.5, 0.5).value == Approx(13.75 / 8.0));
+    REQUIRE(TriLinearInterpolation(corners, 0.5, 0.5, 0.5).uncertainty == Approx(7.25 / 4.0 - 6.5 / 4.0));
+
+    for (double idxZ : { 0.0, 0.3, 1.0 })
+    {
+        for (double idxY : { 0.0, 0.6, 1.0 })
+        {
+            for (double idxX : { 0.0, 0.1, 0.75 })
+            {
+                const EstimatedValue expected = ReferenceTriLinearInterpolation(cube, idxZ, idxY, idxX);
+
+                const EstimatedValue result = TriLinearInterpolation(corners, idxZ, idxY, idxX);
+                REQUIRE(result.value == expected.value);
+                REQUIRE(result.uncertainty == expected.uncertainty);
+
+                const EstimatedValue resultOnVectors = TriLinearInterpolation(cube, idxZ, idxY, idxX);
+                REQUIRE(resultOnVectors.value == expected.value);
+                REQUIRE(resultOnVectors.uncertainty == expected.uncertainty);
+            }
+        }
+    }
+}
+
+TEST_CASE("MultiLinearInterpolation, bi-linear kernel returns the corners and the center", "[InterpolationKernels]")
+{
+    const CornerValues<2> corners = { { 1.0, 2.0, 3.0, 4.0 } };
+
+    REQUIRE(BiLinearInterpolation(corners, 0.0, 0.0).value == 1.0);
+    REQUIRE(BiLinearInterpolation(corners, 0.0, 1.0).value == 2.0);
+    REQUIRE(BiLinearInterpolation(corners, 1.0, 0.0).value == 3.0);
+    REQUIRE(BiLinearInterpolation(corners, 1.0, 1.0).value == 4.0);
+    REQUIRE(BiLinearInterpolation(corners, 0.5, 0.5).value == Approx(2.5));
+    REQUIRE(BiLinearInterpolation(corners, 0.5, 0.5).uncertainty == Approx(2.0));
+}
+
+TEST_CASE("MultiLinearInterpolation, quadri-linear kernel interpolates between two time steps", "[InterpolationKernels]")
+{
+    // the first time step is constant 1 and the second is constant 3
+    CornerValues<4> corners;
+    for (size_t cornerIdx = 0; cornerIdx < 16; ++cornerIdx)
+    {
+        corners[cornerIdx] = (cornerIdx < 8) ? 1.0 : 3.0;
+    }
+
+    const EstimatedValue result = QuadriLinearInterpolation(corners, 0.25, 0.3, 0.6, 0.9);
+    REQUIRE(result.value == Approx(1.5));
+    REQUIRE(result.uncertainty == Approx(2.0));
+}
+
+TEST_CASE("MultiLinearInterpolation, invalid corners are left out", "[InterpolationKernels]")
+{
+    CornerValues<4> corners;
+    CornerValidity<4> valid;
+    for (size_t cornerIdx = 0; cornerIdx < 16; ++cornerIdx)
+    {
+        corners[cornerIdx] = 2.0;
+        valid[cornerIdx] = true;
+    }
+    corners[5] = 1000.0;
+    valid[5] = false;
+
+    const EstimatedValue result = QuadriLinearInterpolation(corners, valid, 0.5, 0.5, 0.5, 0.5);
+    REQUIRE(result.value == Approx(2.0));
+    REQUIRE(result.uncertainty == Approx(0.0).margin(1e-12));
+
+    valid.fill(false);
+    REQUIRE(std::isnan(QuadriLinearInterpolation(corners, valid, 0.5, 0.5, 0.5, 0.5).value));
+}
+
+TEST_CASE("MultiLinearInterpolation, validity kernel re-weights the valid corners", "[InterpolationKernels]")
+{
+    const std::vector<double> cube = { 1.0, -2.0, 3.5, 4.0, 0.25, 6.0, -7.0, 8.0 };
+    const std::vector<bool> validCorners = { true, false, true, true, true, true, true, true };
+    CornerValues<3> corners;
+    CornerValidity<3> valid;
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        corners[cornerIdx] = cube[cornerIdx];
+        valid[cornerIdx] = validCorners[cornerIdx];
+    }
+
+    // in the center all corners have the same weight, the value is the mean of the valid corners
+    //  and the uncertainty is the difference between the means of the two levels.
+    const EstimatedValue result = TriLinearInterpolation(corners, valid, 0.5, 0.5, 0.5);
+    REQUIRE(result.value == Approx(15.75 / 7.0));
+    REQUIRE(result.uncertainty == Approx(7.25 / 4.0 - 8.5 / 3.0));
+
+    const EstimatedValue resultOnVectors = TriLinearInterpolation(cube, validCorners, 0.5, 0.5, 0.5);
+    REQUIRE(resultOnVectors.value == result.value);
+    REQUIRE(resultOnVectors.uncertainty == result.uncertainty);
+
+    // with all corners valid, the result equals the original tri-linear interpolation
+    valid.fill(true);
+    const EstimatedValue expected = ReferenceTriLinearInterpolation(cube, 0.2, 0.7, 0.4);
+    REQUIRE(TriLinearInterpolation(corners, valid, 0.2, 0.7, 0.4).value == Approx(expected.value));
+    REQUIRE(TriLinearInterpolation(corners, valid, 0.2, 0.7, 0.4).uncertainty == Approx(expected.uncertainty));
+}
+
+TEST_CASE("Batched TriLinearInterpolation, equals the interpolation of one time step at a time", "[InterpolationKernels]")
+{
+    // 63 time steps, such that neither the AVX2 nor the SSE2 loop covers the full batch
+    const size_t numberOfTimeSteps = 63;
+    CornerBatch<3> corners;
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        for (size_t timeIdx = 0; timeIdx < numberOfTimeSteps; ++timeIdx)
+        {
+            corners[cornerIdx][timeIdx] = std::sin(0.1 * (double)(cornerIdx * 100 + timeIdx));
+        }
+    }
+    const CubePosition<3> position = { { 0.3, 0.8, 0.45 } };
+
+    std::vector<double> value(numberOfTimeSteps);
+    std::vector<double> uncertainty(numberOfTimeSteps);
+    TriLinearInterpolation(corners, numberOfTimeSteps, position, value.data(), uncertainty.data());
+
+    for (size_t timeIdx = 0; timeIdx < numberOfTimeSteps; ++timeIdx)
+    {
+        CornerValues<3> cube;
+        for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+        {
+            cube[cornerIdx] = corners[cornerIdx][timeIdx];
+        }
+        const EstimatedValue expected = MultiLinearInterpolation<3>(cube, position);
+        REQUIRE(value[timeIdx] == expected.value);
+        REQUIRE(uncertainty[timeIdx] == expected.uncertainty);
+    }
+}
+
+TEST_CASE("CalculateWindSpeedAndDirection, returns the speed and direction of each corner", "[InterpolationKernels]")
+{
+    const size_t numberOfTimeSteps = 7;
+    CornerBatch<3> u;
+    CornerBatch<3> v;
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        for (size_t timeIdx = 0; timeIdx < numberOfTimeSteps; ++timeIdx)
+        {
+            u[cornerIdx][timeIdx] = (double)cornerIdx - 3.5;
+            v[cornerIdx][timeIdx] = (double)timeIdx - 2.0;
+        }
+    }
+
+    CornerBatch<3> speed;
+    CornerBatch<3> direction;
+    CalculateWindSpeedAndDirection(u, v, numberOfTimeSteps, speed, direction);
+
+    for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+    {
+        for (size_t timeIdx = 0; timeIdx < numberOfTimeSteps; ++timeIdx)
+        {
+            const double uValue = u[cornerIdx][timeIdx];
+            const double vValue = v[cornerIdx][timeIdx];
+            REQUIRE(speed[cornerIdx][timeIdx] == std::sqrt(uValue * uValue + vValue * vValue));
+            REQUIRE(direction[cornerIdx][timeIdx] == 180.0 * std::atan2(-uValue, -vValue) / 3.14159265358979323846);
+        }
+    }
+}
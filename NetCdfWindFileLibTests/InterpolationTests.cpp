@@ -1,7 +1,11 @@
 #define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
 #include "catch.hpp"
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <WindFieldInterpolation.h>
+#include <NetCdfFileReader.h>
+#include <ThreadPool.h>
 
 TEST_CASE("GetFractionalIndex increasing values, finds correct quarter points", "[GetFractionalIndex]")
 {
@@ -137,4 +141,318 @@ TEST_CASE("Unit-wind field, returns all wind-direction errors of zero (no gradie
     REQUIRE(result.directionError[0] == 0.0);
     REQUIRE(result.directionError[3] == 0.0);
     REQUIRE(result.directionError[5] == 0.0);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Wind field interpolated in time blocks, returns same result as full wind field", "[InterpolateWind]")
+{
+    std::vector<size_t> size = { 6, 2, 2, 2 };
+    std::vector<float> u(48);
+    std::vector<float> v(48);
+    for (size_t ii = 0; ii < 48; ++ii)
+    {
+        u[ii] = (float)ii;
+        v[ii] = 48.0F - (float)ii;
+    }
+    std::vector<double> indices = { 0.25, 0.5, 0.75 };
+
+    InterpolatedWind fullResult;
+    InterpolateWind(u, v, size, indices, fullResult);
+
+    InterpolatedWind blockResult;
+    std::vector<size_t> blockSize = { 3, 2, 2, 2 };
+    for (size_t firstTimeIdx = 0; firstTimeIdx < 6; firstTimeIdx += 3)
+    {
+        std::vector<float> uBlock(begin(u) + firstTimeIdx * 8, begin(u) + (firstTimeIdx + 3) * 8);
+        std::vector<float> vBlock(begin(v) + firstTimeIdx * 8, begin(v) + (firstTimeIdx + 3) * 8);
+        InterpolateWind(uBlock, vBlock, blockSize, indices, firstTimeIdx, blockResult);
+    }
+
+    REQUIRE(blockResult.speed == fullResult.speed);
+    REQUIRE(blockResult.speedError == fullResult.speedError);
+    REQUIRE(blockResult.direction == fullResult.direction);
+    REQUIRE(blockResult.directionError == fullResult.directionError);
+}
+
+TEST_CASE("Packed wind field, returns same result as the decoded wind field", "[InterpolateWind]")
+{
+    PackedNetCdfTensor u;
+    u.size = { 6, 2, 2, 2 };
+    u.packedValues.resize(48);
+    u.scaling.scaleFactor = 0.25;
+    u.scaling.offset = -3.0;
+    PackedNetCdfTensor v = u;
+    v.scaling.scaleFactor = 0.5;
+    for (size_t ii = 0; ii < 48; ++ii)
+    {
+        u.packedValues[ii] = (short)(ii * 7);
+        v.packedValues[ii] = (short)(100 - ii * 3);
+    }
+    std::vector<float> uDecoded(48);
+    std::vector<float> vDecoded(48);
+    for (size_t ii = 0; ii < 48; ++ii)
+    {
+        uDecoded[ii] = u[ii];
+        vDecoded[ii] = v[ii];
+    }
+    std::vector<double> indices = { 0.25, 0.5, 0.75 };
+
+    InterpolatedWind packedResult;
+    InterpolateWind(u, v, indices, packedResult);
+
+    InterpolatedWind decodedResult;
+    InterpolateWind(uDecoded, vDecoded, u.size, indices, decodedResult);
+
+    REQUIRE(packedResult.speed == decodedResult.speed);
+    REQUIRE(packedResult.direction == decodedResult.direction);
+}
+
+TEST_CASE("Wind field with missing corner, returns interpolation of remaining corners", "[InterpolateWind]")
+{
+    NetCdfTensor u;
+    u.size = { 2, 2, 2, 2 };
+    u.values = std::vector<float>(16, 1.0F);
+    NetCdfTensor v = u;
+
+    // the first corner of the first time step is missing from u
+    u.values[0] = std::numeric_limits<float>::quiet_NaN();
+    u.validity = { 0xFE, 0xFF };
+    std::vector<double> indices = { 0.25, 0.5, 0.75 };
+
+    InterpolatedWind result;
+    InterpolateWind(u, v, indices, result);
+
+    REQUIRE(result.speed.size() == 2);
+    REQUIRE(std::abs(result.speed[0] - std::sqrt(2.0)) < 1e-9);
+    REQUIRE(std::abs(result.direction[0] + 135.0) < 1e-9);
+    REQUIRE(std::abs(result.speed[1] - std::sqrt(2.0)) < 1e-9);
+}
+
+TEST_CASE("InterpolateWind over many time steps, equals the interpolation of one time step at a time", "[InterpolateWind]")
+{
+    // more than two batches of time steps, with a few missing values in the middle of the second batch
+    const size_t numberOfTimeSteps = 150;
+    NetCdfTensor u;
+    u.size = { numberOfTimeSteps, 2, 3, 2 };
+    u.values.resize(numberOfTimeSteps * 12);
+    NetCdfTensor v = u;
+    for (size_t ii = 0; ii < u.values.size(); ++ii)
+    {
+        u.values[ii] = (float)std::sin(0.01 * (double)ii) * 10.0F;
+        v.values[ii] = (float)std::cos(0.013 * (double)ii) * 8.0F;
+    }
+    v.validity.assign((v.values.size() + 7) / 8, 0xFF);
+    const size_t missingValueIdx = 100 * 12 + 9;
+    v.values[missingValueIdx] = std::numeric_limits<float>::quiet_NaN();
+    v.validity[missingValueIdx >> 3] &= (uint8_t)~(1 << (missingValueIdx & 7));
+
+    const std::vector<double> indices = { 0.25, 1.5, 0.75 };
+    InterpolatedWind result;
+    InterpolateWind(u, v, indices, result);
+
+    REQUIRE(result.speed.size() == numberOfTimeSteps);
+    for (size_t timeIdx = 0; timeIdx < numberOfTimeSteps; ++timeIdx)
+    {
+        std::vector<double> speed(8);
+        std::vector<double> direction(8);
+        std::vector<bool> valid(8);
+        for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+        {
+            const size_t index = timeIdx * 12 + ((cornerIdx >> 2) & 1) * 6 + (1 + ((cornerIdx >> 1) & 1)) * 2 + (cornerIdx & 1);
+            const double uValue = u.values[index];
+            const double vValue = v.values[index];
+            speed[cornerIdx] = std::sqrt(uValue * uValue + vValue * vValue);
+            direction[cornerIdx] = 180.0 * std::atan2(-uValue, -vValue) / 3.14159265358979323846;
+            valid[cornerIdx] = v.IsValid(index);
+        }
+
+        // the time steps with missing corners are interpolated using the re-weighted interpolation
+        const bool allValid = std::all_of(valid.begin(), valid.end(), [](bool isValid) { return isValid; });
+        const EstimatedValue expectedSpeed = allValid ? TriLinearInterpolation(speed, 0.25, 0.5, 0.75) : TriLinearInterpolation(speed, valid, 0.25, 0.5, 0.75);
+        const EstimatedValue expectedDirection = allValid ? TriLinearInterpolation(direction, 0.25, 0.5, 0.75) : TriLinearInterpolation(direction, valid, 0.25, 0.5, 0.75);
+        REQUIRE(result.speed[timeIdx] == expectedSpeed.value);
+        REQUIRE(result.speedError[timeIdx] == expectedSpeed.uncertainty);
+        REQUIRE(result.direction[timeIdx] == expectedDirection.value);
+        REQUIRE(result.directionError[timeIdx] == expectedDirection.uncertainty);
+    }
+}
+
+TEST_CASE("Wind field where u and v have different sizes, throws", "[InterpolateWind]")
+{
+    NetCdfTensor u;
+    u.size = { 1, 2, 2, 2 };
+    u.values = std::vector<float>(8, 1.0F);
+    NetCdfTensor v = u;
+    v.size = { 1, 2, 2, 1 };
+    v.values.resize(4);
+
+    InterpolatedWind result;
+    REQUIRE_THROWS_AS(InterpolateWind(u, v, { 0.5, 0.5, 0.5 }, result), std::invalid_argument*);
+
+    ThreadPool threadPool(2);
+    REQUIRE_THROWS_AS(InterpolateWind(u, v, { 0.5, 0.5, 0.5 }, threadPool, result), std::invalid_argument*);
+}
+
+TEST_CASE("Value field with all corners missing, returns NaN", "[InterpolateValue]")
+{
+    NetCdfTensor values;
+    values.size = { 2, 2, 2, 2 };
+    values.values = std::vector<float>(16, 3.0F);
+    values.validity = { 0x00, 0xFF };
+    std::vector<double> indices = { 0.5, 0.5, 0.5 };
+
+    std::vector<double> result;
+    InterpolateValue(values, indices, result);
+
+    REQUIRE(std::isnan(result[0]));
+    REQUIRE(std::abs(result[1] - 3.0) < 1e-9);
+}
+
+TEST_CASE("Point between the last and the first longitude, throws since the values do not wrap around", "[InterpolateValue]")
+{
+    // one time step, two levels, two latitudes and four longitudes where the value equals the longitude index
+    const std::vector<size_t> sizes = { 1, 2, 2, 4 };
+    std::vector<float> values(16);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        values[ii] = (float)(ii % 4);
+    }
+
+    // a point on the last longitude uses the cube ending there
+    std::vector<double> result;
+    InterpolateValue(values, sizes, { 0.5, 0.5, 3.0 }, result);
+    REQUIRE(result.size() == 1);
+    REQUIRE(result[0] == Approx(3.0));
+
+    // neighbourhoods on periodic grids are instead read as one cube, see NetCdfFileReader::ReadNeighbourhood
+    REQUIRE_THROWS_AS(InterpolateValue(values, sizes, { 0.5, 0.5, 3.25 }, result), std::invalid_argument*);
+    REQUIRE_THROWS_AS(InterpolateValue(values, sizes, { 0.5, -0.5, 1.0 }, result), std::invalid_argument*);
+}
+
+TEST_CASE("Neighbourhood wrapping around the longitude, reads the last and first longitude", "[GetNeighbourhoodSlab]")
+{
+    const std::vector<size_t> variableSize = { 3, 2, 2, 4 };
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    std::vector<double> localIndices;
+    GetNeighbourhoodSlab("u", variableSize, { 0.5, 0.5, 3.25 }, start, count, localIndices, true);
+
+    REQUIRE(start == std::vector<size_t>({ 0, 0, 0, 3 }));
+    REQUIRE(count == std::vector<size_t>({ 3, 2, 2, 2 }));
+    REQUIRE(localIndices[2] == Approx(0.25));
+    REQUIRE(NeighbourhoodWrapsAround(variableSize, start, count));
+    REQUIRE_THROWS_AS(GetNeighbourhoodSlab("u", variableSize, { 0.5, 0.5, 4.0 }, start, count, localIndices, true), NetCdfException);
+
+    NetCdfTensor lastColumn;
+    lastColumn.size = { 3, 2, 2, 1 };
+    lastColumn.values = std::vector<float>(12, 3.0F);
+    NetCdfTensor firstColumn = lastColumn;
+    firstColumn.values = std::vector<float>(12, 0.0F);
+    firstColumn.values[0] = std::numeric_limits<float>::quiet_NaN();
+    firstColumn.validity = { 0xFE, 0x0F };
+
+    const NetCdfTensor cube = MergeWrappedNeighbourhood(lastColumn, firstColumn);
+
+    REQUIRE(cube.size == count);
+    REQUIRE(cube.values.size() == 24);
+    REQUIRE(cube.values[0] == 3.0F);
+    REQUIRE_FALSE(cube.IsValid(1));
+    REQUIRE(cube.values[2] == 3.0F);
+    REQUIRE(cube.values[3] == 0.0F);
+    REQUIRE(cube.IsValid(3));
+    REQUIRE(cube.IsValid(23));
+
+    std::vector<double> result;
+    InterpolateValue(cube, localIndices, result);
+    REQUIRE(result.size() == 3);
+    REQUIRE(result[1] == Approx(2.25));
+
+    // on a regional grid the last longitude is not followed by the first
+    REQUIRE_THROWS_AS(GetNeighbourhoodSlab("u", variableSize, { 0.5, 0.5, 3.25 }, start, count, localIndices), NetCdfException);
+    GetNeighbourhoodSlab("u", variableSize, { 0.5, 0.5, 3.0 }, start, count, localIndices);
+    REQUIRE(start == std::vector<size_t>({ 0, 0, 0, 2 }));
+    REQUIRE(localIndices[2] == Approx(1.0));
+    REQUIRE_FALSE(NeighbourhoodWrapsAround(variableSize, start, count));
+}
+
+TEST_CASE("Neighbourhood of a point with a NaN index, throws", "[GetNeighbourhoodSlab]")
+{
+    const std::vector<size_t> variableSize = { 3, 2, 2, 4 };
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    std::vector<double> localIndices;
+
+    REQUIRE_THROWS_AS(GetNeighbourhoodSlab("u", variableSize, { nan, 0.5, 0.5 }, start, count, localIndices), NetCdfException);
+    REQUIRE_THROWS_AS(GetNeighbourhoodSlab("u", variableSize, { 0.5, nan, 0.5 }, start, count, localIndices), NetCdfException);
+    REQUIRE_THROWS_AS(GetNeighbourhoodSlab("u", variableSize, { 0.5, 0.5, nan }, start, count, localIndices, true), NetCdfException);
+}
+
+// Creates a wind field component with some structure in all dimensions and a few missing values.
+static NetCdfTensor CreateLongSeries(size_t numberOfTimeSteps, double frequency)
+{
+    NetCdfTensor tensor;
+    tensor.size = { numberOfTimeSteps, 2, 2, 3 };
+    tensor.values.resize(numberOfTimeSteps * 12);
+    tensor.validity.assign((tensor.values.size() + 7) / 8, 0xFF);
+    for (size_t ii = 0; ii < tensor.values.size(); ++ii)
+    {
+        tensor.values[ii] = (float)(10.0 * std::sin(frequency * (double)ii));
+        if (ii % 997 == 0)
+        {
+            tensor.values[ii] = std::numeric_limits<float>::quiet_NaN();
+            tensor.validity[ii >> 3] &= (uint8_t)~(1 << (ii & 7));
+        }
+    }
+    return tensor;
+}
+
+TEST_CASE("Wind field interpolated in parallel, returns same result as single-threaded", "[InterpolateWind]")
+{
+    const NetCdfTensor u = CreateLongSeries(10007, 0.011);
+    const NetCdfTensor v = CreateLongSeries(10007, 0.017);
+    const std::vector<double> indices = { 0.4, 0.7, 1.2 };
+    ThreadPool threadPool(4);
+
+    InterpolatedWind expected;
+    InterpolateWind(u, v, indices, expected);
+
+    InterpolatedWind result;
+    InterpolateWind(u, v, indices, threadPool, result);
+
+    REQUIRE(result.speed.size() == 10007);
+    for (size_t ii = 0; ii < result.speed.size(); ++ii)
+    {
+        REQUIRE(std::isnan(result.speed[ii]) == std::isnan(expected.speed[ii]));
+        if (!std::isnan(expected.speed[ii]))
+        {
+            REQUIRE(result.speed[ii] == expected.speed[ii]);
+            REQUIRE(result.speedError[ii] == expected.speedError[ii]);
+            REQUIRE(result.direction[ii] == expected.direction[ii]);
+            REQUIRE(result.directionError[ii] == expected.directionError[ii]);
+        }
+    }
+}
+
+TEST_CASE("Values interpolated in parallel, returns same result as single-threaded", "[InterpolateValue]")
+{
+    const NetCdfTensor values = CreateLongSeries(5000, 0.013);
+    const std::vector<double> indices = { 0.5, 0.25, 1.75 };
+    ThreadPool threadPool(3);
+
+    std::vector<double> expected;
+    InterpolateValue(values, indices, expected);
+
+    std::vector<double> result;
+    InterpolateValue(values, indices, threadPool, result);
+    REQUIRE(result.size() == expected.size());
+    for (size_t ii = 0; ii < result.size(); ++ii)
+    {
+        REQUIRE(result[ii] == expected[ii]);
+    }
+
+    // short series are interpolated on the calling thread
+    const NetCdfTensor shortSeries = CreateLongSeries(10, 0.013);
+    InterpolateValue(shortSeries, indices, threadPool, result);
+    InterpolateValue(shortSeries, indices, expected);
+    REQUIRE(result == expected);
+}
@@ -0,0 +1,138 @@
+#include "catch.hpp"
+#include "TestFiles.h"
+#include <NetCdfFileReader.h>
+#include <NetCdfException.h>
+#include <cmath>
+
+// Writes a file with one packed variable 'u' of size [8, 4], where every fifth value is missing.
+static void WriteFile(const std::string& fileName)
+{
+    ClassicNetCdfFileBuilder builder;
+    const size_t time = builder.AddDimension("time", 8);
+    const size_t x = builder.AddDimension("x", 4);
+
+    std::vector<double> u;
+    for (size_t ii = 0; ii < 32; ++ii)
+    {
+        u.push_back((ii % 5 == 0) ? -32767.0 : (double)ii);
+    }
+
+    const size_t uIdx = builder.AddVariable("u", { time, x }, NC_SHORT, u);
+    builder.AddAttribute(uIdx, "scale_factor", NC_DOUBLE, { 0.5 });
+    builder.AddAttribute(uIdx, "_FillValue", NC_SHORT, { -32767.0 });
+
+    builder.Write(fileName);
+}
+
+// The number of bytes which one block of [2, 4] values occupies in memory, the values and their validity.
+static const size_t BytesPerBlock = 8 * sizeof(float) + 1;
+
+TEST_CASE("LazyNetCdfTensor reads the same values as ReadVariable", "[LazyNetCdfTensor]")
+{
+    TemporaryFile file("LazyNetCdfTensorTests_values.nc");
+    WriteFile(file.path);
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+    const NetCdfTensor expected = reader.ReadVariable("u");
+    LazyNetCdfTensor u = reader.ReadVariableLazy("u", { 2, 4 });
+
+    REQUIRE(u.size == std::vector<size_t>({ 8, 4 }));
+    REQUIRE(u.BlockSize() == std::vector<size_t>({ 2, 4 }));
+    REQUIRE(u.NumberOfLoadedBlocks() == 0);
+
+    // the blocks are read as they are accessed, in any order
+    for (size_t ii = 32; ii-- > 0;)
+    {
+        REQUIRE(u.IsValid(ii) == expected.IsValid(ii));
+        if (expected.IsValid(ii))
+        {
+            REQUIRE(u[ii] == expected.values[ii]);
+        }
+        else
+        {
+            REQUIRE(std::isnan(u[ii]));
+        }
+        REQUIRE(u.NumberOfLoadedBlocks() == 4 - ii / 8);
+    }
+
+    u.ClearCache();
+    REQUIRE(u.NumberOfLoadedBlocks() == 0);
+}
+
+TEST_CASE("LazyNetCdfTensor releases the least recently used block", "[LazyNetCdfTensor]")
+{
+    TemporaryFile file("LazyNetCdfTensorTests_eviction.nc");
+    WriteFile(file.path);
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+
+    SECTION("The budget includes the validity of the values")
+    {
+        LazyNetCdfTensor u = reader.ReadVariableLazy("u", { 2, 4 }, 2 * BytesPerBlock);
+        REQUIRE_FALSE(u.IsValid(0));
+        REQUIRE(u[8] == 4.0F);
+        REQUIRE(u.NumberOfLoadedBlocks() == 2);
+
+        LazyNetCdfTensor v = reader.ReadVariableLazy("u", { 2, 4 }, 2 * BytesPerBlock - 1);
+        REQUIRE_FALSE(v.IsValid(0));
+        REQUIRE(v[8] == 4.0F);
+        REQUIRE(v.NumberOfLoadedBlocks() == 1);
+    }
+
+    SECTION("Accessing a block makes it the most recently used")
+    {
+        LazyNetCdfTensor u = reader.ReadVariableLazy("u", { 2, 4 }, 2 * BytesPerBlock);
+        REQUIRE_FALSE(u.IsValid(0));
+        REQUIRE(u[8] == 4.0F);
+        REQUIRE(u[1] == 0.5F);
+        REQUIRE(u[16] == 8.0F);
+        REQUIRE(u.NumberOfLoadedBlocks() == 2);
+
+        // only the first and the third block are still loaded, which is seen once the tensor cannot read any more
+        reader.DetachLazyTensors();
+        REQUIRE(u[1] == 0.5F);
+        REQUIRE(u[17] == 8.5F);
+        REQUIRE_THROWS_AS(u[8], NetCdfException);
+    }
+}
+
+TEST_CASE("LazyNetCdfTensor follows its reader", "[LazyNetCdfTensor]")
+{
+    TemporaryFile file("LazyNetCdfTensorTests_lifetime.nc");
+    WriteFile(file.path);
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+    LazyNetCdfTensor u = reader.ReadVariableLazy("u", { 2, 4 });
+    REQUIRE(u[1] == 0.5F);
+
+    SECTION("The reader is moved")
+    {
+        NetCdfFileReader movedReader = std::move(reader);
+        REQUIRE(u[9] == 4.5F);
+
+        NetCdfFileReader assignedReader;
+        assignedReader = std::move(movedReader);
+        REQUIRE(u[17] == 8.5F);
+
+        assignedReader.Close();
+        REQUIRE(u[1] == 0.5F);
+        REQUIRE_THROWS_AS(u[25], NetCdfException);
+    }
+
+    SECTION("The reader is closed and opened again")
+    {
+        reader.Close();
+        reader.Open(file.path);
+        REQUIRE_THROWS_AS(u[9], NetCdfException);
+        REQUIRE(reader.ReadVariableLazy("u", { 2, 4 })[9] == 4.5F);
+    }
+
+    SECTION("The tensor is moved")
+    {
+        LazyNetCdfTensor movedTensor = std::move(u);
+        REQUIRE(movedTensor[9] == 4.5F);
+    }
+}
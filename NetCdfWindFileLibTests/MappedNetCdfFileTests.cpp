@@ -0,0 +1,185 @@
+#include "catch.hpp"
+#include "TestFiles.h"
+#include <MappedNetCdfFile.h>
+#include <NetCdfException.h>
+
+// Creates a file with one fixed size variable and one record variable (two records) with a scaling attribute.
+static ClassicNetCdfFileBuilder CreateSmallFile()
+{
+    ClassicNetCdfFileBuilder builder;
+    const size_t time = builder.AddDimension("time", 0);
+    const size_t longitude = builder.AddDimension("longitude", 3);
+    builder.SetNumberOfRecords(2);
+    builder.AddVariable("longitude", { longitude }, NC_DOUBLE, { 10.0, 20.0, 30.0 });
+    const size_t u = builder.AddVariable("u", { time, longitude }, NC_SHORT, { 1, 2, 3, 4, 5, 6 });
+    builder.AddAttribute(u, "scale_factor", NC_DOUBLE, { 0.5 });
+    builder.AddTextAttribute(u, "units", "m s**-1");
+    return builder;
+}
+
+static void WriteFile(const std::string& fileName, const std::vector<char>& contents)
+{
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size());
+}
+
+// Writes a big-endian 32-bit value at the provided position of the file contents.
+static void Overwrite32(std::vector<char>& contents, size_t position, uint32_t value)
+{
+    contents[position] = (char)(value >> 24);
+    contents[position + 1] = (char)(value >> 16);
+    contents[position + 2] = (char)(value >> 8);
+    contents[position + 3] = (char)value;
+}
+
+// @return the position of the first occurrence of the text in the file contents.
+static size_t Find(const std::vector<char>& contents, const std::string& text)
+{
+    return std::search(contents.begin(), contents.end(), text.begin(), text.end()) - contents.begin();
+}
+
+TEST_CASE("MappedNetCdfFile reads a hand-built classic file", "[MappedNetCdfFile]")
+{
+    TemporaryFile file("MappedNetCdfFileTests_valid.nc");
+    CreateSmallFile().Write(file.path);
+
+    REQUIRE(MappedNetCdfFile::IsClassicFormatFile(file.path));
+
+    MappedNetCdfFile mappedFile;
+    mappedFile.Open(file.path);
+    REQUIRE(mappedFile.GetFormatVersion() == 1);
+    REQUIRE(mappedFile.ContainsVariable("u"));
+    REQUIRE_FALSE(mappedFile.ContainsVariable("v"));
+    REQUIRE(mappedFile.GetDimensionLengths()["time"] == 2);
+    REQUIRE(mappedFile.GetSizeOfVariable("u") == std::vector<size_t>({ 2, 3 }));
+
+    const MappedNetCdfVariable longitude = mappedFile.GetVariable("longitude");
+    REQUIRE(longitude.ValueAt(0) == 10.0);
+    REQUIRE(longitude.ValueAt(2) == 30.0);
+
+    const MappedNetCdfVariable u = mappedFile.GetVariable("u");
+    REQUIRE(u.scaling.scaleFactor == 0.5);
+    for (size_t ii = 0; ii < 6; ++ii)
+    {
+        REQUIRE(u.ValueAt(ii) == 0.5 * (ii + 1));
+    }
+}
+
+TEST_CASE("MappedNetCdfFile rejects truncated headers", "[MappedNetCdfFile]")
+{
+    TemporaryFile file("MappedNetCdfFileTests_truncated.nc");
+    const std::vector<char> contents = CreateSmallFile().Build();
+    const size_t endOfHeader = Find(contents, "m s**-1") + 8 + 4 + 4 + 4;
+
+    for (size_t length : { (size_t)3, (size_t)8, (size_t)20, Find(contents, "longitude") + 2, Find(contents, "scale_factor") + 4, endOfHeader - 2 })
+    {
+        WriteFile(file.path, std::vector<char>(contents.begin(), contents.begin() + length));
+
+        MappedNetCdfFile mappedFile;
+        REQUIRE_THROWS_AS(mappedFile.Open(file.path), NetCdfException);
+    }
+}
+
+TEST_CASE("MappedNetCdfFile rejects data which is truncated", "[MappedNetCdfFile]")
+{
+    TemporaryFile file("MappedNetCdfFileTests_truncatedData.nc");
+    const std::vector<char> contents = CreateSmallFile().Build();
+
+    // the last record of u is cut off
+    WriteFile(file.path, std::vector<char>(contents.begin(), contents.end() - 2));
+
+    MappedNetCdfFile mappedFile;
+    REQUIRE_THROWS_AS(mappedFile.Open(file.path), NetCdfException);
+}
+
+TEST_CASE("MappedNetCdfFile rejects corrupt headers", "[MappedNetCdfFile]")
+{
+    TemporaryFile file("MappedNetCdfFileTests_corrupt.nc");
+    const std::vector<char> valid = CreateSmallFile().Build();
+
+    // the type of the attribute follows directly after its padded name
+    const size_t typeOfScaleFactor = Find(valid, "scale_factor") + 12;
+    const size_t numberOfScaleFactors = typeOfScaleFactor + 4;
+
+    SECTION("Unknown type of attribute")
+    {
+        std::vector<char> contents = valid;
+        Overwrite32(contents, typeOfScaleFactor, 99);
+        WriteFile(file.path, contents);
+
+        MappedNetCdfFile mappedFile;
+        try
+        {
+            mappedFile.Open(file.path);
+            FAIL("Expected an exception");
+        }
+        catch (NetCdfException& e)
+        {
+            REQUIRE(e.statusCode == NC_EBADTYPE);
+        }
+    }
+
+    SECTION("Huge number of attribute values")
+    {
+        std::vector<char> contents = valid;
+        Overwrite32(contents, numberOfScaleFactors, 0xFFFFFFFF);
+        WriteFile(file.path, contents);
+
+        MappedNetCdfFile mappedFile;
+        REQUIRE_THROWS_AS(mappedFile.Open(file.path), NetCdfException);
+    }
+
+    SECTION("Huge number of dimensions")
+    {
+        std::vector<char> contents = valid;
+        Overwrite32(contents, 12, 0x7FFFFFFF);
+        WriteFile(file.path, contents);
+
+        MappedNetCdfFile mappedFile;
+        REQUIRE_THROWS_AS(mappedFile.Open(file.path), NetCdfException);
+    }
+
+    SECTION("Huge number of variables")
+    {
+        std::vector<char> contents = valid;
+        const size_t numberOfVariables = Find(valid, "longitude") + 12 + 4 + 8 + 4; // after the dimensions and the (absent) global attributes
+        REQUIRE(contents[numberOfVariables - 1] == 0x0B);
+        Overwrite32(contents, numberOfVariables, 0xFFFFFFF0);
+        WriteFile(file.path, contents);
+
+        MappedNetCdfFile mappedFile;
+        REQUIRE_THROWS_AS(mappedFile.Open(file.path), NetCdfException);
+    }
+
+    SECTION("Dimensions whose product overflows")
+    {
+        ClassicNetCdfFileBuilder builder;
+        const size_t x = builder.AddDimension("x", 0xFFFFFFFF);
+        const size_t y = builder.AddDimension("y", 0xFFFFFFFF);
+        const size_t z = builder.AddDimension("z", 0xFFFFFFFF);
+        builder.AddVariable("u", { x, y, z }, NC_DOUBLE, {});
+        builder.Write(file.path);
+
+        MappedNetCdfFile mappedFile;
+        REQUIRE_THROWS_AS(mappedFile.Open(file.path), NetCdfException);
+    }
+
+    SECTION("Huge number of records")
+    {
+        std::vector<char> contents = valid;
+        Overwrite32(contents, 4, 0x7FFFFFFF);
+        WriteFile(file.path, contents);
+
+        MappedNetCdfFile mappedFile;
+        REQUIRE_THROWS_AS(mappedFile.Open(file.path), NetCdfException);
+    }
+
+    SECTION("Not a net cdf file")
+    {
+        WriteFile(file.path, std::vector<char>({ 'H', 'D', 'F', 1, 0, 0, 0, 0 }));
+
+        REQUIRE_FALSE(MappedNetCdfFile::IsClassicFormatFile(file.path));
+        MappedNetCdfFile mappedFile;
+        REQUIRE_THROWS_AS(mappedFile.Open(file.path), NetCdfException);
+    }
+}
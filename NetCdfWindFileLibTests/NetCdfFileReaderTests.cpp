@@ -0,0 +1,328 @@
+#include "catch.hpp"
+#include "TestFiles.h"
+#include <NetCdfFileReader.h>
+#include <cmath>
+#include <limits>
+
+// Writes a file with one variable 'x' of the provided type and values, with the provided attributes.
+static void WriteVariable(const std::string& fileName, nc_type type, const std::vector<double>& values, const std::vector<ClassicNetCdfFileBuilder::Attribute>& attributes)
+{
+    ClassicNetCdfFileBuilder builder;
+    const size_t dimension = builder.AddDimension("x", values.size());
+    const size_t variable = builder.AddVariable("x", { dimension }, type, values);
+    for (const ClassicNetCdfFileBuilder::Attribute& attribute : attributes)
+    {
+        builder.AddAttribute(variable, attribute.name, attribute.type, attribute.values);
+    }
+    builder.Write(fileName);
+}
+
+static ClassicNetCdfFileBuilder::Attribute Attribute(const std::string& name, nc_type type, const std::vector<double>& values)
+{
+    ClassicNetCdfFileBuilder::Attribute attribute;
+    attribute.name = name;
+    attribute.type = type;
+    attribute.values = values;
+    return attribute;
+}
+
+TEST_CASE("ReadVariable, masks integer fill values before converting to float", "[NetCdfFileReader]")
+{
+    TemporaryFile file("NetCdfFileReaderTests_int.nc");
+    WriteVariable(file.path, NC_INT, { -2147483647.0, 4.0, -2147483648.0 }, { Attribute("_FillValue", NC_INT, { -2147483647.0 }), Attribute("scale_factor", NC_DOUBLE, { 0.5 }) });
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+    const NetCdfTensor x = reader.ReadVariable("x");
+
+    REQUIRE(std::isnan(x.values[0]));
+    REQUIRE_FALSE(x.IsValid(0));
+    REQUIRE(x.values[1] == 2.0F);
+    REQUIRE(x.IsValid(1));
+    REQUIRE(x.values[2] == (float)(-2147483648.0 * 0.5));
+    REQUIRE(x.IsValid(2));
+}
+
+TEST_CASE("ReadVariable, masks double fill values", "[NetCdfFileReader]")
+{
+    TemporaryFile file("NetCdfFileReaderTests_double.nc");
+    const double fillValue = 1.0000000001;
+    WriteVariable(file.path, NC_DOUBLE, { fillValue, 1.0 }, { Attribute("_FillValue", NC_DOUBLE, { fillValue }) });
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+    const NetCdfTensor x = reader.ReadVariable("x");
+
+    // both values are 1.0F as float, only the first is missing
+    REQUIRE_FALSE(x.IsValid(0));
+    REQUIRE(x.IsValid(1));
+    REQUIRE(x.values[1] == 1.0F);
+}
+
+TEST_CASE("ReadVariable, valid_range is interpreted in the units given by its type", "[NetCdfFileReader]")
+{
+    TemporaryFile file("NetCdfFileReaderTests_validRange.nc");
+    const std::vector<double> stored = { -5.0, 0.0, 50.0, 99.0, 101.0, 200.0 };
+
+    SECTION("Packed units, the attribute has the type of the variable")
+    {
+        WriteVariable(file.path, NC_SHORT, stored, { Attribute("valid_range", NC_SHORT, { 0.0, 100.0 }), Attribute("scale_factor", NC_FLOAT, { 0.1 }) });
+    }
+
+    SECTION("Unpacked units, the attribute has the type of the scale factor")
+    {
+        WriteVariable(file.path, NC_SHORT, stored, { Attribute("scale_factor", NC_FLOAT, { 0.1 }), Attribute("valid_range", NC_FLOAT, { 0.0, 10.0 }) });
+    }
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+    const NetCdfTensor x = reader.ReadVariable("x");
+
+    REQUIRE_FALSE(x.IsValid(0));
+    REQUIRE(x.IsValid(1));
+    REQUIRE(x.IsValid(2));
+    REQUIRE(x.IsValid(3));
+    REQUIRE_FALSE(x.IsValid(4));
+    REQUIRE_FALSE(x.IsValid(5));
+}
+
+TEST_CASE("ReadVariable, unpacked valid_min with a negative scale factor", "[NetCdfFileReader]")
+{
+    TemporaryFile file("NetCdfFileReaderTests_negativeScale.nc");
+    WriteVariable(file.path, NC_SHORT, { -10.0, 0.0, 10.0 }, { Attribute("scale_factor", NC_DOUBLE, { -0.1 }), Attribute("valid_min", NC_DOUBLE, { 0.0 }) });
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+    const NetCdfTensor x = reader.ReadVariable("x");
+
+    // the unpacked values are 1.0, 0.0 and -1.0
+    REQUIRE(x.IsValid(0));
+    REQUIRE(x.IsValid(1));
+    REQUIRE_FALSE(x.IsValid(2));
+}
+
+TEST_CASE("TypedNetCdfTensor, integer values beyond the precision of float are returned exactly", "[TypedNetCdfTensor]")
+{
+    // seconds since 1970, these are larger than 2^24 and cannot all be represented by a float
+    TypedNetCdfTensor<int> time;
+    time.values = { 1500000001, 1500000002, 1500000003 };
+
+    REQUIRE(time[0] == 1500000001.0);
+    REQUIRE(time[1] == 1500000002.0);
+    REQUIRE(time[2] == 1500000003.0);
+    REQUIRE((float)time.values[0] == (float)time.values[1]);
+}
+
+TEST_CASE("TypedNetCdfTensor, applies linear scaling and missing values", "[TypedNetCdfTensor]")
+{
+    TypedNetCdfTensor<short> values;
+    values.values = { 10, -32767 };
+    values.scaling.scaleFactor = 0.5;
+    values.scaling.offset = 1.0;
+    values.missingValues.invalidValues = { -32767 };
+
+    REQUIRE(values[0] == 6.0);
+    REQUIRE(values.IsValid(0));
+    REQUIRE_FALSE(values.IsValid(1));
+}
+
+TEST_CASE("ReadVariable and ReadSlab of a type, read the values from the file without converting them to float", "[NetCdfFileReader]")
+{
+    TemporaryFile file("NetCdfFileReaderTests_typed.nc");
+    {
+        // seconds since 1970, these are larger than 2^24 and cannot all be represented by a float
+        ClassicNetCdfFileBuilder builder;
+        const size_t time = builder.AddDimension("time", 4);
+        const size_t timeIdx = builder.AddVariable("time", { time }, NC_INT, { 1500000001.0, 1500000002.0, 1500000003.0, 2147483647.0 });
+        builder.AddTextAttribute(timeIdx, "units", "seconds since 1970-01-01 00:00:00");
+        builder.AddVariable("elapsed", { time }, NC_DOUBLE, { 1.0000000001, 1.0000000002, 1e15 + 1.0, -0.1 });
+        builder.Write(file.path);
+    }
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+
+    const TypedNetCdfTensor<int> times = reader.ReadVariable<int>("time");
+    REQUIRE(times.name == "time");
+    REQUIRE(times.size == std::vector<size_t>({ 4 }));
+    REQUIRE(times.values == std::vector<int>({ 1500000001, 1500000002, 1500000003, 2147483647 }));
+    REQUIRE(times[0] == 1500000001.0);
+    REQUIRE(times[3] == 2147483647.0);
+    REQUIRE((float)times.values[0] == (float)times.values[1]);
+
+    const TypedNetCdfTensor<int> someTimes = reader.ReadSlab<int>("time", { 1 }, { 2 });
+    REQUIRE(someTimes.size == std::vector<size_t>({ 2 }));
+    REQUIRE(someTimes.values == std::vector<int>({ 1500000002, 1500000003 }));
+
+    const TypedNetCdfTensor<double> elapsed = reader.ReadVariable<double>("elapsed");
+    REQUIRE(elapsed.values == std::vector<double>({ 1.0000000001, 1.0000000002, 1e15 + 1.0, -0.1 }));
+    REQUIRE(elapsed[2] == 1e15 + 1.0);
+}
+
+TEST_CASE("ReadSlabAsFloat into a buffer, masks missing values and returns their validity", "[NetCdfFileReader]")
+{
+    TemporaryFile file("NetCdfFileReaderTests_buffer.nc");
+    WriteVariable(file.path, NC_SHORT, { 1.0, -32767.0, 3.0, 4.0 }, { Attribute("_FillValue", NC_SHORT, { -32767.0 }), Attribute("scale_factor", NC_DOUBLE, { 2.0 }) });
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+
+    std::vector<float> values(3);
+    std::vector<uint8_t> validity;
+    reader.ReadSlabAsFloat("x", { 0 }, { 3 }, values.data(), values.size(), validity);
+
+    REQUIRE(values[0] == 2.0F);
+    REQUIRE(std::isnan(values[1]));
+    REQUIRE(values[2] == 6.0F);
+    REQUIRE(validity == std::vector<uint8_t>({ 0x05 }));
+
+    values.resize(4);
+    reader.ReadVariableAsFloat("x", values.data(), values.size(), validity);
+    REQUIRE(values[3] == 8.0F);
+    REQUIRE(validity == std::vector<uint8_t>({ 0x0D }));
+
+    REQUIRE_THROWS_AS(reader.ReadVariableAsFloat("x", values.data(), 3, validity), NetCdfException);
+}
+
+// Calls the provided function.
+//  @return the status code of the NetCdfException thrown by it, or NC_NOERR if none was thrown.
+template<class Function>
+static int GetStatusCode(Function function)
+{
+    try
+    {
+        function();
+    }
+    catch (const NetCdfException& e)
+    {
+        return e.statusCode;
+    }
+    return NC_NOERR;
+}
+
+TEST_CASE("ReadSlab, reads the values of the slab and nothing else", "[NetCdfFileReader]")
+{
+    TemporaryFile file("NetCdfFileReaderTests_slab.nc");
+    {
+        // a variable of size [3, 4], where the value is 10 * row + column
+        ClassicNetCdfFileBuilder builder;
+        const size_t y = builder.AddDimension("y", 3);
+        const size_t x = builder.AddDimension("x", 4);
+        std::vector<double> values;
+        for (size_t ii = 0; ii < 12; ++ii)
+        {
+            values.push_back((double)(10 * (ii / 4) + ii % 4));
+        }
+        builder.AddVariable("u", { y, x }, NC_FLOAT, values);
+        builder.Write(file.path);
+    }
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+
+    const NetCdfTensor slab = reader.ReadSlab("u", { 1, 1 }, { 2, 3 });
+    REQUIRE(slab.name == "u");
+    REQUIRE(slab.size == std::vector<size_t>({ 2, 3 }));
+    REQUIRE(slab.values == std::vector<float>({ 11.0F, 12.0F, 13.0F, 21.0F, 22.0F, 23.0F }));
+
+    const NetCdfTensor row = reader.ReadSlab("u", { 2, 0 }, { 1, 4 });
+    REQUIRE(row.size == std::vector<size_t>({ 1, 4 }));
+    REQUIRE(row.values == std::vector<float>({ 20.0F, 21.0F, 22.0F, 23.0F }));
+
+    SECTION("A slab with the wrong number of dimensions throws")
+    {
+        REQUIRE(GetStatusCode([&]() { reader.ReadSlab("u", { 0 }, { 1 }); }) == NC_EINVALCOORDS);
+        REQUIRE(GetStatusCode([&]() { reader.ReadSlab("u", { 0, 0, 0 }, { 1, 1, 1 }); }) == NC_EINVALCOORDS);
+    }
+
+    SECTION("A slab starting after the end of the variable throws")
+    {
+        REQUIRE(GetStatusCode([&]() { reader.ReadSlab("u", { 4, 0 }, { 0, 1 }); }) == NC_EINVALCOORDS);
+    }
+
+    SECTION("A slab extending past the end of the variable throws")
+    {
+        REQUIRE(GetStatusCode([&]() { reader.ReadSlab("u", { 2, 2 }, { 1, 3 }); }) == NC_EEDGE);
+        REQUIRE(GetStatusCode([&]() { reader.ReadSlab("u", { 0, 0 }, { 4, 1 }); }) == NC_EEDGE);
+    }
+}
+
+TEST_CASE("ReadSlab, a huge slab outside of the variable throws before any memory is allocated", "[NetCdfFileReader]")
+{
+    TemporaryFile file("NetCdfFileReaderTests_hugeSlab.nc");
+    WriteVariable(file.path, NC_SHORT, { 1.0, -32767.0, 3.0, 4.0 }, { Attribute("_FillValue", NC_SHORT, { -32767.0 }) });
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+
+    const size_t hugeCount = std::numeric_limits<size_t>::max() / 8;
+    NetCdfTensor result;
+    REQUIRE(GetStatusCode([&]() { reader.ReadSlab("x", { 0 }, { hugeCount }, result); }) == NC_EEDGE);
+    REQUIRE(result.values.empty());
+    REQUIRE(GetStatusCode([&]() { reader.ReadSlab<int>("x", { 0 }, { hugeCount }); }) == NC_EEDGE);
+    REQUIRE(GetStatusCode([&]() { reader.ReadSlabAsFloat("x", { 0 }, { hugeCount }); }) == NC_EEDGE);
+
+    std::vector<float> values(4);
+    std::vector<uint8_t> validity;
+    REQUIRE(GetStatusCode([&]() { reader.ReadSlabAsFloat("x", { 1 }, { 4 }, values.data(), values.size(), validity); }) == NC_EEDGE);
+
+    // the messages name the variable
+    try
+    {
+        reader.ReadSlab("x", { 0, 0 }, { hugeCount, hugeCount });
+        FAIL("The slab has the wrong number of dimensions");
+    }
+    catch (const NetCdfException& e)
+    {
+        REQUIRE(std::string(e.what()).find("variable 'x'") != std::string::npos);
+    }
+}
+
+TEST_CASE("The catalogue of an opened file, answers queries on the variables", "[NetCdfFileReader]")
+{
+    TemporaryFile file("NetCdfFileReaderTests_catalogue.nc");
+    {
+        ClassicNetCdfFileBuilder builder;
+        const size_t time = builder.AddDimension("time", 0);
+        const size_t latitude = builder.AddDimension("latitude", 3);
+        const size_t longitude = builder.AddDimension("longitude", 2);
+        builder.SetNumberOfRecords(4);
+
+        builder.AddVariable("latitude", { latitude }, NC_FLOAT, { 10.0, 20.0, 30.0 });
+        const size_t uIdx = builder.AddVariable("u", { time, latitude, longitude }, NC_SHORT, std::vector<double>(24, 1.0));
+        builder.AddAttribute(uIdx, "scale_factor", NC_DOUBLE, { 0.5 });
+        builder.AddAttribute(uIdx, "add_offset", NC_DOUBLE, { 3.0 });
+        builder.AddVariable("v", { longitude, latitude }, NC_FLOAT, std::vector<double>(6, 2.0));
+        builder.Write(file.path);
+    }
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+
+    REQUIRE(reader.ContainsVariable("u"));
+    REQUIRE(reader.ContainsVariable("latitude"));
+    REQUIRE_FALSE(reader.ContainsVariable("w"));
+
+    const int latitudeIdx = reader.GetIndexOfVariable("latitude");
+    const int uIdx = reader.GetIndexOfVariable("u");
+    const int vIdx = reader.GetIndexOfVariable("v");
+    REQUIRE(latitudeIdx == 0);
+    REQUIRE(uIdx == 1);
+    REQUIRE(vIdx == 2);
+    REQUIRE(GetStatusCode([&]() { reader.GetIndexOfVariable("w"); }) == NC_ENOTVAR);
+
+    REQUIRE(reader.GetSizeOfVariable("u") == std::vector<size_t>({ 4, 3, 2 }));
+    REQUIRE(reader.GetSizeOfVariable(vIdx) == std::vector<size_t>({ 2, 3 }));
+    REQUIRE(reader.GetSizeOfVariable(latitudeIdx) == std::vector<size_t>({ 3 }));
+
+    REQUIRE(reader.GetDimensionIndicesOfVariable(uIdx) == std::vector<int>({ 0, 1, 2 }));
+    REQUIRE(reader.GetDimensionIndicesOfVariable(vIdx) == std::vector<int>({ 2, 1 }));
+    REQUIRE(reader.GetDimensionIndicesOfVariable(latitudeIdx) == std::vector<int>({ 1 }));
+
+    LinearScaling scaling;
+    REQUIRE(reader.GetLinearScalingForVariable(uIdx, scaling));
+    REQUIRE(scaling.scaleFactor == 0.5);
+    REQUIRE(scaling.offset == 3.0);
+    REQUIRE_FALSE(reader.GetLinearScalingForVariable(vIdx, scaling));
+    REQUIRE_FALSE(reader.GetLinearScalingForVariable(7, scaling));
+}
@@ -0,0 +1,157 @@
+#include "catch.hpp"
+#include "TestFiles.h"
+#include <NetCdfMultiFileDataset.h>
+#include <NetCdfException.h>
+
+// The value of the variable 'u' at one time step and one index into the (2x2x2) grid.
+static double ValueOfU(double time, size_t gridIdx)
+{
+    return 100.0 * time + gridIdx;
+}
+
+// Writes a file with a time coordinate with the provided values and attributes and
+//  a four-dimensional variable 'u' on a grid of 2x2x2 (level, latitude, longitude).
+static void WriteFile(const std::string& fileName, const std::vector<double>& times, const std::string& units, const std::string& calendar = "")
+{
+    ClassicNetCdfFileBuilder builder;
+    const size_t timeDimension = builder.AddDimension("time", 0);
+    const size_t level = builder.AddDimension("level", 2);
+    const size_t latitude = builder.AddDimension("latitude", 2);
+    const size_t longitude = builder.AddDimension("longitude", 2);
+    builder.SetNumberOfRecords(times.size());
+
+    const size_t time = builder.AddVariable("time", { timeDimension }, NC_DOUBLE, times);
+    builder.AddTextAttribute(time, "units", units);
+    if (calendar.size() > 0)
+    {
+        builder.AddTextAttribute(time, "calendar", calendar);
+    }
+
+    std::vector<double> u;
+    for (double t : times)
+    {
+        for (size_t gridIdx = 0; gridIdx < 8; ++gridIdx)
+        {
+            u.push_back(ValueOfU(t, gridIdx));
+        }
+    }
+    builder.AddVariable("u", { timeDimension, level, latitude, longitude }, NC_FLOAT, u);
+
+    builder.Write(fileName);
+}
+
+static const std::string HoursSince2000 = "hours since 2000-01-01 00:00:00";
+
+TEST_CASE("NetCdfMultiFileDataset concatenates the files along time", "[NetCdfMultiFileDataset]")
+{
+    TemporaryFile january("NetCdfMultiFileDatasetTests_1.nc");
+    TemporaryFile february("NetCdfMultiFileDatasetTests_2.nc");
+    TemporaryFile march("NetCdfMultiFileDatasetTests_3.nc");
+    WriteFile(january.path, { 0.0, 1.0 }, HoursSince2000);
+    WriteFile(february.path, { 2.0, 3.0, 4.0 }, HoursSince2000, "gregorian");
+    WriteFile(march.path, { 5.0 }, HoursSince2000, "standard");
+
+    // the files are ordered by time, not by the order they are given in
+    NetCdfMultiFileDataset dataset;
+    dataset.Open({ march.path, january.path, february.path });
+
+    REQUIRE(dataset.NumberOfFiles() == 3);
+    REQUIRE(dataset.NumberOfTimeSteps() == 6);
+    REQUIRE(dataset.GetTimes() == std::vector<double>({ 0.0, 1.0, 2.0, 3.0, 4.0, 5.0 }));
+    REQUIRE(dataset.GetSizeOfVariable("u") == std::vector<size_t>({ 6, 2, 2, 2 }));
+
+    SECTION("Read the full variable")
+    {
+        const NetCdfTensor u = dataset.ReadVariable("u");
+        REQUIRE(u.values.size() == 48);
+        for (size_t ii = 0; ii < u.values.size(); ++ii)
+        {
+            REQUIRE(u.values[ii] == ValueOfU((double)(ii / 8), ii % 8));
+        }
+    }
+
+    SECTION("Read a slab spanning two files")
+    {
+        const NetCdfTensor u = dataset.ReadSlab("u", { 1, 1, 0, 1 }, { 2, 1, 2, 1 });
+        REQUIRE(u.size == std::vector<size_t>({ 2, 1, 2, 1 }));
+        REQUIRE(u.values == std::vector<float>({ 105.0f, 107.0f, 205.0f, 207.0f }));
+    }
+
+    SECTION("Find the time steps in a window of time")
+    {
+        const double startOf2000 = ParseDateTime("2000-01-01 00:00:00");
+
+        TimeRange range = dataset.FindTimeRange(startOf2000 + 1.5 * 3600.0, startOf2000 + 4.0 * 3600.0);
+        REQUIRE(range.first == 2);
+        REQUIRE(range.count == 3);
+
+        range = dataset.FindTimeRange(startOf2000 + 10.0 * 3600.0, startOf2000 + 20.0 * 3600.0);
+        REQUIRE(range.count == 0);
+    }
+
+    SECTION("Read the neighbourhood of a point in a window of time")
+    {
+        TimeRange range;
+        range.first = 4;
+        range.count = 2;
+
+        std::vector<double> localIndices;
+        const NetCdfTensor cube = dataset.ReadNeighbourhood("u", { 0.5, 0.5, 0.5 }, range, localIndices);
+        REQUIRE(cube.size == std::vector<size_t>({ 2, 2, 2, 2 }));
+        for (size_t ii = 0; ii < cube.values.size(); ++ii)
+        {
+            REQUIRE(cube.values[ii] == ValueOfU(4.0 + ii / 8, ii % 8));
+        }
+
+        range.first = 5;
+        range.count = 2;
+        REQUIRE_THROWS_AS(dataset.ReadNeighbourhood("u", { 0.5, 0.5, 0.5 }, range, localIndices), NetCdfException);
+    }
+}
+
+TEST_CASE("NetCdfMultiFileDataset rejects files whose time steps overlap", "[NetCdfMultiFileDataset]")
+{
+    TemporaryFile first("NetCdfMultiFileDatasetTests_overlap1.nc");
+    TemporaryFile second("NetCdfMultiFileDatasetTests_overlap2.nc");
+    WriteFile(first.path, { 0.0, 1.0, 2.0 }, HoursSince2000);
+
+    SECTION("Overlapping files")
+    {
+        WriteFile(second.path, { 2.0, 3.0 }, HoursSince2000);
+
+        NetCdfMultiFileDataset dataset;
+        REQUIRE_THROWS_AS(dataset.Open({ first.path, second.path }), NetCdfException);
+        REQUIRE(dataset.NumberOfFiles() == 0);
+    }
+
+    SECTION("Time steps which are not sorted")
+    {
+        WriteFile(second.path, { 5.0, 4.0 }, HoursSince2000);
+
+        NetCdfMultiFileDataset dataset;
+        REQUIRE_THROWS_AS(dataset.Open({ first.path, second.path }), NetCdfException);
+    }
+}
+
+TEST_CASE("NetCdfMultiFileDataset rejects files with different units of time", "[NetCdfMultiFileDataset]")
+{
+    TemporaryFile first("NetCdfMultiFileDatasetTests_units1.nc");
+    TemporaryFile second("NetCdfMultiFileDatasetTests_units2.nc");
+    WriteFile(first.path, { 0.0, 1.0 }, HoursSince2000);
+
+    SECTION("Different units")
+    {
+        WriteFile(second.path, { 7200.0, 10800.0 }, "seconds since 2000-01-01 00:00:00");
+
+        NetCdfMultiFileDataset dataset;
+        REQUIRE_THROWS_AS(dataset.Open({ first.path, second.path }), NetCdfException);
+    }
+
+    SECTION("Different calendars")
+    {
+        WriteFile(second.path, { 2.0, 3.0 }, HoursSince2000, "noleap");
+
+        NetCdfMultiFileDataset dataset;
+        REQUIRE_THROWS_AS(dataset.Open({ first.path, second.path }), NetCdfException);
+    }
+}
@@ -0,0 +1,126 @@
+#include "catch.hpp"
+#include "TestFiles.h"
+#include <NetCdfReaderPool.h>
+#include <cstring>
+#include <thread>
+
+// Writes a file with two packed variables 'u' and 'v' of size [32, 2, 4, 8], 'u' has a fill value.
+static void WritePackedFile(const std::string& fileName)
+{
+    ClassicNetCdfFileBuilder builder;
+    const size_t time = builder.AddDimension("time", 0);
+    const size_t level = builder.AddDimension("level", 2);
+    const size_t latitude = builder.AddDimension("latitude", 4);
+    const size_t longitude = builder.AddDimension("longitude", 8);
+    builder.SetNumberOfRecords(32);
+
+    std::vector<double> u;
+    std::vector<double> v;
+    for (size_t ii = 0; ii < 32 * 2 * 4 * 8; ++ii)
+    {
+        u.push_back((ii % 97 == 0) ? -32767.0 : (double)((ii * 7) % 2000) - 1000.0);
+        v.push_back((double)((ii * 13) % 3000) - 1500.0);
+    }
+
+    const size_t uIdx = builder.AddVariable("u", { time, level, latitude, longitude }, NC_SHORT, u);
+    builder.AddAttribute(uIdx, "scale_factor", NC_DOUBLE, { 0.01 });
+    builder.AddAttribute(uIdx, "add_offset", NC_DOUBLE, { 2.5 });
+    builder.AddAttribute(uIdx, "_FillValue", NC_SHORT, { -32767.0 });
+
+    const size_t vIdx = builder.AddVariable("v", { time, level, latitude, longitude }, NC_SHORT, v);
+    builder.AddAttribute(vIdx, "scale_factor", NC_DOUBLE, { 0.02 });
+
+    builder.Write(fileName);
+}
+
+static void RequireIdentical(const NetCdfTensor& actual, const NetCdfTensor& expected)
+{
+    // the values must be bit-identical, this also compares the missing values which are NaN
+    REQUIRE(actual.size == expected.size);
+    REQUIRE(actual.values.size() == expected.values.size());
+    REQUIRE(std::memcmp(actual.values.data(), expected.values.data(), actual.values.size() * sizeof(float)) == 0);
+    REQUIRE(actual.validity == expected.validity);
+}
+
+TEST_CASE("NetCdfReaderPool, concurrent reads give the same result as one reader", "[NetCdfReaderPool]")
+{
+    TemporaryFile file("NetCdfReaderPoolTests.nc");
+    WritePackedFile(file.path);
+
+    NetCdfFileReader reader;
+    reader.Open(file.path);
+    const NetCdfTensor expectedU = reader.ReadVariable("u");
+    const NetCdfTensor expectedV = reader.ReadVariable("v");
+    REQUIRE(expectedU.validity.size() > 0);
+
+    NetCdfReaderPool pool;
+    pool.Open(file.path, 4);
+    REQUIRE(pool.NumberOfReaders() == 4);
+
+    SECTION("One variable split over all readers")
+    {
+        RequireIdentical(pool.ReadVariable("u"), expectedU);
+        RequireIdentical(pool.ReadVariable("v"), expectedV);
+    }
+
+    SECTION("Several variables at once")
+    {
+        const std::vector<NetCdfTensor> result = pool.ReadVariables({ "u", "v", "u", "v", "u" });
+        REQUIRE(result.size() == 5);
+        for (size_t ii = 0; ii < result.size(); ++ii)
+        {
+            RequireIdentical(result[ii], (ii % 2 == 0) ? expectedU : expectedV);
+        }
+    }
+
+    SECTION("Many slabs and neighbourhoods at once")
+    {
+        std::vector<std::future<NetCdfTensor>> slabs;
+        std::vector<NetCdfTensor> expectedSlabs;
+        std::vector<std::future<NetCdfTensor>> cubes;
+        std::vector<NetCdfTensor> expectedCubes;
+        for (size_t ii = 0; ii < 32; ++ii)
+        {
+            const std::vector<size_t> start = { ii, ii % 2, 0, ii % 5 };
+            const std::vector<size_t> count = { 32 - ii, 1, 4, 3 };
+            slabs.push_back(pool.ReadSlabAsync("u", start, count));
+            expectedSlabs.push_back(reader.ReadSlab("u", start, count));
+
+            const std::vector<double> spatialIndices = { 0.5, 0.25 * (ii % 12), 0.2 * ii };
+            std::vector<double> localIndices;
+            std::vector<double> expectedLocalIndices;
+            cubes.push_back(pool.ReadNeighbourhoodAsync("v", spatialIndices, localIndices));
+            expectedCubes.push_back(reader.ReadNeighbourhood("v", spatialIndices, expectedLocalIndices));
+            REQUIRE(localIndices == expectedLocalIndices);
+        }
+
+        for (size_t ii = 0; ii < slabs.size(); ++ii)
+        {
+            RequireIdentical(slabs[ii].get(), expectedSlabs[ii]);
+            RequireIdentical(cubes[ii].get(), expectedCubes[ii]);
+        }
+    }
+
+    SECTION("Leases taken from several threads")
+    {
+        std::vector<NetCdfTensor> results(8);
+        std::vector<std::thread> threads;
+        for (size_t threadIdx = 0; threadIdx < results.size(); ++threadIdx)
+        {
+            threads.push_back(std::thread([&pool, &results, threadIdx]()
+            {
+                NetCdfReaderPool::Lease lease = pool.Acquire();
+                results[threadIdx] = lease->ReadVariable((threadIdx % 2 == 0) ? "u" : "v");
+            }));
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (size_t ii = 0; ii < results.size(); ++ii)
+        {
+            RequireIdentical(results[ii], (ii % 2 == 0) ? expectedU : expectedV);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#include "catch.hpp"
+#include <NetCdfTensorPool.h>
+
+TEST_CASE("NetCdfTensorPool, released tensor is reused without reallocating", "[NetCdfTensorPool]")
+{
+    NetCdfTensorPool pool;
+
+    NetCdfTensor tensor = pool.Acquire(1000);
+    tensor.values.resize(1000);
+    tensor.name = "u";
+    const float* memory = tensor.values.data();
+
+    pool.Release(std::move(tensor));
+    REQUIRE(pool.NumberOfTensors() == 1);
+
+    NetCdfTensor reused = pool.Acquire(1000);
+    REQUIRE(reused.values.size() == 0);
+    REQUIRE(reused.name == "");
+    reused.values.resize(1000);
+    REQUIRE(reused.values.data() == memory);
+    REQUIRE(pool.NumberOfTensors() == 0);
+}
+
+TEST_CASE("NetCdfTensorPool, returns smallest tensor which is large enough", "[NetCdfTensorPool]")
+{
+    NetCdfTensorPool pool;
+    for (size_t size : { 100, 10000, 1000 })
+    {
+        NetCdfTensor tensor;
+        tensor.values.resize(size);
+        pool.Release(std::move(tensor));
+    }
+
+    NetCdfTensor tensor = pool.Acquire(500);
+
+    REQUIRE(tensor.values.capacity() >= 1000);
+    REQUIRE(tensor.values.capacity() < 10000);
+}
+
+TEST_CASE("NetCdfTensorPool, keeps at most the maximum number of tensors", "[NetCdfTensorPool]")
+{
+    NetCdfTensorPool pool(2);
+    for (size_t size : { 100, 300, 200 })
+    {
+        NetCdfTensor tensor;
+        tensor.values.resize(size);
+        pool.Release(std::move(tensor));
+    }
+
+    REQUIRE(pool.NumberOfTensors() == 2);
+    REQUIRE(pool.Acquire(0).values.capacity() >= 200);
+}
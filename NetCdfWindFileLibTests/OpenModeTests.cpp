@@ -0,0 +1,98 @@
+#include "catch.hpp"
+#include "TestFiles.h"
+#include <NetCdfFileReader.h>
+#include <cstring>
+
+TEST_CASE("SelectOpenMode, small files are read into memory", "[SelectOpenMode]")
+{
+    const uint64_t maximumDisklessSize = (uint64_t)1 << 28;
+
+    REQUIRE(SelectOpenMode(1000, true, NetCdfAccessPattern::TimeSeriesAtPoint, maximumDisklessSize) == NetCdfOpenMode::Diskless);
+    REQUIRE(SelectOpenMode(1000, false, NetCdfAccessPattern::WholeField, maximumDisklessSize) == NetCdfOpenMode::Diskless);
+    REQUIRE(SelectOpenMode(maximumDisklessSize, false, NetCdfAccessPattern::TimeSlab, maximumDisklessSize) == NetCdfOpenMode::Diskless);
+}
+
+TEST_CASE("SelectOpenMode, large classic files read point by point are memory mapped", "[SelectOpenMode]")
+{
+    const uint64_t maximumDisklessSize = (uint64_t)1 << 28;
+    const uint64_t largeFile = (uint64_t)1 << 34;
+
+    REQUIRE(SelectOpenMode(largeFile, true, NetCdfAccessPattern::TimeSeriesAtPoint, maximumDisklessSize) == NetCdfOpenMode::MemoryMapped);
+
+    // NetCdf-4 files cannot be mapped and whole fields are better read sequentially.
+    REQUIRE(SelectOpenMode(largeFile, false, NetCdfAccessPattern::TimeSeriesAtPoint, maximumDisklessSize) == NetCdfOpenMode::Normal);
+    REQUIRE(SelectOpenMode(largeFile, true, NetCdfAccessPattern::WholeField, maximumDisklessSize) == NetCdfOpenMode::Normal);
+    REQUIRE(SelectOpenMode(largeFile, true, NetCdfAccessPattern::TimeSlab, maximumDisklessSize) == NetCdfOpenMode::Normal);
+}
+
+// @return the contents of a file with one packed variable 'u' of size [3, 4].
+static std::vector<char> CreateFileContents()
+{
+    ClassicNetCdfFileBuilder builder;
+    const size_t time = builder.AddDimension("time", 3);
+    const size_t x = builder.AddDimension("x", 4);
+    const size_t u = builder.AddVariable("u", { time, x }, NC_SHORT, { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, -32767.0, 8.0, 9.0, 10.0, 11.0, 12.0 });
+    builder.AddAttribute(u, "scale_factor", NC_DOUBLE, { 0.5 });
+    builder.AddAttribute(u, "_FillValue", NC_SHORT, { -32767.0 });
+    return builder.Build();
+}
+
+TEST_CASE("NetCdfFileReader, every open mode reads the same values", "[OpenMode]")
+{
+    TemporaryFile file("OpenModeTests.nc");
+    const std::vector<char> contents = CreateFileContents();
+    {
+        std::ofstream stream(file.path, std::ios::binary);
+        stream.write(contents.data(), contents.size());
+    }
+    REQUIRE(GetSizeOfFile(file.path) == contents.size());
+    REQUIRE(GetSizeOfFile("FileWhichDoesNotExist.nc") == 0);
+
+    NetCdfFileReader expectedReader;
+    expectedReader.Open(file.path);
+    const NetCdfTensor expected = expectedReader.ReadVariable("u");
+    REQUIRE(expected.values[1] == 1.0F);
+    REQUIRE_FALSE(expected.IsValid(6));
+
+    // a library built without mmap support opens the file normally instead of memory mapping it
+    for (NetCdfOpenMode mode : { NetCdfOpenMode::Diskless, NetCdfOpenMode::MemoryMapped, NetCdfOpenMode::Automatic })
+    {
+        NetCdfFileReader reader;
+        reader.Open(file.path, mode, NetCdfAccessPattern::TimeSeriesAtPoint);
+        const NetCdfTensor u = reader.ReadVariable("u");
+        REQUIRE(u.size == expected.size);
+        REQUIRE(u.validity == expected.validity);
+        REQUIRE(std::memcmp(u.values.data(), expected.values.data(), u.values.size() * sizeof(float)) == 0);
+    }
+}
+
+TEST_CASE("NetCdfFileReader, OpenFromMemory reads a file held in memory", "[OpenMode]")
+{
+    NetCdfFileReader reader;
+
+    SECTION("A valid file")
+    {
+        reader.OpenFromMemory(CreateFileContents(), "OpenFromMemory.nc");
+        REQUIRE(reader.ContainsVariable("u"));
+
+        const NetCdfTensor u = reader.ReadVariable("u");
+        REQUIRE(u.size == std::vector<size_t>({ 3, 4 }));
+        REQUIRE(u.values[0] == 0.5F);
+        REQUIRE(u.values[11] == 6.0F);
+        REQUIRE_FALSE(u.IsValid(6));
+        REQUIRE(u.IsValid(7));
+
+        // the contents are kept until the reader is closed
+        const NetCdfTensor slab = reader.ReadSlab("u", { 2, 1 }, { 1, 2 });
+        REQUIRE(slab.values == std::vector<float>({ 5.0F, 5.5F }));
+        reader.Close();
+        REQUIRE_FALSE(reader.ContainsVariable("u"));
+    }
+
+    SECTION("Contents which are not a net cdf file")
+    {
+        const std::string text = "this is not a net cdf file";
+        REQUIRE_THROWS_AS(reader.OpenFromMemory(std::vector<char>(text.begin(), text.end())), NetCdfException);
+        REQUIRE_FALSE(reader.ContainsVariable("u"));
+    }
+}
@@ -0,0 +1,265 @@
+#include "catch.hpp"
+#include "TestFiles.h"
+#include <PointMajorCache.h>
+#include <NetCdfFileReader.h>
+#include <limits>
+
+// Creates a time-major tensor with the provided size, where each value is unique.
+static NetCdfTensor CreateTimeMajorTensor(const std::vector<size_t>& size)
+{
+    NetCdfTensor tensor;
+    tensor.size = size;
+    tensor.values.resize(size[0] * size[1] * size[2] * size[3]);
+    for (size_t ii = 0; ii < tensor.values.size(); ++ii)
+    {
+        tensor.values[ii] = (float)ii;
+    }
+    return tensor;
+}
+
+// @return the block of all time steps of the consecutive cells starting at firstCell, with the provided size.
+static NetCdfTensor SelectCells(const NetCdfTensor& tensor, size_t firstCell, const std::vector<size_t>& size)
+{
+    const size_t cellsPerTimeStep = tensor.size[1] * tensor.size[2] * tensor.size[3];
+    const size_t cellsInBlock = size[1] * size[2] * size[3];
+
+    NetCdfTensor block;
+    block.size = size;
+    for (size_t timeIdx = 0; timeIdx < size[0]; ++timeIdx)
+    {
+        const auto timeStep = tensor.values.begin() + timeIdx * cellsPerTimeStep + firstCell;
+        block.values.insert(block.values.end(), timeStep, timeStep + cellsInBlock);
+    }
+    return block;
+}
+
+// @return the value at the provided indices of the time-major tensor.
+static float ValueAt(const NetCdfTensor& tensor, size_t time, size_t level, size_t latitude, size_t longitude)
+{
+    return tensor.values[((time * tensor.size[1] + level) * tensor.size[2] + latitude) * tensor.size[3] + longitude];
+}
+
+TEST_CASE("PointMajorCache, neighbourhood read from the cache equals the time-major values", "[PointMajorCache]")
+{
+    TemporaryFile file("PointMajorCacheTest.pmc");
+    const std::vector<size_t> size = { 10, 3, 4, 5 };
+    const NetCdfTensor u = CreateTimeMajorTensor(size);
+
+    FileFingerprint sourceFingerprint;
+    sourceFingerprint.fileSize = 1234;
+    sourceFingerprint.headerHash = 5678;
+
+    {
+        PointMajorCacheWriter writer;
+        writer.Create(file.path, sourceFingerprint, { { "u", size } }, { { "level", { 1000.0, 900.0, 800.0 } } });
+
+        // Write in blocks of cells, the first two levels and then one row of latitude at a time.
+        writer.WriteCells("u", 0, SelectCells(u, 0, { 10, 2, 4, 5 }));
+        for (size_t latitudeIdx = 0; latitudeIdx < 4; ++latitudeIdx)
+        {
+            writer.WriteCells("u", 40 + 5 * latitudeIdx, SelectCells(u, 40 + 5 * latitudeIdx, { 10, 1, 1, 5 }));
+        }
+
+        REQUIRE_THROWS_AS(writer.WriteCells("u", 41, SelectCells(u, 40, { 10, 1, 4, 5 })), NetCdfException);
+        REQUIRE_THROWS_AS(writer.WriteCells("v", 0, u), NetCdfException);
+
+        writer.Close();
+    }
+
+    PointMajorCacheFile cache;
+    cache.Open(file.path);
+    REQUIRE(cache.GetSourceFingerprint() == sourceFingerprint);
+    REQUIRE(cache.GetCoordinate("level") == std::vector<double>({ 1000.0, 900.0, 800.0 }));
+    REQUIRE_FALSE(cache.ContainsCoordinate("time"));
+    REQUIRE_THROWS_AS(cache.GetCoordinate("time"), NetCdfException);
+    REQUIRE(cache.ContainsVariable("u"));
+    REQUIRE_FALSE(cache.ContainsVariable("v"));
+    REQUIRE(cache.GetSizeOfVariable("u") == size);
+
+    SECTION("Full time series")
+    {
+        std::vector<double> localIndices;
+        NetCdfTensor cube = cache.ReadNeighbourhood("u", { 1.5, 2.25, 3.75 }, localIndices);
+
+        REQUIRE(cube.size == std::vector<size_t>{ 10, 2, 2, 2 });
+        REQUIRE(cube.validity.empty());
+        REQUIRE(localIndices[0] == Approx(0.5));
+        REQUIRE(localIndices[1] == Approx(0.25));
+        REQUIRE(localIndices[2] == Approx(0.75));
+
+        for (size_t timeIdx = 0; timeIdx < 10; ++timeIdx)
+        {
+            for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+            {
+                const float expected = ValueAt(u, timeIdx, 1 + ((cornerIdx >> 2) & 1), 2 + ((cornerIdx >> 1) & 1), 3 + (cornerIdx & 1));
+                REQUIRE(cube.values[timeIdx * 8 + cornerIdx] == expected);
+            }
+        }
+    }
+
+    SECTION("Range of time steps")
+    {
+        TimeRange timeRange;
+        timeRange.first = 6;
+        timeRange.count = 3;
+
+        std::vector<double> localIndices;
+        NetCdfTensor cube = cache.ReadNeighbourhood("u", { 0.0, 0.0, 0.0 }, timeRange, localIndices);
+
+        REQUIRE(cube.size == std::vector<size_t>{ 3, 2, 2, 2 });
+        for (size_t timeIdx = 0; timeIdx < 3; ++timeIdx)
+        {
+            REQUIRE(cube.values[timeIdx * 8] == ValueAt(u, 6 + timeIdx, 0, 0, 0));
+            REQUIRE(cube.values[timeIdx * 8 + 7] == ValueAt(u, 6 + timeIdx, 1, 1, 1));
+        }
+    }
+
+    SECTION("Neighbourhood between the last and the first longitude wraps around on a periodic grid")
+    {
+        std::vector<double> localIndices;
+        REQUIRE_THROWS_AS(cache.ReadNeighbourhood("u", { 0.5, 1.5, 4.5 }, localIndices), NetCdfException);
+
+        const NetCdfTensor cube = cache.ReadNeighbourhood("u", { 0.5, 1.5, 4.5 }, localIndices, true);
+
+        REQUIRE(localIndices[2] == Approx(0.5));
+        REQUIRE(cube.values[0] == ValueAt(u, 0, 0, 1, 4));
+        REQUIRE(cube.values[1] == ValueAt(u, 0, 0, 1, 0));
+        REQUIRE(cube.values[7] == ValueAt(u, 0, 1, 2, 0));
+    }
+
+    SECTION("Points outside of the variable throw")
+    {
+        std::vector<double> localIndices;
+        REQUIRE_THROWS_AS(cache.ReadNeighbourhood("u", { 0.0, 0.0, 5.0 }, localIndices, true), NetCdfException);
+        REQUIRE_THROWS_AS(cache.ReadNeighbourhood("v", { 0.0, 0.0, 0.0 }, localIndices), NetCdfException);
+    }
+
+    cache.Close();
+}
+
+TEST_CASE("PointMajorCache, missing values are flagged as invalid", "[PointMajorCache]")
+{
+    TemporaryFile file("PointMajorCacheMissingTest.pmc");
+    const std::vector<size_t> size = { 2, 2, 2, 2 };
+    NetCdfTensor u = CreateTimeMajorTensor(size);
+    u.values[3] = std::numeric_limits<float>::quiet_NaN();
+
+    {
+        PointMajorCacheWriter writer;
+        writer.Create(file.path, FileFingerprint(), { { "u", size } }, {});
+        writer.WriteCells("u", 0, u);
+        writer.Close();
+    }
+
+    PointMajorCacheFile cache;
+    cache.Open(file.path);
+
+    std::vector<double> localIndices;
+    NetCdfTensor cube = cache.ReadNeighbourhood("u", { 0.5, 0.5, 0.5 }, localIndices);
+    REQUIRE_FALSE(cube.IsValid(3));
+    REQUIRE(cube.IsValid(2));
+    REQUIRE(cube.IsValid(11));
+
+    cache.Close();
+}
+
+TEST_CASE("PointMajorCache, files which are not caches are rejected", "[PointMajorCache]")
+{
+    TemporaryFile file("PointMajorCacheInvalidTest.pmc");
+    {
+        std::ofstream stream(file.path, std::ios::binary);
+        stream << "CDF\x01 this is not a cache";
+    }
+
+    PointMajorCacheFile cache;
+    REQUIRE_THROWS_AS(cache.Open(file.path), NetCdfException);
+    REQUIRE_THROWS_AS(cache.Open("FileWhichDoesNotExist.pmc"), NetCdfException);
+}
+
+// Writes a net cdf file with the coordinates time, level, latitude and longitude
+//  and a packed variable 'u' of size [numberOfTimeSteps, 2, 3, 4], where every seventh value is missing.
+static void WriteSourceFile(const std::string& fileName, size_t numberOfTimeSteps)
+{
+    ClassicNetCdfFileBuilder builder;
+    const size_t time = builder.AddDimension("time", 0);
+    const size_t level = builder.AddDimension("level", 2);
+    const size_t latitude = builder.AddDimension("latitude", 3);
+    const size_t longitude = builder.AddDimension("longitude", 4);
+    builder.SetNumberOfRecords(numberOfTimeSteps);
+
+    std::vector<double> times;
+    std::vector<double> u;
+    for (size_t timeIdx = 0; timeIdx < numberOfTimeSteps; ++timeIdx)
+    {
+        times.push_back(6.0 * timeIdx);
+        for (size_t cellIdx = 0; cellIdx < 24; ++cellIdx)
+        {
+            const size_t ii = timeIdx * 24 + cellIdx;
+            u.push_back((ii % 7 == 0) ? -32767.0 : (double)ii);
+        }
+    }
+
+    builder.AddVariable("time", { time }, NC_DOUBLE, times);
+    builder.AddVariable("level", { level }, NC_FLOAT, { 1000.0, 500.0 });
+    builder.AddVariable("latitude", { latitude }, NC_FLOAT, { -40.0, -39.0, -38.0 });
+    builder.AddVariable("longitude", { longitude }, NC_FLOAT, { 10.0, 11.0, 12.0, 13.0 });
+
+    const size_t uIdx = builder.AddVariable("u", { time, level, latitude, longitude }, NC_SHORT, u);
+    builder.AddAttribute(uIdx, "scale_factor", NC_DOUBLE, { 0.25 });
+    builder.AddAttribute(uIdx, "_FillValue", NC_SHORT, { -32767.0 });
+
+    builder.Write(fileName);
+}
+
+TEST_CASE("ConvertToPointMajorCache, the cache holds the values, coordinates and fingerprint of the source", "[PointMajorCache]")
+{
+    TemporaryFile source("PointMajorCacheSource.nc");
+    TemporaryFile file("PointMajorCacheConverted.pmc");
+    WriteSourceFile(source.path, 6);
+
+    NetCdfFileReader reader;
+    reader.Open(source.path);
+    const NetCdfTensor u = reader.ReadVariable("u");
+    reader.Close();
+
+    // One time series of 'u' occupies 24 bytes, the tiles are levels, rows of latitude or single cells.
+    size_t maximumBytesPerTile = 0;
+    SECTION("One tile") { maximumBytesPerTile = 1 << 20; }
+    SECTION("Two rows of latitude per tile") { maximumBytesPerTile = 200; }
+    SECTION("One cell per tile") { maximumBytesPerTile = 10; }
+
+    ConvertToPointMajorCache(source.path, { "u" }, file.path, maximumBytesPerTile);
+
+    PointMajorCacheFile cache;
+    cache.Open(file.path);
+    REQUIRE(cache.GetSizeOfVariable("u") == std::vector<size_t>({ 6, 2, 3, 4 }));
+    REQUIRE(cache.GetCoordinate("time") == std::vector<double>({ 0.0, 6.0, 12.0, 18.0, 24.0, 30.0 }));
+    REQUIRE(cache.GetCoordinate("latitude") == std::vector<double>({ -40.0, -39.0, -38.0 }));
+    REQUIRE(cache.GetCoordinate("longitude").size() == 4);
+    REQUIRE(cache.IsUpToDate(source.path));
+
+    for (size_t latitudeIdx = 0; latitudeIdx < 2; ++latitudeIdx)
+    {
+        for (size_t longitudeIdx = 0; longitudeIdx < 3; ++longitudeIdx)
+        {
+            std::vector<double> localIndices;
+            const NetCdfTensor cube = cache.ReadNeighbourhood("u", { 0.0, (double)latitudeIdx, (double)longitudeIdx }, localIndices);
+            for (size_t timeIdx = 0; timeIdx < 6; ++timeIdx)
+            {
+                for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+                {
+                    const size_t index = ((timeIdx * 2 + ((cornerIdx >> 2) & 1)) * 3 + latitudeIdx + ((cornerIdx >> 1) & 1)) * 4 + longitudeIdx + (cornerIdx & 1);
+                    REQUIRE(cube.IsValid(timeIdx * 8 + cornerIdx) == u.IsValid(index));
+                    if (u.IsValid(index))
+                    {
+                        REQUIRE(cube.values[timeIdx * 8 + cornerIdx] == u.values[index]);
+                    }
+                }
+            }
+        }
+    }
+
+    // a source which has been changed since the cache was created is detected
+    WriteSourceFile(source.path, 7);
+    REQUIRE_FALSE(cache.IsUpToDate(source.path));
+}
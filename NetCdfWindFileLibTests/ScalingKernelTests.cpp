@@ -0,0 +1,131 @@
+#include "catch.hpp"
+#include <ScalingKernels.h>
+#include <cmath>
+
+TEST_CASE("DecodePackedValues, returns same values as scalar decoding", "[DecodePackedValues]")
+{
+    // an odd number of values, such that both the vectorized part and the remainder are used.
+    std::vector<short> packed(1027);
+    for (size_t ii = 0; ii < packed.size(); ++ii)
+    {
+        packed[ii] = (short)(ii * 97 - 32000);
+    }
+    LinearScaling scaling;
+    scaling.scaleFactor = 0.0012345678;
+    scaling.offset = 13.75;
+
+    std::vector<float> result(packed.size());
+    DecodePackedValues(packed.data(), packed.size(), scaling, result.data());
+
+    for (size_t ii = 0; ii < packed.size(); ++ii)
+    {
+        REQUIRE(result[ii] == (float)(packed[ii] * scaling.scaleFactor + scaling.offset));
+    }
+}
+
+TEST_CASE("DecodePackedValues, extreme values are decoded correctly", "[DecodePackedValues]")
+{
+    std::vector<short> packed = { -32768, -1, 0, 1, 32767, -32768, -1, 0, 1, 32767 };
+    LinearScaling scaling;
+
+    std::vector<float> result(packed.size());
+    DecodePackedValues(packed.data(), packed.size(), scaling, result.data());
+
+    REQUIRE(result[0] == -32768.0F);
+    REQUIRE(result[1] == -1.0F);
+    REQUIRE(result[2] == 0.0F);
+    REQUIRE(result[3] == 1.0F);
+    REQUIRE(result[4] == 32767.0F);
+    REQUIRE(result[9] == 32767.0F);
+}
+
+TEST_CASE("DecodePackedValues with missing values, masks out fill values and values outside of valid range", "[DecodePackedValues]")
+{
+    std::vector<short> packed(1027);
+    for (size_t ii = 0; ii < packed.size(); ++ii)
+    {
+        packed[ii] = (ii % 5 == 0) ? -32767 : (short)(ii * 61 - 30000);
+    }
+    LinearScaling scaling;
+    scaling.scaleFactor = 0.01;
+    scaling.offset = 2.5;
+    MissingValues missingValues;
+    missingValues.invalidValues = { -32767.0 };
+    missingValues.validMinimum = -25000.0;
+    missingValues.validMaximum = 25000.0;
+
+    // start in the middle of a byte of the bitmap, such that the unaligned start is also used.
+    const size_t firstBit = 3;
+    std::vector<float> result(packed.size());
+    std::vector<uint8_t> validity((firstBit + packed.size() + 7) / 8, 0);
+    DecodePackedValues(packed.data(), packed.size(), scaling, missingValues, result.data(), validity.data(), firstBit);
+
+    for (size_t ii = 0; ii < packed.size(); ++ii)
+    {
+        const bool expectedValid = missingValues.IsValid(packed[ii]);
+        const bool isValid = ((validity[(firstBit + ii) / 8] >> ((firstBit + ii) % 8)) & 1) != 0;
+        REQUIRE(isValid == expectedValid);
+        if (expectedValid)
+        {
+            REQUIRE(result[ii] == (float)(packed[ii] * scaling.scaleFactor + scaling.offset));
+        }
+        else
+        {
+            REQUIRE(std::isnan(result[ii]));
+        }
+    }
+}
+
+TEST_CASE("ApplyLinearScaling with missing values, masks out fill values", "[ApplyLinearScaling]")
+{
+    std::vector<float> values = { 1.0F, 9.96921e36F, 3.0F, -1.0F };
+    LinearScaling scaling;
+    scaling.scaleFactor = 2.0;
+    MissingValues missingValues;
+    missingValues.invalidValues = { 9.96921e36F };
+    missingValues.validMinimum = 0.0;
+    std::vector<uint8_t> validity(1, 0);
+
+    ApplyLinearScaling(values, scaling, missingValues, validity.data());
+
+    REQUIRE(values[0] == 2.0F);
+    REQUIRE(std::isnan(values[1]));
+    REQUIRE(values[2] == 6.0F);
+    REQUIRE(std::isnan(values[3]));
+    REQUIRE(validity[0] == 0x05);
+}
+
+TEST_CASE("ApplyLinearScaling of double values, masks out integer fill values which are not representable as float", "[ApplyLinearScaling]")
+{
+    // -2147483647 becomes -2147483648.0F when converted to float
+    std::vector<double> source = { -2147483647.0, -2147483648.0, 10.0, 2147483647.0 };
+    LinearScaling scaling;
+    scaling.scaleFactor = 0.5;
+    MissingValues missingValues;
+    missingValues.invalidValues = { -2147483647.0 };
+    std::vector<float> result(source.size());
+    std::vector<uint8_t> validity(1, 0);
+
+    ApplyLinearScaling(source.data(), source.size(), scaling, missingValues, result.data(), validity.data());
+
+    REQUIRE(std::isnan(result[0]));
+    REQUIRE(result[1] == (float)(-2147483648.0 * 0.5));
+    REQUIRE(result[2] == 5.0F);
+    REQUIRE(result[3] == (float)(2147483647.0 * 0.5));
+    REQUIRE(validity[0] == 0x0E);
+}
+
+TEST_CASE("CopyValidityBits, copies bits to unaligned position", "[CopyValidityBits]")
+{
+    std::vector<uint8_t> source = { 0xA5, 0x03 };
+    std::vector<uint8_t> destination = { 0xFF, 0xFF, 0xFF };
+
+    CopyValidityBits(source.data(), 10, destination.data(), 5);
+
+    for (size_t ii = 0; ii < 10; ++ii)
+    {
+        const bool expected = ((source[ii / 8] >> (ii % 8)) & 1) != 0;
+        REQUIRE((((destination[(ii + 5) / 8] >> ((ii + 5) % 8)) & 1) != 0) == expected);
+    }
+    REQUIRE((destination[0] & 0x1F) == 0x1F);
+}
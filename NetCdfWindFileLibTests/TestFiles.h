@@ -0,0 +1,401 @@
+#pragma once
+#include <netcdf.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+// Helpers for the tests which need files on disk.
+
+// @return the path of the provided file name in the temporary directory of the system.
+inline std::string TemporaryFilePath(const std::string& fileName)
+{
+#ifdef _WIN32
+    char directory[MAX_PATH + 1];
+    const DWORD length = GetTempPathA(MAX_PATH + 1, directory);
+    return std::string(directory, length) + fileName;
+#else
+    return "/tmp/" + fileName;
+#endif
+}
+
+// Removes the file when the test is done, also if it fails.
+class TemporaryFile
+{
+public:
+    explicit TemporaryFile(const std::string& fileName)
+        : path(TemporaryFilePath(fileName))
+    {
+        std::remove(path.c_str());
+    }
+
+    ~TemporaryFile()
+    {
+        std::remove(path.c_str());
+    }
+
+    TemporaryFile(const TemporaryFile&) = delete;
+    TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+    const std::string path;
+};
+
+// ClassicNetCdfFileBuilder creates small net cdf files in the classic (CDF-1) or 64-bit offset (CDF-2) format,
+//  byte by byte, such that the tests do not depend on any files or on the writing functions of the netcdf library.
+class ClassicNetCdfFileBuilder
+{
+public:
+    struct Attribute
+    {
+        std::string name;
+        nc_type type = NC_DOUBLE;
+        std::vector<double> values;
+        std::string text; // used if type == NC_CHAR
+    };
+
+    struct Variable
+    {
+        std::string name;
+        std::vector<size_t> dimensionIndices;
+        nc_type type = NC_FLOAT;
+        std::vector<double> values; // all values, for record variables all records after each other
+        std::vector<Attribute> attributes;
+    };
+
+    explicit ClassicNetCdfFileBuilder(int formatVersion = 1)
+        : m_formatVersion(formatVersion)
+    {
+    }
+
+    // Adds a dimension, the length zero makes this the unlimited (record) dimension.
+    //  @return the index of the dimension.
+    size_t AddDimension(const std::string& name, size_t length)
+    {
+        m_dimensions.push_back(std::make_pair(name, length));
+        return m_dimensions.size() - 1;
+    }
+
+    void SetNumberOfRecords(size_t numberOfRecords) { m_numberOfRecords = numberOfRecords; }
+
+    // @return the index of the variable.
+    size_t AddVariable(const std::string& name, const std::vector<size_t>& dimensionIndices, nc_type type, const std::vector<double>& values)
+    {
+        Variable variable;
+        variable.name = name;
+        variable.dimensionIndices = dimensionIndices;
+        variable.type = type;
+        variable.values = values;
+        m_variables.push_back(variable);
+        return m_variables.size() - 1;
+    }
+
+    void AddAttribute(size_t variableIdx, const std::string& name, nc_type type, const std::vector<double>& values)
+    {
+        Attribute attribute;
+        attribute.name = name;
+        attribute.type = type;
+        attribute.values = values;
+        m_variables[variableIdx].attributes.push_back(attribute);
+    }
+
+    void AddTextAttribute(size_t variableIdx, const std::string& name, const std::string& text)
+    {
+        Attribute attribute;
+        attribute.name = name;
+        attribute.type = NC_CHAR;
+        attribute.text = text;
+        m_variables[variableIdx].attributes.push_back(attribute);
+    }
+
+    // @return the contents of the file.
+    std::vector<char> Build() const
+    {
+        // The header does not depend on the values of the offsets, only on their size.
+        std::vector<uint64_t> begins(m_variables.size(), 0);
+        const size_t headerSize = BuildHeader(begins).size();
+
+        // The fixed size variables follow after the header and then the records.
+        uint64_t offset = headerSize;
+        for (size_t ii = 0; ii < m_variables.size(); ++ii)
+        {
+            if (!IsRecordVariable(m_variables[ii]))
+            {
+                begins[ii] = offset;
+                offset += VariableSize(m_variables[ii]);
+            }
+        }
+        for (size_t ii = 0; ii < m_variables.size(); ++ii)
+        {
+            if (IsRecordVariable(m_variables[ii]))
+            {
+                begins[ii] = offset;
+                offset += RecordSizeOfVariable(m_variables[ii]);
+            }
+        }
+
+        std::vector<unsigned char> file = BuildHeader(begins);
+        for (const Variable& variable : m_variables)
+        {
+            if (!IsRecordVariable(variable))
+            {
+                AppendValues(file, variable.type, variable.values, 0, variable.values.size());
+                Pad(file);
+            }
+        }
+        const size_t recordSize = RecordSize();
+        for (size_t recordIdx = 0; recordIdx < m_numberOfRecords; ++recordIdx)
+        {
+            const size_t startOfRecord = file.size();
+            for (const Variable& variable : m_variables)
+            {
+                if (IsRecordVariable(variable))
+                {
+                    const size_t startOfVariable = file.size();
+                    const size_t valuesPerRecord = ValuesPerRecord(variable);
+                    AppendValues(file, variable.type, variable.values, recordIdx * valuesPerRecord, valuesPerRecord);
+                    file.resize(startOfVariable + RecordSizeOfVariable(variable), 0);
+                }
+            }
+            file.resize(startOfRecord + recordSize, 0);
+        }
+
+        return std::vector<char>(file.begin(), file.end());
+    }
+
+    void Write(const std::string& fileName) const
+    {
+        const std::vector<char> contents = Build();
+        std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), contents.size());
+    }
+
+private:
+    int m_formatVersion;
+    size_t m_numberOfRecords = 0;
+    std::vector<std::pair<std::string, size_t>> m_dimensions;
+    std::vector<Variable> m_variables;
+
+    static size_t SizeOfType(nc_type type)
+    {
+        switch (type)
+        {
+        case NC_BYTE: return 1;
+        case NC_CHAR: return 1;
+        case NC_SHORT: return 2;
+        case NC_INT: return 4;
+        case NC_FLOAT: return 4;
+        case NC_DOUBLE: return 8;
+        default: return 0;
+        }
+    }
+
+    static size_t PaddedLength(size_t length) { return (length + 3) & ~(size_t)3; }
+
+    bool IsRecordVariable(const Variable& variable) const
+    {
+        return variable.dimensionIndices.size() > 0 && m_dimensions[variable.dimensionIndices[0]].second == 0;
+    }
+
+    size_t ValuesPerRecord(const Variable& variable) const
+    {
+        size_t numberOfValues = 1;
+        for (size_t ii = IsRecordVariable(variable) ? 1 : 0; ii < variable.dimensionIndices.size(); ++ii)
+        {
+            numberOfValues *= m_dimensions[variable.dimensionIndices[ii]].second;
+        }
+        return numberOfValues;
+    }
+
+    size_t VariableSize(const Variable& variable) const
+    {
+        return PaddedLength(ValuesPerRecord(variable) * SizeOfType(variable.type));
+    }
+
+    // The size of one record of the variable, without padding if this is the only record variable.
+    size_t RecordSizeOfVariable(const Variable& variable) const
+    {
+        return (NumberOfRecordVariables() == 1) ? ValuesPerRecord(variable) * SizeOfType(variable.type) : VariableSize(variable);
+    }
+
+    size_t NumberOfRecordVariables() const
+    {
+        size_t count = 0;
+        for (const Variable& variable : m_variables)
+        {
+            count += IsRecordVariable(variable) ? 1 : 0;
+        }
+        return count;
+    }
+
+    size_t RecordSize() const
+    {
+        size_t size = 0;
+        for (const Variable& variable : m_variables)
+        {
+            if (IsRecordVariable(variable))
+            {
+                size += RecordSizeOfVariable(variable);
+            }
+        }
+        return size;
+    }
+
+    static void Append32(std::vector<unsigned char>& data, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            data.push_back((unsigned char)(value >> shift));
+        }
+    }
+
+    static void Append64(std::vector<unsigned char>& data, uint64_t value)
+    {
+        Append32(data, (uint32_t)(value >> 32));
+        Append32(data, (uint32_t)value);
+    }
+
+    static void Pad(std::vector<unsigned char>& data)
+    {
+        data.resize(PaddedLength(data.size()), 0);
+    }
+
+    static void AppendName(std::vector<unsigned char>& data, const std::string& name)
+    {
+        Append32(data, (uint32_t)name.size());
+        data.insert(data.end(), name.begin(), name.end());
+        Pad(data);
+    }
+
+    static void AppendValues(std::vector<unsigned char>& data, nc_type type, const std::vector<double>& values, size_t first, size_t count)
+    {
+        for (size_t ii = first; ii < first + count; ++ii)
+        {
+            const double value = values[ii];
+            switch (type)
+            {
+            case NC_BYTE: data.push_back((unsigned char)(signed char)value); break;
+            case NC_SHORT:
+            {
+                const uint16_t bits = (uint16_t)(int16_t)value;
+                data.push_back((unsigned char)(bits >> 8));
+                data.push_back((unsigned char)bits);
+                break;
+            }
+            case NC_INT: Append32(data, (uint32_t)(int32_t)value); break;
+            case NC_FLOAT:
+            {
+                const float floatValue = (float)value;
+                uint32_t bits;
+                std::memcpy(&bits, &floatValue, sizeof(bits));
+                Append32(data, bits);
+                break;
+            }
+            case NC_DOUBLE:
+            {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                Append64(data, bits);
+                break;
+            }
+            default: break;
+            }
+        }
+    }
+
+    static void AppendAttributes(std::vector<unsigned char>& data, const std::vector<Attribute>& attributes)
+    {
+        if (attributes.empty())
+        {
+            Append32(data, 0);
+            Append32(data, 0);
+            return;
+        }
+
+        Append32(data, 0x0C);
+        Append32(data, (uint32_t)attributes.size());
+        for (const Attribute& attribute : attributes)
+        {
+            AppendName(data, attribute.name);
+            Append32(data, (uint32_t)attribute.type);
+            if (attribute.type == NC_CHAR)
+            {
+                Append32(data, (uint32_t)attribute.text.size());
+                data.insert(data.end(), attribute.text.begin(), attribute.text.end());
+            }
+            else
+            {
+                Append32(data, (uint32_t)attribute.values.size());
+                AppendValues(data, attribute.type, attribute.values, 0, attribute.values.size());
+            }
+            Pad(data);
+        }
+    }
+
+    std::vector<unsigned char> BuildHeader(const std::vector<uint64_t>& begins) const
+    {
+        std::vector<unsigned char> header = { 'C', 'D', 'F', (unsigned char)m_formatVersion };
+        Append32(header, (uint32_t)m_numberOfRecords);
+
+        if (m_dimensions.empty())
+        {
+            Append32(header, 0);
+            Append32(header, 0);
+        }
+        else
+        {
+            Append32(header, 0x0A);
+            Append32(header, (uint32_t)m_dimensions.size());
+            for (const auto& dimension : m_dimensions)
+            {
+                AppendName(header, dimension.first);
+                Append32(header, (uint32_t)dimension.second);
+            }
+        }
+
+        // no global attributes
+        AppendAttributes(header, std::vector<Attribute>());
+
+        if (m_variables.empty())
+        {
+            Append32(header, 0);
+            Append32(header, 0);
+        }
+        else
+        {
+            Append32(header, 0x0B);
+            Append32(header, (uint32_t)m_variables.size());
+            for (size_t ii = 0; ii < m_variables.size(); ++ii)
+            {
+                const Variable& variable = m_variables[ii];
+                AppendName(header, variable.name);
+                Append32(header, (uint32_t)variable.dimensionIndices.size());
+                for (size_t dimensionIdx : variable.dimensionIndices)
+                {
+                    Append32(header, (uint32_t)dimensionIdx);
+                }
+                AppendAttributes(header, variable.attributes);
+                Append32(header, (uint32_t)variable.type);
+                Append32(header, (uint32_t)VariableSize(variable));
+                if (m_formatVersion == 1)
+                {
+                    Append32(header, (uint32_t)begins[ii]);
+                }
+                else
+                {
+                    Append64(header, begins[ii]);
+                }
+            }
+        }
+
+        return header;
+    }
+};
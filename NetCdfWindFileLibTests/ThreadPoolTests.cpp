@@ -0,0 +1,44 @@
+#include "catch.hpp"
+#include <ThreadPool.h>
+#include <atomic>
+#include <stdexcept>
+
+TEST_CASE("ThreadPool, Submit returns result of each task", "[ThreadPool]")
+{
+    ThreadPool pool(3);
+    REQUIRE(pool.NumberOfThreads() == 3);
+
+    std::vector<std::future<int>> results;
+    for (int ii = 0; ii < 100; ++ii)
+    {
+        results.push_back(pool.Submit([ii]() { return ii * ii; }));
+    }
+
+    for (int ii = 0; ii < 100; ++ii)
+    {
+        REQUIRE(results[ii].get() == ii * ii);
+    }
+}
+
+TEST_CASE("ThreadPool, exception thrown by task is returned by future", "[ThreadPool]")
+{
+    ThreadPool pool(2);
+
+    std::future<int> result = pool.Submit([]() -> int { throw std::runtime_error("failed"); });
+
+    REQUIRE_THROWS_AS(result.get(), std::runtime_error);
+}
+
+TEST_CASE("ThreadPool, completes all queued tasks before it is destroyed", "[ThreadPool]")
+{
+    std::atomic<int> numberOfCompletedTasks(0);
+    {
+        ThreadPool pool(1);
+        for (int ii = 0; ii < 50; ++ii)
+        {
+            pool.Submit([&numberOfCompletedTasks]() { ++numberOfCompletedTasks; });
+        }
+    }
+
+    REQUIRE(numberOfCompletedTasks == 50);
+}
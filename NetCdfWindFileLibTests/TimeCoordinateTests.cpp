@@ -0,0 +1,95 @@
+#include "catch.hpp"
+#include <TimeCoordinate.h>
+#include <limits>
+
+TEST_CASE("ParseDateTime, dates are converted to seconds since 1970", "[ParseDateTime]")
+{
+    REQUIRE(ParseDateTime("1970-01-01") == 0.0);
+    REQUIRE(ParseDateTime("1970-01-02 00:00") == 86400.0);
+    REQUIRE(ParseDateTime("1900-01-01 00:00:00.0") == -2208988800.0);
+    REQUIRE(ParseDateTime("2000-03-01T12:30:15Z") == 951913815.0);
+    REQUIRE(ParseDateTime("2016-12-31 23:00 UTC") == 1483225200.0);
+}
+
+TEST_CASE("ParseDateTime, time zone offsets are subtracted", "[ParseDateTime]")
+{
+    REQUIRE(ParseDateTime("1970-01-01 01:00 +01:00") == 0.0);
+    REQUIRE(ParseDateTime("1970-01-01 00:00 -03") == 3 * 3600.0);
+}
+
+TEST_CASE("ParseDateTime, invalid dates throw", "[ParseDateTime]")
+{
+    REQUIRE_THROWS_AS(ParseDateTime(""), NetCdfException);
+    REQUIRE_THROWS_AS(ParseDateTime("2016/01/01"), NetCdfException);
+    REQUIRE_THROWS_AS(ParseDateTime("2016-13-01"), NetCdfException);
+    REQUIRE_THROWS_AS(ParseDateTime("2016-01-01 12"), NetCdfException);
+    REQUIRE_THROWS_AS(ParseDateTime("2016-01-01 12:00 tomorrow"), NetCdfException);
+}
+
+TEST_CASE("ParseTimeUnits, CF units are parsed", "[ParseTimeUnits]")
+{
+    TimeUnits hours = ParseTimeUnits("hours since 1900-01-01 00:00:00.0");
+    REQUIRE(hours.secondsPerUnit == 3600.0);
+    REQUIRE(hours.referenceTime == -2208988800.0);
+
+    TimeUnits days = ParseTimeUnits("Days since 1970-1-1");
+    REQUIRE(days.secondsPerUnit == 86400.0);
+    REQUIRE(days.referenceTime == 0.0);
+
+    REQUIRE(ParseTimeUnits("seconds since 1970-01-01T00:00:00Z").secondsPerUnit == 1.0);
+    REQUIRE(ParseTimeUnits("minutes since 1970-01-01").secondsPerUnit == 60.0);
+}
+
+TEST_CASE("ParseTimeUnits, invalid units throw", "[ParseTimeUnits]")
+{
+    REQUIRE_THROWS_AS(ParseTimeUnits("fortnights since 1970-01-01"), NetCdfException);
+    REQUIRE_THROWS_AS(ParseTimeUnits("hours after 1970-01-01"), NetCdfException);
+    REQUIRE_THROWS_AS(ParseTimeUnits("hours"), NetCdfException);
+}
+
+TEST_CASE("TimeCoordinate, FindRange returns the time steps inside of the window", "[TimeCoordinate]")
+{
+    // Six hourly values over three days
+    std::vector<double> values;
+    for (int ii = 0; ii < 12; ++ii)
+    {
+        values.push_back(6.0 * ii);
+    }
+    const TimeCoordinate time(values, ParseTimeUnits("hours since 2010-01-01"));
+
+    REQUIRE(time.size() == 12);
+    REQUIRE(time.SecondsSinceEpoch(4) == ParseDateTime("2010-01-02"));
+
+    SECTION("Window boundaries on time steps are inclusive")
+    {
+        TimeRange range = time.FindRange(ParseDateTime("2010-01-02"), ParseDateTime("2010-01-03"));
+        REQUIRE(range.first == 4);
+        REQUIRE(range.count == 5);
+    }
+
+    SECTION("Window boundaries between time steps")
+    {
+        TimeRange range = time.FindRange(ParseDateTime("2010-01-01 01:00"), ParseDateTime("2010-01-01 13:00"));
+        REQUIRE(range.first == 1);
+        REQUIRE(range.count == 2);
+    }
+
+    SECTION("Window covering all time steps")
+    {
+        TimeRange range = time.FindRange(-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+        REQUIRE(range.first == 0);
+        REQUIRE(range.count == 12);
+    }
+
+    SECTION("Window outside of the time steps is empty")
+    {
+        REQUIRE(time.FindRange(ParseDateTime("2011-01-01"), ParseDateTime("2011-02-01")).count == 0);
+        REQUIRE(time.FindRange(ParseDateTime("2009-01-01"), ParseDateTime("2009-02-01")).count == 0);
+        REQUIRE(time.FindRange(ParseDateTime("2010-01-01 01:00"), ParseDateTime("2010-01-01 02:00")).count == 0);
+    }
+}
+
+TEST_CASE("TimeCoordinate, unsorted time steps throw", "[TimeCoordinate]")
+{
+    REQUIRE_THROWS_AS(TimeCoordinate({ 0.0, 2.0, 1.0 }, TimeUnits()), NetCdfException);
+}
@@ -0,0 +1,77 @@
+#include "catch.hpp"
+#include <WindFieldValidation.h>
+
+// Creates the shapes of a consistent wind field, with the optional cloud coverage.
+static std::map<std::string, VariableShape> CreateConsistentWindField()
+{
+    std::map<std::string, VariableShape> variables;
+    variables["time"] = { { "time" }, { 100 } };
+    variables["level"] = { { "level" }, { 22 } };
+    variables["latitude"] = { { "latitude" }, { 30 } };
+    variables["longitude"] = { { "longitude" }, { 40 } };
+
+    const VariableShape field = { { "time", "level", "latitude", "longitude" }, { 100, 22, 30, 40 } };
+    variables["u"] = field;
+    variables["v"] = field;
+    variables["cc"] = field;
+    return variables;
+}
+
+TEST_CASE("FindWindFieldInconsistencies, consistent wind field has no problems", "[WindFieldValidation]")
+{
+    REQUIRE(FindWindFieldInconsistencies(CreateConsistentWindField()).empty());
+}
+
+TEST_CASE("FindWindFieldInconsistencies, missing variables are reported", "[WindFieldValidation]")
+{
+    std::map<std::string, VariableShape> variables = CreateConsistentWindField();
+    variables.erase("v");
+    variables.erase("latitude");
+
+    REQUIRE(FindWindFieldInconsistencies(variables).size() == 2);
+}
+
+TEST_CASE("FindWindFieldInconsistencies, dimensions in the wrong order are reported", "[WindFieldValidation]")
+{
+    std::map<std::string, VariableShape> variables = CreateConsistentWindField();
+    variables["cc"] = { { "time", "latitude", "longitude", "level" }, { 100, 30, 40, 22 } };
+
+    std::vector<std::string> problems = FindWindFieldInconsistencies(variables);
+    REQUIRE(problems.size() == 3);
+    REQUIRE(problems[0].find("'cc'") != std::string::npos);
+}
+
+TEST_CASE("FindWindFieldInconsistencies, wrong lengths and number of dimensions are reported", "[WindFieldValidation]")
+{
+    std::map<std::string, VariableShape> variables = CreateConsistentWindField();
+    variables["u"].size[0] = 99;
+    variables["v"] = { { "time", "latitude", "longitude" }, { 100, 30, 40 } };
+    variables["longitude"] = { { "longitude" }, { 1 } };
+
+    // the short longitude, the length of u along time, the number of dimensions of v and the longitude length of u and cc.
+    REQUIRE(FindWindFieldInconsistencies(variables).size() == 5);
+}
+
+TEST_CASE("FindWindFieldInconsistencies, variable names can be changed", "[WindFieldValidation]")
+{
+    std::map<std::string, VariableShape> variables = CreateConsistentWindField();
+    variables["lat"] = variables["latitude"];
+    variables.erase("latitude");
+
+    WindFieldVariableNames names;
+    REQUIRE(FindWindFieldInconsistencies(variables, names).size() == 1);
+
+    names.latitude = "lat";
+    REQUIRE(FindWindFieldInconsistencies(variables, names).empty());
+}
+
+TEST_CASE("ValidateSiteIsInsideOfGrid", "[WindFieldValidation]")
+{
+    const std::vector<float> latitude = { -30.0F, -35.0F, -40.0F, -45.0F };
+    const std::vector<float> longitude = { 280.0F, 285.0F, 290.0F, 295.0F };
+
+    REQUIRE_NOTHROW(ValidateSiteIsInsideOfGrid(latitude, longitude, -39.42, 288.07));
+    REQUIRE_NOTHROW(ValidateSiteIsInsideOfGrid(latitude, longitude, -39.42, -71.93));
+    REQUIRE_THROWS_AS(ValidateSiteIsInsideOfGrid(latitude, longitude, -21.244, -71.93), NetCdfException);
+    REQUIRE_THROWS_AS(ValidateSiteIsInsideOfGrid(latitude, longitude, -39.42, 55.708), NetCdfException);
+}
@@ -0,0 +1,191 @@
+#include "catch.hpp"
+#include "TestFiles.h"
+#include <WindSeriesCache.h>
+#include <fstream>
+
+// Creates a series with the provided number of time steps, where each value is unique.
+static InterpolatedWind CreateSeries(size_t firstTimeStep, size_t numberOfTimeSteps)
+{
+    InterpolatedWind series;
+    for (size_t ii = firstTimeStep; ii < firstTimeStep + numberOfTimeSteps; ++ii)
+    {
+        series.speed.push_back(1.0 * ii);
+        series.speedError.push_back(0.1 * ii);
+        series.direction.push_back(2.0 * ii);
+        series.directionError.push_back(0.2 * ii);
+        series.relativeHumidity.push_back(3.0 * ii);
+    }
+    return series;
+}
+
+static std::vector<double> CreateTimes(size_t numberOfTimeSteps)
+{
+    std::vector<double> times;
+    for (size_t ii = 0; ii < numberOfTimeSteps; ++ii)
+    {
+        times.push_back(1.0E9 + 3600.0 * ii);
+    }
+    return times;
+}
+
+// Removes the cache entry of one input file and site when the test is done, also if it fails.
+class TemporaryCacheEntry
+{
+public:
+    TemporaryCacheEntry(WindSeriesCache& cache, const std::string& inputFilename, const SiteLocation& site)
+        : m_cache(cache), m_inputFilename(inputFilename), m_site(site)
+    {
+        m_cache.Remove(m_inputFilename, m_site);
+    }
+
+    ~TemporaryCacheEntry()
+    {
+        m_cache.Remove(m_inputFilename, m_site);
+    }
+
+private:
+    WindSeriesCache& m_cache;
+    const std::string m_inputFilename;
+    const SiteLocation m_site;
+};
+
+TEST_CASE("WindSeriesCache, stored series is found again", "[WindSeriesCache]")
+{
+    TemporaryFile input("WindSeriesCacheTestInput.nc");
+    const std::string& inputFilename = input.path;
+    {
+        std::ofstream inputFile(inputFilename, std::ios::binary);
+        inputFile << "CDF\x01 pretend header";
+    }
+    const FileFingerprint fingerprint = GetFileFingerprint(inputFilename);
+    REQUIRE(fingerprint.fileSize == 19);
+
+    SiteLocation site;
+    site.latitude = -39.42;
+    site.longitude = -71.93;
+    site.altitude = 2847.0;
+
+    // The entries are stored in the temporary directory of the system.
+    WindSeriesCache cache(TemporaryFilePath(""));
+    TemporaryCacheEntry entry(cache, inputFilename, site);
+    cache.Store(inputFilename, fingerprint, site, CreateTimes(5), CreateSeries(0, 5));
+
+    SECTION("Same file and site is a full hit")
+    {
+        InterpolatedWind series;
+        REQUIRE(cache.Lookup(inputFilename, fingerprint, site, CreateTimes(5), series) == 5);
+        REQUIRE(series.speed == CreateSeries(0, 5).speed);
+        REQUIRE(series.directionError == CreateSeries(0, 5).directionError);
+        REQUIRE(series.relativeHumidity == CreateSeries(0, 5).relativeHumidity);
+        REQUIRE(series.cloudCoverage.empty());
+    }
+
+    SECTION("Another site is a miss")
+    {
+        SiteLocation otherSite = site;
+        otherSite.altitude = 2632.0;
+
+        InterpolatedWind series;
+        REQUIRE(cache.Lookup(inputFilename, fingerprint, otherSite, CreateTimes(5), series) == 0);
+        REQUIRE(series.speed.empty());
+    }
+
+    SECTION("A file which has grown along time is a partial hit")
+    {
+        FileFingerprint grownFingerprint = fingerprint;
+        grownFingerprint.fileSize += 1000;
+        grownFingerprint.modificationTime += 3600;
+
+        InterpolatedWind series;
+        REQUIRE(cache.Lookup(inputFilename, grownFingerprint, site, CreateTimes(8), series) == 5);
+
+        AppendTimeSteps(series, CreateSeries(5, 3));
+        REQUIRE(series.speed == CreateSeries(0, 8).speed);
+        REQUIRE(series.relativeHumidity == CreateSeries(0, 8).relativeHumidity);
+    }
+
+    SECTION("A file which has grown with other time steps is a miss")
+    {
+        FileFingerprint grownFingerprint = fingerprint;
+        grownFingerprint.fileSize += 1000;
+        grownFingerprint.headerHash += 1;
+
+        std::vector<double> times = CreateTimes(8);
+        times[2] += 1800.0;
+
+        InterpolatedWind series;
+        REQUIRE(cache.Lookup(inputFilename, grownFingerprint, site, times, series) == 0);
+    }
+
+    SECTION("A file which has been rewritten with the same size is a miss")
+    {
+        FileFingerprint rewrittenFingerprint = fingerprint;
+        rewrittenFingerprint.modificationTime += 3600;
+
+        InterpolatedWind series;
+        REQUIRE(cache.Lookup(inputFilename, rewrittenFingerprint, site, CreateTimes(5), series) == 0);
+
+        rewrittenFingerprint = fingerprint;
+        rewrittenFingerprint.headerHash += 1;
+        REQUIRE(cache.Lookup(inputFilename, rewrittenFingerprint, site, CreateTimes(5), series) == 0);
+    }
+
+    SECTION("A file with fewer time steps than the entry is a miss")
+    {
+        InterpolatedWind series;
+        REQUIRE(cache.Lookup(inputFilename, fingerprint, site, CreateTimes(4), series) == 0);
+    }
+
+    SECTION("A removed entry is a miss")
+    {
+        cache.Remove(inputFilename, site);
+
+        InterpolatedWind series;
+        REQUIRE(cache.Lookup(inputFilename, fingerprint, site, CreateTimes(5), series) == 0);
+    }
+
+    SECTION("A file which has shrunk is a miss")
+    {
+        FileFingerprint shrunkFingerprint = fingerprint;
+        shrunkFingerprint.fileSize -= 1;
+
+        InterpolatedWind series;
+        REQUIRE(cache.Lookup(inputFilename, shrunkFingerprint, site, CreateTimes(5), series) == 0);
+    }
+
+    SECTION("A series with the wrong length cannot be stored")
+    {
+        REQUIRE_THROWS_AS(cache.Store(inputFilename, fingerprint, site, CreateTimes(4), CreateSeries(0, 5)), NetCdfException);
+    }
+
+    SECTION("A series where any of the other values has the wrong length cannot be stored")
+    {
+        InterpolatedWind shortCloudCoverage = CreateSeries(0, 3);
+        shortCloudCoverage.cloudCoverage = { 0.5 };
+        REQUIRE_THROWS_AS(cache.Store(inputFilename, fingerprint, site, CreateTimes(3), shortCloudCoverage), NetCdfException);
+
+        InterpolatedWind longRelativeHumidity = CreateSeries(0, 3);
+        longRelativeHumidity.relativeHumidity.push_back(1.0);
+        REQUIRE_THROWS_AS(cache.Store(inputFilename, fingerprint, site, CreateTimes(3), longRelativeHumidity), NetCdfException);
+
+        InterpolatedWind shortSpeedError = CreateSeries(0, 3);
+        shortSpeedError.speedError.pop_back();
+        REQUIRE_THROWS_AS(cache.Store(inputFilename, fingerprint, site, CreateTimes(3), shortSpeedError), NetCdfException);
+
+        // the optional values may be missing, and the previously stored entry is kept until then
+        InterpolatedWind series;
+        REQUIRE(cache.Lookup(inputFilename, fingerprint, site, CreateTimes(5), series) == 5);
+
+        InterpolatedWind withoutRelativeHumidity = CreateSeries(0, 3);
+        withoutRelativeHumidity.relativeHumidity.clear();
+        cache.Store(inputFilename, fingerprint, site, CreateTimes(3), withoutRelativeHumidity);
+        REQUIRE(cache.Lookup(inputFilename, fingerprint, site, CreateTimes(5), series) == 3);
+        REQUIRE(series.relativeHumidity.empty());
+        REQUIRE(series.cloudCoverage.empty());
+    }
+}
+
+TEST_CASE("GetFileFingerprint, missing file throws", "[WindSeriesCache]")
+{
+    REQUIRE_THROWS_AS(GetFileFingerprint("FileWhichDoesNotExist.nc"), NetCdfException);
+}
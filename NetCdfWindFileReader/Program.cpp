@@ -2,13 +2,20 @@
 #include <iomanip>
 #include <stdio.h>
 #include "NetCdfFileReader.h"
+#include "NetCdfReaderPool.h"
+#include "TimeCoordinate.h"
+#include "WindSeriesCache.h"
+#include "WindFieldValidation.h"
 #include <sstream>
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <limits>
 #include <time.h>
 #include <WindFieldInterpolation.h>
 #include "MathUtils.h"
+#include "CoordinateAxis.h"
+#include "ThreadPool.h"
 
 int main(void)
 {
@@ -23,47 +30,110 @@ int main(void)
     // const double volcano_longitude = 55.708;
     // const double volcano_altitude = 2632.0;
 
+    // The window in time to extract, as "yyyy-mm-dd hh:mm" (UTC).
+    //  Leave these empty to extract all the time steps in the file.
+    const std::string firstTime = "";
+    const std::string lastTime = "";
+
+    // The interpolated series are cached in this directory, such that repeated extractions are fast.
+    //  Leave this empty to use the directory 'cache' next to the input file.
+    //  Nothing is cached if the directory does not exist.
+    std::string cacheDirectory = "";
+    if (cacheDirectory.size() == 0)
+    {
+        const size_t endOfDirectory = inputFilePath.find_last_of("/\\");
+        cacheDirectory = ((endOfDirectory == std::string::npos) ? std::string() : inputFilePath.substr(0, endOfDirectory + 1)) + "cache";
+    }
+
 
     try
     {
-        NetCdfFileReader fileReader;
-        fileReader.Open(inputFilePath);
+        // One reader per variable of the wind field, such that these can be read in parallel.
+        //  Small files are read into memory at once and large classic files are memory mapped.
+        NetCdfReaderPool readerPool;
+        readerPool.Open(inputFilePath, 4, NetCdfOpenMode::Automatic, NetCdfAccessPattern::TimeSeriesAtPoint);
+        NetCdfReaderPool::Lease fileReader = readerPool.Acquire();
 
-        // fileReader.PrintFileInformation();
+        // fileReader->PrintFileInformation();
         // return 1;
 
+        // Verify that the variables fit together before reading any values,
+        //  such that a broken file is reported immediately.
+        ValidateWindField(*fileReader);
+
         // get the different variables which we need
 
-        // First the mandatory variables
-        NetCdfTensor longitude = fileReader.ReadVariable("longitude");
+        // First the mandatory coordinate variables, these are small and are read in full.
+        NetCdfTensor longitude = fileReader->ReadVariable("longitude");
 
-        NetCdfTensor latitude = fileReader.ReadVariable("latitude");
+        NetCdfTensor latitude = fileReader->ReadVariable("latitude");
 
-        NetCdfTensor level = fileReader.ReadVariable("level");
+        NetCdfTensor level = fileReader->ReadVariable("level");
 
-        NetCdfTensor time = fileReader.ReadVariable("time");
+        // The time is decoded using its units, the time steps inside of the window are found by a binary search
+        //  such that only these are read from the file.
+        TimeCoordinate time = fileReader->ReadTimeCoordinate("time");
 
-        NetCdfTensor u = fileReader.ReadVariable("u");
+        TimeRange timeRange;
+        timeRange.count = time.size();
+        if (firstTime.size() > 0 || lastTime.size() > 0)
+        {
+            const double windowStart = (firstTime.size() > 0) ? ParseDateTime(firstTime) : -std::numeric_limits<double>::infinity();
+            const double windowEnd = (lastTime.size() > 0) ? ParseDateTime(lastTime) : std::numeric_limits<double>::infinity();
+            timeRange = time.FindRange(windowStart, windowEnd);
 
-        NetCdfTensor v = fileReader.ReadVariable("v");
+            if (timeRange.count == 0)
+            {
+                std::cout << "The file contains no time steps between '" << firstTime << "' and '" << lastTime << "'." << std::endl;
+                return 1;
+            }
+        }
 
-        // TODO: Check that the sizes of these variables agree...
+        // The series are cached per input file and site. If the file has grown since the series was cached
+        //  then only the new time steps are interpolated.
+        SiteLocation site;
+        site.latitude = volcano_latitude;
+        site.longitude = volcano_longitude;
+        site.altitude = volcano_altitude;
 
-        // Then the optional variables (which are not always defined in the file)
-        NetCdfTensor relativeHumidity;
-        if (fileReader.ContainsVariable("r"))
+        std::vector<double> timesSinceEpoch(time.size());
+        for (size_t ii = 0; ii < time.size(); ++ii)
         {
-            relativeHumidity = fileReader.ReadVariable("r");
+            timesSinceEpoch[ii] = time.SecondsSinceEpoch(ii);
         }
-        else if (fileReader.ContainsVariable("rh"))
+
+        const FileFingerprint fingerprint = GetFileFingerprint(inputFilePath);
+        WindSeriesCache seriesCache(cacheDirectory);
+
+        // 'result' holds the time steps starting at resultFirstTimeIndex in the file.
+        InterpolatedWind result;
+        size_t resultFirstTimeIndex = 0;
+        size_t cachedTimeSteps = seriesCache.Lookup(inputFilePath, fingerprint, site, timesSinceEpoch, result);
+
+        // The cached series can only be extended if it has the same optional series as those interpolated below,
+        //  otherwise these would not have one value for each time step.
+        const bool hasRelativeHumidity = fileReader->ContainsVariable("r") || fileReader->ContainsVariable("rh");
+        const bool hasCloudCoverage = fileReader->ContainsVariable("cc");
+        if ((result.relativeHumidity.size() > 0) != hasRelativeHumidity || (result.cloudCoverage.size() > 0) != hasCloudCoverage)
         {
-            relativeHumidity = fileReader.ReadVariable("rh");
+            result = InterpolatedWind();
+            cachedTimeSteps = 0;
         }
 
-        NetCdfTensor cloudCoverage;
-        if (fileReader.ContainsVariable("cc"))
+        const size_t endOfTimeRange = timeRange.first + timeRange.count;
+
+        // The time steps which are not cached. If the requested time steps continue directly after the cached
+        //  ones then the cached series is extended, otherwise only the requested time steps are interpolated.
+        TimeRange rangeToInterpolate = timeRange;
+        if (cachedTimeSteps >= timeRange.first)
+        {
+            rangeToInterpolate.first = std::min(cachedTimeSteps, endOfTimeRange);
+            rangeToInterpolate.count = endOfTimeRange - rangeToInterpolate.first;
+        }
+        else
         {
-            cloudCoverage = fileReader.ReadVariable("cc");
+            result = InterpolatedWind();
+            resultFirstTimeIndex = timeRange.first;
         }
 
         // These are fixed and can be written into the program...
@@ -82,36 +152,97 @@ int main(void)
             0.60F, 0.46F, 0.24F, 0.10F
         };
 
+        // The axes are examined once, this also decides if the longitude wraps around from the last to the first value.
+        const CoordinateAxis latitudeAxis(latitude.values);
+        const CoordinateAxis longitudeAxis(longitude.values, 360.0);
+        const CoordinateAxis altitudeAxis(altitudes_km);
+
+        ValidateSiteIsInsideOfGrid(latitudeAxis, longitudeAxis, volcano_latitude, volcano_longitude);
+
         double latitudeIdx = 0.0;
         double longitudeIdx = 0.0;
 
-        latitudeIdx = GetFractionalIndex(latitude.values, volcano_latitude);
-        try
-        {
-            longitudeIdx = GetFractionalIndex(longitude.values, volcano_longitude);
-        }
-        catch (std::exception&)
-        {
-            longitudeIdx = GetFractionalIndex(longitude.values, 360.0 + volcano_longitude);
-        }
-        const double levelIdx = GetFractionalIndex(altitudes_km, volcano_altitude * 0.001);
+        latitudeIdx = latitudeAxis.GetFractionalIndex(volcano_latitude);
+        longitudeIdx = longitudeAxis.GetFractionalIndex(volcano_longitude);
+        const double levelIdx = altitudeAxis.GetFractionalIndex(volcano_altitude * 0.001);
 
-        InterpolatedWind result;
-        InterpolateWind(
-            u.values,
-            v.values,
-            u.size,
-            { levelIdx, latitudeIdx, longitudeIdx },
-            result);
-
-        if (relativeHumidity.values.size() > 0)
+        const std::vector<double> spatialIndices = { levelIdx, latitudeIdx, longitudeIdx };
+
+        // Then the wind field. Only the small cube surrounding the volcano is read from the file.
+        //  The variables are read in the background, while the previous ones are being interpolated.
+        //  For compressed NetCdf-4 files the chunk cache must hold the full time series of the cube,
+        //  otherwise the chunks are decompressed many times over.
+        for (const char* variableName : { "u", "v", "r", "rh", "cc" })
         {
-            InterpolateValue(relativeHumidity.values, relativeHumidity.size, { levelIdx, latitudeIdx, longitudeIdx }, result.relativeHumidity);
+            if (fileReader->ContainsVariable(variableName))
+            {
+                readerPool.TuneChunkCache(variableName, NetCdfAccessPattern::TimeSeriesAtPoint);
+            }
         }
 
-        if (cloudCoverage.values.size() > 0)
+        if (rangeToInterpolate.count > 0)
         {
-            InterpolateValue(cloudCoverage.values, cloudCoverage.size, { levelIdx, latitudeIdx, longitudeIdx }, result.cloudCoverage);
+            std::vector<double> localIndices;
+            std::future<NetCdfTensor> pendingU = readerPool.ReadNeighbourhoodAsync("u", spatialIndices, rangeToInterpolate, localIndices, longitudeAxis.WrapsAround());
+
+            std::future<NetCdfTensor> pendingV = readerPool.ReadNeighbourhoodAsync("v", spatialIndices, rangeToInterpolate, localIndices, longitudeAxis.WrapsAround());
+
+            // Then the optional variables (which are not always defined in the file)
+            std::future<NetCdfTensor> pendingRelativeHumidity;
+            if (fileReader->ContainsVariable("r"))
+            {
+                pendingRelativeHumidity = readerPool.ReadNeighbourhoodAsync("r", spatialIndices, rangeToInterpolate, localIndices, longitudeAxis.WrapsAround());
+            }
+            else if (fileReader->ContainsVariable("rh"))
+            {
+                pendingRelativeHumidity = readerPool.ReadNeighbourhoodAsync("rh", spatialIndices, rangeToInterpolate, localIndices, longitudeAxis.WrapsAround());
+            }
+
+            std::future<NetCdfTensor> pendingCloudCoverage;
+            if (fileReader->ContainsVariable("cc"))
+            {
+                pendingCloudCoverage = readerPool.ReadNeighbourhoodAsync("cc", spatialIndices, rangeToInterpolate, localIndices, longitudeAxis.WrapsAround());
+            }
+
+            NetCdfTensor u = pendingU.get();
+            NetCdfTensor v = pendingV.get();
+
+            // The time steps are interpolated in parallel, one range of time steps per hardware thread.
+            ThreadPool interpolationThreads;
+
+            InterpolatedWind interpolated;
+            InterpolateWind(u, v, localIndices, interpolationThreads, interpolated);
+
+            if (pendingRelativeHumidity.valid())
+            {
+                NetCdfTensor relativeHumidity = pendingRelativeHumidity.get();
+                InterpolateValue(relativeHumidity, localIndices, interpolationThreads, interpolated.relativeHumidity);
+            }
+
+            if (pendingCloudCoverage.valid())
+            {
+                NetCdfTensor cloudCoverage = pendingCloudCoverage.get();
+                InterpolateValue(cloudCoverage, localIndices, interpolationThreads, interpolated.cloudCoverage);
+            }
+
+            AppendTimeSteps(result, interpolated);
+            if (resultFirstTimeIndex == 0)
+            {
+                try
+                {
+                    seriesCache.Store(
+                        inputFilePath,
+                        fingerprint,
+                        site,
+                        std::vector<double>(timesSinceEpoch.begin(), timesSinceEpoch.begin() + result.speed.size()),
+                        result);
+                }
+                catch (std::exception& e)
+                {
+                    // The result is still written, the series is only interpolated again the next time.
+                    std::cout << "Warning: the wind series could not be cached. " << e.what() << std::endl;
+                }
+            }
         }
 
         // Save all the values for the NovacProgram to read
@@ -128,10 +259,12 @@ int main(void)
         windFieldFile << "ws wse wd wde" << std::endl;
         windFieldFile.precision(1);
         windFieldFile << std::fixed << std::setw(4) << std::setfill(' ');
-        for (size_t ii = 0; ii < time.values.size(); ++ii)
+        for (size_t ii = 0; ii < timeRange.count; ++ii)
         {
-            // time is hours since 1900-01-01 00:00:0.0
-            time_t rawtimeSinceEpoch = (time_t)(time.values[ii] * 3600.0) - 2208988800L;
+            const size_t timeIdx = timeRange.first + ii;
+            const size_t resultIdx = timeIdx - resultFirstTimeIndex;
+
+            time_t rawtimeSinceEpoch = (time_t)time.SecondsSinceEpoch(timeIdx);
 
             // Format time, "ddd yyyy-mm-dd hh:mm:ss zzz"
             char buf[80];
@@ -142,16 +275,16 @@ int main(void)
             windFieldFile << buf << " ";
             if (result.cloudCoverage.size() > 0)
             {
-                windFieldFile << result.cloudCoverage[ii] << " ";
+                windFieldFile << result.cloudCoverage[resultIdx] << " ";
             }
             if (result.relativeHumidity.size() > 0)
             {
-                windFieldFile << result.relativeHumidity[ii] << " ";
+                windFieldFile << result.relativeHumidity[resultIdx] << " ";
             }
-            windFieldFile << result.speed[ii] << " ";
-            windFieldFile << result.speedError[ii] << " ";
-            windFieldFile << result.direction[ii] << " ";
-            windFieldFile << result.directionError[ii] << std::endl;
+            windFieldFile << result.speed[resultIdx] << " ";
+            windFieldFile << result.speedError[resultIdx] << " ";
+            windFieldFile << result.direction[resultIdx] << " ";
+            windFieldFile << result.directionError[resultIdx] << std::endl;
         }
     }
     catch (std::exception e)